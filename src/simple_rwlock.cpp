@@ -1,238 +1,98 @@
-#include <mutex>
-
 #include <simple_rwlock_debug_helpers.h>
+#include <simple_rwlock_basic_impl.h>
 #include <simple_rwlock.h>
+#include <simple_rwlock_profile.h>
+#include <simple_rwlock_trace.h>
 
 namespace simple_rwlock {
+    // The only instantiation of basic_rwlock built into the library. See
+    // simple_rwlock_basic_impl.h for the requirements each function meets.
+    template class basic_rwlock<
+        writer_bias_policy,
+        park_wait_policy,
+        wait_hook_stats_policy<rwlock_profile_record_wait>,
+        pointer_layout_policy>;
+
     void rwlock_init(rwlock_t *rwlock) {
         PRINT_CALLED("rwlock_init");
-        rwlock->num_active_readers = 0;
-        rwlock->num_active_writers = 0;
-        rwlock->write_or_any_read_mutex = new std::mutex;
-        rwlock->num_active_writers_mutex = new std::mutex;
-        rwlock->any_active_writers_mutex = new std::mutex;
-        rwlock->num_active_readers_mutex = new std::mutex;
+        rwlock->init();
     }
 
     void rwlock_uninit(rwlock_t *rwlock) {
         PRINT_CALLED("rwlock_uninit");
-        delete rwlock->write_or_any_read_mutex;
-        delete rwlock->num_active_writers_mutex;
-        delete rwlock->any_active_writers_mutex;
-        delete rwlock->num_active_readers_mutex;
+        rwlock->uninit();
     }
 
     //--------------------------------------------------------------------------
-    // Requirement: The rwlock object is writer-biased, so any active writers
-    //              (either writing or waiting to write) must become inactive
-    //              before the reader can establish read access.
-    // Enforcement: The any_active_writers mutex must become locked.
-    //--------------------------------------------------------------------------
-    // Requirement: No writers have write access between the time any reader
-    //              has established read access and the time all readers are
-    //              no longer reading.
-    // Enforcement: The write_or_any_read mutex must be locked. Either this
-    //              reader will lock the write_or_any_read mutex or some other
-    //              reader has already locked the write_or_any_read mutex when
-    //              it became active.
-    //--------------------------------------------------------------------------
-    // Requirement: This function call must accurately determine whether or not
-    //              to lock the write_or_any_read mutex.
-    // Enforcement: The number of active readers is checked for zero while the
-    //              mutex protecting the number of active readers counter is
-    //              locked. If it is zero then lock the write_or_any_read
-    //              mutex.
-    //--------------------------------------------------------------------------
-    // Requirement: Future calls to the rwlock_lock_rd function must have the
-    //              information needed to accurately determine whether to lock
-    //              the write_or_any_read mutex.
-    // Requirement: Future calls to the rwlock_unlock_rd function must have the
-    //              information needed to accurately determine whether to
-    //              unlock the write_or_any_read mutex.
-    // Enforcement: The number of readers counter is incremented while the
-    //              mutex protecting the number of readers counter is locked.
-    //--------------------------------------------------------------------------
-    // Requirement: Other readers may start reading between the time this
-    //              reader has established its read access and the time this
-    //              reader has released its read access.
-    // Enforcement: Release the mutex protecting the number of readers counter
-    //              by the time this function completes execution.
-    //--------------------------------------------------------------------------
-    // Requirement: Writers are able to start waiting to write between the
-    //              time a reader has established read access and the time
-    //              reading completes.
-    // Enforcement: Release the any_active_writers mutex after the
-    //              write_or_any_read_mutex is locked and before this
-    //              function completes execution.
+    // Tracing and profiling share one flag, so that a lock call that is not
+    // instrumented only loads it once. rwlock_profile_lock_acquired must
+    // not be called as a tail call, or the sampled stack would be missing
+    // the rwlock_t function and start one frame too high; an empty asm
+    // statement after the call keeps the compiler from turning it into one.
     //--------------------------------------------------------------------------
     void rwlock_lock_rd(rwlock_t *rwlock) {
         PRINT_CALLED("rwlock_lock_rd");
-        PRINT_AAWLOCK("rwlock_lock_rd", "acquiring");
-        rwlock->any_active_writers_mutex->lock();
-        PRINT_AAWLOCK("rwlock_lock_rd", "locked");
-        rwlock->num_active_readers_mutex->lock();
-        if (rwlock->num_active_readers == 0) {
-            PRINT_WOARLOCK("rwlock_lock_rd", "acquiring");
-            rwlock->write_or_any_read_mutex->lock();
-            PRINT_WOARLOCK("rwlock_lock_rd", "locked");
+        unsigned int instrumentation =
+            rwlock_instrumentation.load(std::memory_order_relaxed);
+        if (instrumentation == 0) {
+            rwlock->lock_rd();
+            return;
+        }
+        uint64_t call_ns = rwlock_trace_lock_call(instrumentation);
+        bool profile = (instrumentation & rwlock_instrument_profile) != 0;
+        if (profile) {
+            rwlock_profile_lock_call();
+        }
+        rwlock->lock_rd();
+        if (profile) {
+            rwlock_profile_lock_acquired(rwlock_trace_kind_read);
+            // Keep this frame on the stack during the call above.
+            asm volatile("" ::: "memory");
         }
-        ASSERT_LOCKED(rwlock->write_or_any_read_mutex);
-        rwlock->num_active_readers++;
-        PRINT_ARNUM("rwlock_lock_rd", rwlock, "incremented");
-        rwlock->num_active_readers_mutex->unlock();
-        ASSERT_LOCKED(rwlock->any_active_writers_mutex);
-        PRINT_AAWLOCK("rwlock_lock_rd", "releasing");
-        rwlock->any_active_writers_mutex->unlock();
-        PRINT_AAWLOCK("rwlock_lock_rd", "released");
+        rwlock_trace_lock_acquired(rwlock, rwlock_trace_kind_read, call_ns);
     }
 
-    //--------------------------------------------------------------------------
-    // Requirement: Waiting writers must be able to establish write access
-    //              after the last active reader has released its read access.
-    // Requirement: Readers must be able to establish read access after the
-    //              last active reader has released read access.
-    // Enforcement: The write_or_any_read mutex is unlocked if no more
-    //              readers are active.
-    //--------------------------------------------------------------------------
-    // Requirement: Future calls to the rwlock_lock_rd function must have the
-    //              information needed to accurately determine whether to
-    //              lock the write_or_any_read mutex.
-    // Requirement: Future calls to the rwlock_unlock_rd function must have
-    //              the information needed to accurately determine whether to
-    //              unlock the write_or_any_read mutex.
-    // Enforcement: The number of readers is decremented while the mutex
-    //              protecting the number of readers counter is locked.
-    //--------------------------------------------------------------------------
-    // Requirement: This function call must accurately determine whether or
-    //              not to release the write_or_any_read mutex.
-    // Enforcement: The number of readers is checked for zero while the mutex
-    //              protecting the number of readers counter is locked. If it
-    //              is zero then unlock the write_or_any_read mutex.
-    //--------------------------------------------------------------------------
-    // Requirement: Readers must be able to establish read access after any
-    //              active reader has released its read access.
-    // Enforcement: Release the mutex protecting the number of active readers
-    //              counter by the time this function completes execution.
-    //--------------------------------------------------------------------------
     void rwlock_unlock_rd(rwlock_t *rwlock) {
         PRINT_CALLED("rwlock_unlock_rd");
-        rwlock->num_active_readers_mutex->lock();
-        ASSERT_POSITIVE(rwlock->num_active_readers);
-        rwlock->num_active_readers--;
-        PRINT_ARNUM("rwlock_unlock_rd", rwlock, "decremented");
-        if (rwlock->num_active_readers == 0) {
-            PRINT_WOARLOCK("rwlock_unlock_rd", "releasing");
-            rwlock->write_or_any_read_mutex->unlock();
-        }
-        rwlock->num_active_readers_mutex->unlock();
+        rwlock_trace_unlock_call(rwlock);
+        rwlock->unlock_rd();
     }
 
-    //--------------------------------------------------------------------------
-    // Requirement: The rwlock object is writer-biased, so readers must not be
-    //              able to become active between the time this writer has
-    //              started waiting and the time it has released write access.
-    // Enforcement: The any_active_writers mutex must be locked. Either this
-    //              writer will lock the any_active_writers mutex or some other
-    //              writer has already any_active_writers mutex when it became
-    //              active.
-    //--------------------------------------------------------------------------
-    // Requirement: This function call must accurately determine whether or not
-    //              to lock the any_active_writers mutex.
-    // Enforcement: The number of active writers is checked for zero after
-    //              locking the mutex protecting the number of active writers
-    //              counter. If it is zero then lock the any_active_writers
-    //              mutex.
-    //--------------------------------------------------------------------------
-    // Requirement: Future calls to the rwlock_lock_wr function must have the
-    //              information needed to accurately determine whether to lock
-    //              the any_active_writers mutex.
-    // Requirement: Future calls to the rwlock_unlock_wr function must have the
-    //              information needed to accurately determine whether to
-    //              unlock the any_active_writers mutex.
-    // Enforcement: The number of active writers counter is incremented while
-    //              the mutex protecting the number of active writers counter
-    //              is locked.
-    //--------------------------------------------------------------------------
-    // Requirement: The writer may not have write access while any other
-    //              writers have write access.
-    // Requirement: The write may not have write access while any readers
-    //              are active.
-    // Requirement: The writer must establish write access by the time this
-    //              function completes execution.
-    // Enforcement: Always lock the write_or_any_read mutex in this funciton.
-    //--------------------------------------------------------------------------
-    // Requirement: Other writers may start waiting to write between the time
-    //              this writer starts waiting and the time this writer
-    //              establishes write access.
-    // Enforcement: Release the mutex protecting the number of writers counter
-    //              before locking the write access mutex.
-    //--------------------------------------------------------------------------
     void rwlock_lock_wr(rwlock_t *rwlock) {
         PRINT_CALLED("rwlock_lock_wr");
-        rwlock->num_active_writers_mutex->lock();
-        if (rwlock->num_active_writers == 0) {
-            PRINT_AAWLOCK("rwlock_lock_wr", "acquiring");
-            rwlock->any_active_writers_mutex->lock();
-            PRINT_AAWLOCK("rwlock_lock_wr", "locked");
+        unsigned int instrumentation =
+            rwlock_instrumentation.load(std::memory_order_relaxed);
+        if (instrumentation == 0) {
+            rwlock->lock_wr();
+            return;
+        }
+        uint64_t call_ns = rwlock_trace_lock_call(instrumentation);
+        bool profile = (instrumentation & rwlock_instrument_profile) != 0;
+        if (profile) {
+            rwlock_profile_lock_call();
         }
-        ASSERT_LOCKED(rwlock->any_active_writers_mutex);
-        rwlock->num_active_writers++;
-        PRINT_AWNUM("rwlock_lock_wr", rwlock, "incremented");
-        rwlock->num_active_writers_mutex->unlock();
-        PRINT_WOARLOCK("rwlock_lock_wr", "acquiring");
-        rwlock->write_or_any_read_mutex->lock();
-        PRINT_WOARLOCK("rwlock_lock_wr", "locked");
-        ASSERT_ZERO(rwlock->num_active_readers);
+        rwlock->lock_wr();
+        if (profile) {
+            rwlock_profile_lock_acquired(rwlock_trace_kind_write);
+            // Keep this frame on the stack during the call above.
+            asm volatile("" ::: "memory");
+        }
+        rwlock_trace_lock_acquired(rwlock, rwlock_trace_kind_write, call_ns);
     }
 
-    //--------------------------------------------------------------------------
-    // Requirement: Waiting writers must be able to establish write access
-    //              after a writer has released write access.
-    // Requirement: Readers must potentially be able to establish read
-    //              access after a writer has released write access.
-    // Enforcement: Always unlock the write_or_any_read mutex.
-    //--------------------------------------------------------------------------
-    // Requirement: Readers must be able to establish read access after the
-    //              last active writer has released write access.
-    // Enforcement: The any_active_writers mutex is unlocked if no more
-    //              writers are active.
-    //--------------------------------------------------------------------------
-    // Requirement: Future calls to the rwlock_lock_wr function must have the
-    //              information needed to accurately determine whether to lock
-    //              the any_active_writers mutex.
-    // Requirement: Future calls to the rwlock_unlock_wr function must have the
-    //              information needed to accurately determine whether to
-    //              unlock the any_active_writers mutex.
-    // Enforcement: The number of active writers counter is decremented while
-    //              the mutex protecting the number of active writers counter
-    //              is locked.
-    //--------------------------------------------------------------------------
-    // Requirement: This function call must accurately determine whether or not
-    //              to unlock the any_active_writers mutex.
-    // Enforcement: Check the number of active writers while the mutex
-    //              protecting the number of active writers counter is locked.
-    //              If it is zero then unlock the any_active_writers mutex.
-    //--------------------------------------------------------------------------
-    // Requirement: Writers must be able to start waiting to write after any
-    //              writer with write access has released its write access.
-    // Enforcement: Release the mutex protecting the number of active writers
-    //              counter by the time this function completes execution.
-    //--------------------------------------------------------------------------
     void rwlock_unlock_wr(rwlock_t *rwlock) {
         PRINT_CALLED("rwlock_unlock_wr");
-        ASSERT_ZERO(rwlock->num_active_readers);
-        ASSERT_LOCKED(rwlock->write_or_any_read_mutex);
-        rwlock->write_or_any_read_mutex->unlock();
-        rwlock->num_active_writers_mutex->lock();
-        ASSERT_POSITIVE(rwlock->num_active_writers);
-        rwlock->num_active_writers--;
-        PRINT_AWNUM("rwlock_unlock_wr", rwlock, "decremented");
-        ASSERT_LOCKED(rwlock->any_active_writers_mutex);
-        if (rwlock->num_active_writers == 0) {
-            PRINT_AAWLOCK("rwlock_unlock_wr", "releasing");
-            rwlock->any_active_writers_mutex->unlock();
-            PRINT_AAWLOCK("rwlock_unlock_wr", "released");
-        }
-        rwlock->num_active_writers_mutex->unlock();
+        rwlock_trace_unlock_call(rwlock);
+        rwlock->unlock_wr();
+    }
+
+    bool rwlock_yield_rd(rwlock_t *rwlock) {
+        PRINT_CALLED("rwlock_yield_rd");
+        return rwlock->yield_rd();
+    }
+
+    bool rwlock_yield_wr(rwlock_t *rwlock) {
+        PRINT_CALLED("rwlock_yield_wr");
+        return rwlock->yield_wr();
     }
 }
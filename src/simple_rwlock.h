@@ -1,30 +1,23 @@
 #ifndef SIMPLE_RWLOCK_H
 #define SIMPLE_RWLOCK_H
 
-#include <mutex>
+#include <simple_rwlock_basic.h>
 
 namespace simple_rwlock {
-#ifdef DEBUG
-    // Make any underflow bugs visible if debugging/testing.
-    typedef signed long rwlock_count_t;
-#else
-    typedef unsigned long rwlock_count_t;
-#endif
+    // Called by rwlock_t just before a thread waits for one of its mutexes.
+    // Notes when the wait started if contention profiling is on; see
+    // simple_rwlock_profile.h.
+    void rwlock_profile_record_wait();
 
-    typedef struct rwlock_t {
-        // At any given time, at most one writer may have write access.
-        // If any readers are reading then no writer may have write access.
-        std::mutex *write_or_any_read_mutex;
-        // At any given time, more than one writer may be active.
-        // A writer is active when it is either writing or waiting to write.
-        rwlock_count_t num_active_writers;
-        std::mutex *num_active_writers_mutex;
-        std::mutex *any_active_writers_mutex;
-        // At any given time, more than one reader may be active.
-        // A reader is active when it has permission to read.
-        rwlock_count_t num_active_readers;
-        std::mutex *num_active_readers_mutex;
-    } rwlock_t;
+    // Writer-biased lock that blocks in its mutexes right away and
+    // allocates each of its mutexes separately. It keeps no counts, but
+    // tries each mutex first and calls rwlock_profile_record_wait before it
+    // blocks, so contended acquisitions pay for the profiling hook even
+    // when profiling is off.
+    typedef basic_rwlock<writer_bias_policy,
+                         park_wait_policy,
+                         wait_hook_stats_policy<rwlock_profile_record_wait>,
+                         pointer_layout_policy> rwlock_t;
 
     void rwlock_init(rwlock_t *);
     void rwlock_uninit(rwlock_t *);
@@ -32,6 +25,17 @@ namespace simple_rwlock {
     void rwlock_unlock_rd(rwlock_t *);
     void rwlock_lock_wr(rwlock_t *);
     void rwlock_unlock_wr(rwlock_t *);
+
+    // Let threads of the other kind in partway through a long critical
+    // section. If a writer is waiting, rwlock_yield_rd releases read access
+    // and establishes it again after the writer is done; if a reader is
+    // waiting, rwlock_yield_wr releases write access and establishes it
+    // again after at least one reader has got in. Otherwise they only read
+    // a counter and return. Return whether access was released, in which
+    // case anything read under the lock may have changed. A traced section
+    // that yields is still recorded as one section.
+    bool rwlock_yield_rd(rwlock_t *);
+    bool rwlock_yield_wr(rwlock_t *);
 }
 
 #endif // SIMPLE_RWLOCK_H
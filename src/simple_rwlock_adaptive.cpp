@@ -0,0 +1,345 @@
+#include <atomic>
+#include <mutex>
+#include <sched.h>
+#include <thread>
+#include <unistd.h>
+
+#include <simple_rwlock_adaptive.h>
+#include <simple_rwlock_debug_helpers.h>
+#include <simple_rwlock_probes.h>
+
+namespace simple_rwlock {
+    namespace {
+        unsigned int read_num_cpus() {
+            long num_cpus = sysconf(_SC_NPROCESSORS_CONF);
+            return (num_cpus < 1) ? 1 : (unsigned int)num_cpus;
+        }
+
+        unsigned int num_cpus() {
+            static const unsigned int num = read_num_cpus();
+            return num;
+        }
+
+        // The lock's sampling window, treating 0 as 1.
+        unsigned long sampling_window(adaptive_rwlock_t *rwlock) {
+            return (rwlock->window == 0) ? 1 : rwlock->window;
+        }
+
+        adaptive_rwlock_slot_t *current_slot(adaptive_rwlock_t *rwlock) {
+            int cpu = sched_getcpu();
+            return &rwlock->slots[(cpu < 0) ? 0 : cpu % rwlock->num_slots];
+        }
+
+        // The counter a reader counts itself in while the lock is in the
+        // given mode.
+        adaptive_rwlock_slot_t *reader_slot(adaptive_rwlock_t *rwlock,
+                                            adaptive_rwlock_mode_t mode)
+        {
+            return (mode == adaptive_rwlock_mode_central)
+                ? rwlock->central : current_slot(rwlock);
+        }
+
+        // The sum of the reader counters of the current mode. Only called
+        // with the writer mutex held, so the mode cannot change. As in
+        // numa_rwlock_t, once a writer is active every counter only
+        // decreases, so a sum of zero means there are no readers left.
+        long sum_active_readers(adaptive_rwlock_t *rwlock) {
+            if (rwlock->mode.load() == adaptive_rwlock_mode_central) {
+                return rwlock->central->num_active_readers.load();
+            }
+            long sum = 0;
+            for (unsigned int i = 0; i < rwlock->num_slots; i++) {
+                sum += rwlock->slots[i].num_active_readers.load();
+            }
+            return sum;
+        }
+
+        void sum_reads(adaptive_rwlock_t *rwlock, unsigned long *num_reads,
+                       unsigned long *num_shared_reads)
+        {
+            *num_reads = rwlock->central->num_reads.load(
+                std::memory_order_relaxed);
+            *num_shared_reads = rwlock->central->num_shared_reads.load(
+                std::memory_order_relaxed);
+            for (unsigned int i = 0; i < rwlock->num_slots; i++) {
+                *num_reads += rwlock->slots[i].num_reads.load(
+                    std::memory_order_relaxed);
+                *num_shared_reads += rwlock->slots[i].num_shared_reads.load(
+                    std::memory_order_relaxed);
+            }
+        }
+
+        // Count this reader in and return true, or return false without
+        // read access if a writer became active or the mode changed.
+        // Set shared if other readers were counted in the same slot.
+        bool try_acquire_read(adaptive_rwlock_t *rwlock,
+                              adaptive_rwlock_slot_t **slot, bool *shared)
+        {
+            adaptive_rwlock_mode_t mode = rwlock->mode.load();
+            *slot = reader_slot(rwlock, mode);
+            long previous = (*slot)->num_active_readers++;
+            if (rwlock->num_active_writers.load() != 0 ||
+                rwlock->mode.load() != mode) {
+                (*slot)->num_active_readers--;
+                return false;
+            }
+            *shared = (previous > 0);
+            return true;
+        }
+
+        // Add one read to the slot's statistics and return the slot's
+        // new total.
+        unsigned long count_read(adaptive_rwlock_slot_t *slot, bool shared) {
+            if (shared) {
+                slot->num_shared_reads.fetch_add(1, std::memory_order_relaxed);
+            }
+            return slot->num_reads.fetch_add(1, std::memory_order_relaxed) + 1;
+        }
+
+        void release_read(adaptive_rwlock_t *rwlock) {
+            reader_slot(rwlock, rwlock->mode.load())->num_active_readers--;
+        }
+
+        // The reader count passed to the probes. Only the central mode
+        // keeps the count in one place.
+        [[maybe_unused]] long probe_num_readers(adaptive_rwlock_t *rwlock) {
+            if (rwlock->mode.load(std::memory_order_relaxed) !=
+                adaptive_rwlock_mode_central) {
+                return rwlock_probe_count_unknown;
+            }
+            return rwlock->central->num_active_readers.load(
+                std::memory_order_relaxed);
+        }
+
+        // Wait for write access with the writer mutex held and the number
+        // of active writers already incremented.
+        void wait_for_readers(adaptive_rwlock_t *rwlock) {
+            while (sum_active_readers(rwlock) != 0) {
+                std::this_thread::yield();
+            }
+        }
+
+        // Called with write access held. At the end of each sampling
+        // window, switch modes if the window's workload suits the other
+        // mode better, and start a new window.
+        void reconsider_mode(adaptive_rwlock_t *rwlock) {
+            unsigned long num_reads;
+            unsigned long num_shared_reads;
+            sum_reads(rwlock, &num_reads, &num_shared_reads);
+            unsigned long num_writes = rwlock->num_writes.load(
+                std::memory_order_relaxed);
+            unsigned long reads = num_reads - rwlock->window_reads;
+            unsigned long writes = num_writes - rwlock->window_writes;
+            unsigned long shared_reads =
+                num_shared_reads - rwlock->window_shared_reads;
+            if (reads + writes < sampling_window(rwlock)) {
+                return;
+            }
+            ASSERT_ZERO(sum_active_readers(rwlock));
+            if (rwlock->mode.load() == adaptive_rwlock_mode_central) {
+                if (writes * adaptive_rwlock_distribute_ratio <= reads &&
+                    shared_reads * adaptive_rwlock_shared_fraction >= reads)
+                {
+                    rwlock->mode.store(adaptive_rwlock_mode_distributed);
+                    rwlock->num_switches_to_distributed.fetch_add(
+                        1, std::memory_order_relaxed);
+                }
+            } else if (writes * adaptive_rwlock_centralize_ratio > reads) {
+                rwlock->mode.store(adaptive_rwlock_mode_central);
+                rwlock->num_switches_to_central.fetch_add(
+                    1, std::memory_order_relaxed);
+            }
+            rwlock->window_reads = num_reads;
+            rwlock->window_writes = num_writes;
+            rwlock->window_shared_reads = num_shared_reads;
+        }
+
+        // Called by a reader without read access at the end of a sampling
+        // window in the central mode, since a read-only workload never
+        // gives a writer the chance to switch modes. Skipped if a writer
+        // already holds the writer mutex; that writer will reconsider.
+        void reconsider_mode_as_writer(adaptive_rwlock_t *rwlock) {
+            if (!rwlock->writer_mutex->try_lock()) {
+                return;
+            }
+            rwlock->num_active_writers++;
+            wait_for_readers(rwlock);
+            reconsider_mode(rwlock);
+            rwlock->num_active_writers--;
+            rwlock->writer_mutex->unlock();
+        }
+    }
+
+    void adaptive_rwlock_init(adaptive_rwlock_t *rwlock) {
+        PRINT_CALLED("adaptive_rwlock_init");
+        rwlock->num_active_writers = 0;
+        rwlock->mode = adaptive_rwlock_mode_central;
+        rwlock->num_slots = num_cpus();
+        rwlock->central = new adaptive_rwlock_slot_t[rwlock->num_slots + 1];
+        rwlock->slots = rwlock->central + 1;
+        for (unsigned int i = 0; i < rwlock->num_slots + 1; i++) {
+            rwlock->central[i].num_active_readers = 0;
+            rwlock->central[i].num_reads = 0;
+            rwlock->central[i].num_shared_reads = 0;
+        }
+        rwlock->writer_mutex = new std::mutex;
+        rwlock->window = adaptive_rwlock_default_window;
+        rwlock->num_writes = 0;
+        rwlock->num_switches_to_distributed = 0;
+        rwlock->num_switches_to_central = 0;
+        rwlock->window_reads = 0;
+        rwlock->window_writes = 0;
+        rwlock->window_shared_reads = 0;
+    }
+
+    void adaptive_rwlock_uninit(adaptive_rwlock_t *rwlock) {
+        PRINT_CALLED("adaptive_rwlock_uninit");
+        ASSERT_ZERO(rwlock->num_active_writers.load());
+        delete rwlock->writer_mutex;
+        delete[] rwlock->central;
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: The rwlock object is writer-biased, so any active writers
+    //              must become inactive before the reader can establish read
+    //              access.
+    // Enforcement: Wait for the number of active writers to become zero.
+    //--------------------------------------------------------------------------
+    // Requirement: No writer may have write access while this reader has
+    //              read access.
+    // Enforcement: Increment the counter of the current mode and then check
+    //              the number of active writers again. A writer increments
+    //              the number of active writers before it checks the reader
+    //              counters, so either the writer sees this reader or this
+    //              reader sees the writer and backs off.
+    //--------------------------------------------------------------------------
+    // Requirement: The reader must be counted in the counters of the mode
+    //              the lock is in for as long as it has read access.
+    // Enforcement: Check the mode again after incrementing the counter, and
+    //              back off if it changed. The mode only changes while a
+    //              writer is active, which keeps further readers out.
+    //--------------------------------------------------------------------------
+    // Requirement: A read-only workload must still be able to switch to the
+    //              distributed mode.
+    // Enforcement: The reader that ends a sampling window in the central
+    //              mode gives up its read access, reconsiders the mode as a
+    //              writer, and starts over.
+    //--------------------------------------------------------------------------
+    void adaptive_rwlock_lock_rd(adaptive_rwlock_t *rwlock) {
+        PRINT_CALLED("adaptive_rwlock_lock_rd");
+        RWLOCK_PROBE_ACQUIRE_START(rwlock, rwlock_probe_kind_read);
+        [[maybe_unused]] bool contended = false;
+        bool counted = false;
+        while (true) {
+            if (rwlock->num_active_writers.load() != 0) {
+                RWLOCK_PROBE_ACQUIRE_CONTENDED(rwlock, rwlock_probe_kind_read);
+                contended = true;
+                do {
+                    std::this_thread::yield();
+                } while (rwlock->num_active_writers.load() != 0);
+            }
+            adaptive_rwlock_slot_t *slot;
+            bool shared;
+            if (!try_acquire_read(rwlock, &slot, &shared)) {
+                continue;
+            }
+            if (counted) {
+                break;
+            }
+            counted = true;
+            unsigned long num_reads = count_read(slot, shared);
+            if (slot != rwlock->central ||
+                num_reads % sampling_window(rwlock) != 0) {
+                break;
+            }
+            release_read(rwlock);
+            reconsider_mode_as_writer(rwlock);
+        }
+        RWLOCK_PROBE_ACQUIRED(rwlock, rwlock_probe_kind_read, contended,
+                              probe_num_readers(rwlock),
+                              rwlock->num_active_writers.load());
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: Waiting writers must be able to establish write access
+    //              after the last active reader has released its read access.
+    // Enforcement: Decrement the counter of the current mode. The mode cannot
+    //              have changed since this reader was counted in.
+    //--------------------------------------------------------------------------
+    void adaptive_rwlock_unlock_rd(adaptive_rwlock_t *rwlock) {
+        PRINT_CALLED("adaptive_rwlock_unlock_rd");
+        release_read(rwlock);
+        RWLOCK_PROBE_RELEASED(rwlock, rwlock_probe_kind_read,
+                              probe_num_readers(rwlock),
+                              rwlock->num_active_writers.load());
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: The rwlock object is writer-biased, so readers must not be
+    //              able to become active between the time this writer has
+    //              started waiting and the time it has released write access.
+    // Enforcement: Increment the number of active writers before waiting.
+    //--------------------------------------------------------------------------
+    // Requirement: The writer may not have write access while any other
+    //              writer has write access.
+    // Enforcement: Hold the writer mutex until the writer releases write
+    //              access.
+    //--------------------------------------------------------------------------
+    // Requirement: The writer may not have write access while any readers
+    //              are active.
+    // Enforcement: Wait for the sum of the current mode's reader counters to
+    //              become zero.
+    //--------------------------------------------------------------------------
+    // Requirement: The mode may only change while no reader is counted in.
+    // Enforcement: Reconsider the mode after establishing write access.
+    //--------------------------------------------------------------------------
+    void adaptive_rwlock_lock_wr(adaptive_rwlock_t *rwlock) {
+        PRINT_CALLED("adaptive_rwlock_lock_wr");
+        RWLOCK_PROBE_ACQUIRE_START(rwlock, rwlock_probe_kind_write);
+        [[maybe_unused]] bool contended = false;
+        rwlock->num_active_writers++;
+        if (!rwlock->writer_mutex->try_lock()) {
+            RWLOCK_PROBE_ACQUIRE_CONTENDED(rwlock, rwlock_probe_kind_write);
+            contended = true;
+            rwlock->writer_mutex->lock();
+        }
+        if (sum_active_readers(rwlock) != 0) {
+            RWLOCK_PROBE_ACQUIRE_CONTENDED(rwlock, rwlock_probe_kind_write);
+            contended = true;
+            wait_for_readers(rwlock);
+        }
+        rwlock->num_writes.fetch_add(1, std::memory_order_relaxed);
+        reconsider_mode(rwlock);
+        RWLOCK_PROBE_ACQUIRED(rwlock, rwlock_probe_kind_write, contended,
+                              probe_num_readers(rwlock),
+                              rwlock->num_active_writers.load());
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: Readers must be able to establish read access after the
+    //              last active writer has released write access.
+    // Enforcement: Decrement the number of active writers.
+    //--------------------------------------------------------------------------
+    void adaptive_rwlock_unlock_wr(adaptive_rwlock_t *rwlock) {
+        PRINT_CALLED("adaptive_rwlock_unlock_wr");
+        ASSERT_ZERO(sum_active_readers(rwlock));
+        ASSERT_POSITIVE(rwlock->num_active_writers.load());
+        rwlock->num_active_writers--;
+        RWLOCK_PROBE_RELEASED(rwlock, rwlock_probe_kind_write,
+                              probe_num_readers(rwlock),
+                              rwlock->num_active_writers.load());
+        rwlock->writer_mutex->unlock();
+    }
+
+    void adaptive_rwlock_get_stats(adaptive_rwlock_t *rwlock,
+                                   adaptive_rwlock_stats_t *stats)
+    {
+        stats->mode = rwlock->mode.load();
+        sum_reads(rwlock, &stats->num_reads, &stats->num_shared_reads);
+        stats->num_writes = rwlock->num_writes.load();
+        stats->num_switches_to_distributed =
+            rwlock->num_switches_to_distributed.load();
+        stats->num_switches_to_central =
+            rwlock->num_switches_to_central.load();
+    }
+}
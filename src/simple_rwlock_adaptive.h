@@ -0,0 +1,96 @@
+#ifndef SIMPLE_RWLOCK_ADAPTIVE_H
+#define SIMPLE_RWLOCK_ADAPTIVE_H
+
+#include <atomic>
+#include <mutex>
+
+#include <simple_rwlock.h>
+
+namespace simple_rwlock {
+    // How readers of an adaptive_rwlock_t count themselves.
+    typedef enum adaptive_rwlock_mode_t {
+        // One reader counter for the whole lock. Cheapest when readers
+        // seldom overlap or writers come often, since a writer only has to
+        // read one counter.
+        adaptive_rwlock_mode_central = 0,
+        // One reader counter per CPU. Readers on different CPUs never
+        // write to the same cache line, but a writer must read every
+        // counter.
+        adaptive_rwlock_mode_distributed = 1,
+    } adaptive_rwlock_mode_t;
+
+    // Default number of lock operations in each sampling window. The mode
+    // is only reconsidered at the end of a window.
+    const unsigned long adaptive_rwlock_default_window = 4096;
+    // Switch to the distributed mode when a window has at least this many
+    // reads per write, and at least one in adaptive_rwlock_shared_fraction
+    // reads found another reader already counted in the central counter.
+    const unsigned long adaptive_rwlock_distribute_ratio = 1024;
+    const unsigned long adaptive_rwlock_shared_fraction = 4;
+    // Switch back to the central mode when a window has fewer than this
+    // many reads per write.
+    const unsigned long adaptive_rwlock_centralize_ratio = 64;
+
+    // Reader counter and read statistics for one CPU, or for the whole lock
+    // in the central mode, each on its own cache line.
+    typedef struct alignas(64) adaptive_rwlock_slot_t {
+        // As in numa_rwlock_node_t, a reader that migrates between locking
+        // and unlocking decrements a different slot's counter, so only the
+        // sum over all slots is meaningful.
+        std::atomic<long> num_active_readers;
+        std::atomic<unsigned long> num_reads;
+        // Reads that found other readers counted in this slot.
+        std::atomic<unsigned long> num_shared_reads;
+    } adaptive_rwlock_slot_t;
+
+    typedef struct adaptive_rwlock_stats_t {
+        adaptive_rwlock_mode_t mode;
+        unsigned long num_reads;
+        unsigned long num_writes;
+        unsigned long num_shared_reads;
+        unsigned long num_switches_to_distributed;
+        unsigned long num_switches_to_central;
+    } adaptive_rwlock_stats_t;
+
+    // Writer-biased read-write lock that samples its own workload and
+    // changes how readers are counted to suit it. It starts in the central
+    // mode. The mode only changes while a writer, or a reader that has
+    // given up its read access to act as one, has write access, so no
+    // reader is ever counted in the counters of the mode it is not in.
+    typedef struct adaptive_rwlock_t {
+        // A writer is active when it is either writing or waiting to write.
+        std::atomic<rwlock_count_t> num_active_writers;
+        std::atomic<adaptive_rwlock_mode_t> mode;
+        unsigned int num_slots;
+        // The central mode's counter, and then num_slots per-CPU counters.
+        adaptive_rwlock_slot_t *central;
+        adaptive_rwlock_slot_t *slots;
+        std::mutex *writer_mutex;
+        // Set to adaptive_rwlock_default_window by adaptive_rwlock_init.
+        // May be changed before the lock is first used. 0 is treated as 1,
+        // which reconsiders the mode on every operation.
+        unsigned long window;
+
+        // Only written while write access is held.
+        std::atomic<unsigned long> num_writes;
+        std::atomic<unsigned long> num_switches_to_distributed;
+        std::atomic<unsigned long> num_switches_to_central;
+        // Totals at the start of the current sampling window.
+        unsigned long window_reads;
+        unsigned long window_writes;
+        unsigned long window_shared_reads;
+    } adaptive_rwlock_t;
+
+    void adaptive_rwlock_init(adaptive_rwlock_t *);
+    void adaptive_rwlock_uninit(adaptive_rwlock_t *);
+    void adaptive_rwlock_lock_rd(adaptive_rwlock_t *);
+    void adaptive_rwlock_unlock_rd(adaptive_rwlock_t *);
+    void adaptive_rwlock_lock_wr(adaptive_rwlock_t *);
+    void adaptive_rwlock_unlock_wr(adaptive_rwlock_t *);
+
+    // Totals since adaptive_rwlock_init, and the current mode.
+    void adaptive_rwlock_get_stats(adaptive_rwlock_t *,
+                                   adaptive_rwlock_stats_t *);
+}
+
+#endif // SIMPLE_RWLOCK_ADAPTIVE_H
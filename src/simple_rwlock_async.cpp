@@ -0,0 +1,240 @@
+#include <coroutine>
+#include <cstdint>
+#include <mutex>
+
+#include <simple_rwlock_debug_helpers.h>
+#include <simple_rwlock_async.h>
+#include <simple_rwlock_probes.h>
+
+namespace simple_rwlock {
+    async_rwlock_awaiter_t::async_rwlock_awaiter_t(async_rwlock_t *rwlock,
+                                                   bool write) :
+        rwlock_(rwlock),
+        write_(write),
+        handle_(nullptr),
+        next_(nullptr)
+    { }
+
+    bool async_rwlock_awaiter_t::await_ready() {
+        RWLOCK_PROBE_ACQUIRE_START(rwlock_, rwlock_->probe_kind(write_));
+        return write_ ? rwlock_->try_lock_wr() : rwlock_->try_lock_rd();
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: Access that becomes available between await_ready and
+    //              await_suspend must not be missed.
+    // Enforcement: Check again while the state mutex is locked, and if
+    //              access can be established then do not suspend.
+    //--------------------------------------------------------------------------
+    // Requirement: Waiting must not allocate memory.
+    // Enforcement: This awaiter, which lives in the suspended coroutine's
+    //              frame, is linked into the waiter queue directly.
+    //--------------------------------------------------------------------------
+    bool async_rwlock_awaiter_t::await_suspend(
+        std::coroutine_handle<> handle)
+    {
+        std::lock_guard<std::mutex> state_guard(rwlock_->state_mutex_);
+        handle_ = handle;
+        next_ = nullptr;
+        if (write_) {
+            if (rwlock_->can_lock_wr()) {
+                rwlock_->writer_has_access_ = true;
+                rwlock_->probe_acquired(true, false);
+                return false;
+            }
+            RWLOCK_PROBE_ACQUIRE_CONTENDED(rwlock_, rwlock_probe_kind_write);
+            if (rwlock_->waiting_writers_tail_) {
+                rwlock_->waiting_writers_tail_->next_ = this;
+            } else {
+                rwlock_->waiting_writers_head_ = this;
+            }
+            rwlock_->waiting_writers_tail_ = this;
+        } else {
+            if (rwlock_->can_lock_rd()) {
+                rwlock_->num_active_readers_++;
+                rwlock_->probe_acquired(false, false);
+                return false;
+            }
+            RWLOCK_PROBE_ACQUIRE_CONTENDED(rwlock_, rwlock_probe_kind_read);
+            if (rwlock_->waiting_readers_tail_) {
+                rwlock_->waiting_readers_tail_->next_ = this;
+            } else {
+                rwlock_->waiting_readers_head_ = this;
+            }
+            rwlock_->waiting_readers_tail_ = this;
+        }
+        return true;
+    }
+
+    async_rwlock_t::async_rwlock_t(async_rwlock_executor_t &executor) :
+        executor_(executor),
+        writer_has_access_(false),
+        num_active_readers_(0),
+        waiting_writers_head_(nullptr),
+        waiting_writers_tail_(nullptr),
+        waiting_readers_head_(nullptr),
+        waiting_readers_tail_(nullptr)
+    {
+        PRINT_CALLED("async_rwlock_t::async_rwlock_t");
+    }
+
+    async_rwlock_t::~async_rwlock_t() {
+        PRINT_CALLED("async_rwlock_t::~async_rwlock_t");
+        ASSERT_ZERO(num_active_readers_);
+        ASSERT_ZERO(waiting_writers_head_);
+        ASSERT_ZERO(waiting_readers_head_);
+    }
+
+    async_rwlock_awaiter_t async_rwlock_t::read() {
+        PRINT_CALLED("async_rwlock_t::read");
+        return async_rwlock_awaiter_t(this, false);
+    }
+
+    async_rwlock_awaiter_t async_rwlock_t::write() {
+        PRINT_CALLED("async_rwlock_t::write");
+        return async_rwlock_awaiter_t(this, true);
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: The rwlock object is writer-biased, so any writers that
+    //              are writing or waiting to write must become inactive
+    //              before a reader can establish read access.
+    // Enforcement: Readers may only establish read access while no writer
+    //              has write access and no writer is queued.
+    //--------------------------------------------------------------------------
+    bool async_rwlock_t::can_lock_rd() const {
+        return !writer_has_access_ && waiting_writers_head_ == nullptr;
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: The writer may not have write access while any other
+    //              writer has write access or any readers are active.
+    // Requirement: Writers establish write access in order of arrival.
+    // Enforcement: Writers may only establish write access directly when
+    //              nothing is active and no other writer is queued.
+    //--------------------------------------------------------------------------
+    bool async_rwlock_t::can_lock_wr() const {
+        return !writer_has_access_ && num_active_readers_ == 0 &&
+               waiting_writers_head_ == nullptr;
+    }
+
+    uint8_t async_rwlock_t::probe_kind(bool write) {
+        return write ? rwlock_probe_kind_write : rwlock_probe_kind_read;
+    }
+
+    void async_rwlock_t::probe_acquired([[maybe_unused]] bool write,
+                                        [[maybe_unused]] bool contended)
+    {
+        RWLOCK_PROBE_ACQUIRED(this, probe_kind(write), contended,
+                              num_active_readers_, writer_has_access_);
+    }
+
+    bool async_rwlock_t::try_lock_rd() {
+        std::lock_guard<std::mutex> state_guard(state_mutex_);
+        if (!can_lock_rd()) {
+            return false;
+        }
+        num_active_readers_++;
+        probe_acquired(false, false);
+        return true;
+    }
+
+    bool async_rwlock_t::try_lock_wr() {
+        std::lock_guard<std::mutex> state_guard(state_mutex_);
+        if (!can_lock_wr()) {
+            return false;
+        }
+        writer_has_access_ = true;
+        probe_acquired(true, false);
+        return true;
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: Waiting writers must be able to establish write access
+    //              after the last active reader has released read access.
+    // Enforcement: If no more readers are active, hand write access to the
+    //              first queued writer.
+    //--------------------------------------------------------------------------
+    // Requirement: The executor may resume a coroutine immediately, which
+    //              may destroy its awaiter and touch this lock again.
+    // Enforcement: Only post the coroutine after the state mutex has been
+    //              released and the awaiter has been unlinked.
+    //--------------------------------------------------------------------------
+    void async_rwlock_t::unlock_rd() {
+        PRINT_CALLED("async_rwlock_t::unlock_rd");
+        std::coroutine_handle<> writer_handle = nullptr;
+        { // Critical section: update lock state.
+            std::lock_guard<std::mutex> state_guard(state_mutex_);
+            ASSERT_POSITIVE(num_active_readers_);
+            num_active_readers_--;
+            RWLOCK_PROBE_RELEASED(this, rwlock_probe_kind_read,
+                                  num_active_readers_, writer_has_access_);
+            if (num_active_readers_ == 0 && waiting_writers_head_) {
+                async_rwlock_awaiter_t *writer = waiting_writers_head_;
+                waiting_writers_head_ = writer->next_;
+                if (!waiting_writers_head_) {
+                    waiting_writers_tail_ = nullptr;
+                }
+                writer_has_access_ = true;
+                writer_handle = writer->handle_;
+                probe_acquired(true, true);
+            }
+        }
+        if (writer_handle) {
+            executor_.post(writer_handle);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: Waiting writers take priority over waiting readers.
+    // Enforcement: If any writer is queued, hand write access to the first
+    //              one and leave the readers queued.
+    //--------------------------------------------------------------------------
+    // Requirement: Readers must be able to establish read access after the
+    //              last active writer has released write access.
+    // Enforcement: If no writer is queued, grant read access to every
+    //              queued reader at once.
+    //--------------------------------------------------------------------------
+    void async_rwlock_t::unlock_wr() {
+        PRINT_CALLED("async_rwlock_t::unlock_wr");
+        std::coroutine_handle<> writer_handle = nullptr;
+        async_rwlock_awaiter_t *readers = nullptr;
+        { // Critical section: update lock state.
+            std::lock_guard<std::mutex> state_guard(state_mutex_);
+            ASSERT_ZERO(num_active_readers_);
+            writer_has_access_ = false;
+            RWLOCK_PROBE_RELEASED(this, rwlock_probe_kind_write,
+                                  num_active_readers_, writer_has_access_);
+            if (waiting_writers_head_) {
+                async_rwlock_awaiter_t *writer = waiting_writers_head_;
+                waiting_writers_head_ = writer->next_;
+                if (!waiting_writers_head_) {
+                    waiting_writers_tail_ = nullptr;
+                }
+                writer_has_access_ = true;
+                writer_handle = writer->handle_;
+                probe_acquired(true, true);
+            } else {
+                readers = waiting_readers_head_;
+                waiting_readers_head_ = nullptr;
+                waiting_readers_tail_ = nullptr;
+                for (async_rwlock_awaiter_t *reader = readers; reader;
+                     reader = reader->next_)
+                {
+                    num_active_readers_++;
+                    probe_acquired(false, true);
+                }
+            }
+        }
+        if (writer_handle) {
+            executor_.post(writer_handle);
+        }
+        while (readers) {
+            // Read the next node first, since resuming the
+            // coroutine may destroy the awaiter holding it.
+            async_rwlock_awaiter_t *next = readers->next_;
+            executor_.post(readers->handle_);
+            readers = next;
+        }
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef SIMPLE_RWLOCK_ASYNC_H
+#define SIMPLE_RWLOCK_ASYNC_H
+
+#include <coroutine>
+#include <cstdint>
+#include <mutex>
+
+#include <simple_rwlock.h>
+
+namespace simple_rwlock {
+    // Interface through which an async_rwlock_t resumes a coroutine that
+    // had to wait for access. An event loop would typically queue the
+    // handle and resume it on its own thread.
+    class async_rwlock_executor_t {
+    public:
+        virtual ~async_rwlock_executor_t() { }
+        virtual void post(std::coroutine_handle<> handle) = 0;
+    };
+
+    class async_rwlock_t;
+
+    // Returned by async_rwlock_t::read and async_rwlock_t::write. While the
+    // coroutine is suspended the awaiter lives in the coroutine frame and
+    // doubles as the node in the lock's waiter queue, so waiting does not
+    // allocate any memory.
+    class async_rwlock_awaiter_t {
+    public:
+        async_rwlock_awaiter_t(async_rwlock_t *rwlock, bool write);
+        bool await_ready();
+        bool await_suspend(std::coroutine_handle<> handle);
+        void await_resume() { }
+
+    private:
+        friend class async_rwlock_t;
+
+        async_rwlock_t *rwlock_;
+        bool write_;
+        std::coroutine_handle<> handle_;
+        async_rwlock_awaiter_t *next_;
+    };
+
+    // Writer-biased read-write lock for coroutines. Following the rules
+    // of rwlock_t, a reader may not establish read access while any writer
+    // is either writing or waiting to write. Instead of blocking the
+    // thread, `co_await rwlock.read()` and `co_await rwlock.write()`
+    // suspend the coroutine, which is resumed through the executor once
+    // access has been granted. Access is released with unlock_rd and
+    // unlock_wr, which never block for longer than a short internal
+    // critical section.
+    class async_rwlock_t {
+    public:
+        async_rwlock_t(async_rwlock_executor_t &executor);
+        ~async_rwlock_t();
+        async_rwlock_t(const async_rwlock_t &) = delete;
+        async_rwlock_t &operator=(const async_rwlock_t &) = delete;
+
+        async_rwlock_awaiter_t read();
+        async_rwlock_awaiter_t write();
+        bool try_lock_rd();
+        bool try_lock_wr();
+        void unlock_rd();
+        void unlock_wr();
+
+    private:
+        friend class async_rwlock_awaiter_t;
+
+        // These functions expect state_mutex_ to be locked.
+        bool can_lock_rd() const;
+        bool can_lock_wr() const;
+        // Fire the acquired probe (simple_rwlock_probes.h). For a
+        // coroutine that was suspended, it fires on the thread that grants
+        // access, before the coroutine is posted to the executor.
+        void probe_acquired(bool write, bool contended);
+
+        static uint8_t probe_kind(bool write);
+
+        async_rwlock_executor_t &executor_;
+        // Protects every member below.
+        std::mutex state_mutex_;
+        // At any given time, at most one writer may have write access.
+        bool writer_has_access_;
+        rwlock_count_t num_active_readers_;
+        // Suspended coroutines, each queue in order of arrival.
+        async_rwlock_awaiter_t *waiting_writers_head_;
+        async_rwlock_awaiter_t *waiting_writers_tail_;
+        async_rwlock_awaiter_t *waiting_readers_head_;
+        async_rwlock_awaiter_t *waiting_readers_tail_;
+    };
+}
+
+#endif // SIMPLE_RWLOCK_ASYNC_H
@@ -0,0 +1,279 @@
+#ifndef SIMPLE_RWLOCK_BASIC_H
+#define SIMPLE_RWLOCK_BASIC_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace simple_rwlock {
+#ifdef DEBUG
+    // Make any underflow bugs visible if debugging/testing.
+    typedef signed long rwlock_count_t;
+#else
+    typedef unsigned long rwlock_count_t;
+#endif
+
+    // Hint to the CPU that the caller is spinning.
+    inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+
+    //--------------------------------------------------------------------------
+    // Bias policies decide whether readers give way to writers.
+    //--------------------------------------------------------------------------
+
+    // Readers may not establish read access while any writer is either
+    // writing or waiting to write. This is the bias of rwlock_t.
+    struct writer_bias_policy {
+        static constexpr bool readers_wait_for_writers = true;
+    };
+
+    // Readers establish read access whenever other readers already have it,
+    // even if writers are waiting. Writers may starve.
+    struct reader_bias_policy {
+        static constexpr bool readers_wait_for_writers = false;
+    };
+
+    //--------------------------------------------------------------------------
+    // Wait policies decide the mutex type and how a thread waits for it.
+    // acquire returns whether the mutex was contended, which is only worked
+    // out when track_contention is true.
+    //--------------------------------------------------------------------------
+
+    // Block in the mutex immediately. This is the behaviour of rwlock_t.
+    struct park_wait_policy {
+        typedef std::mutex mutex_t;
+
+        template <bool track_contention>
+        static bool acquire(mutex_t *mutex) {
+            if constexpr (track_contention) {
+                if (mutex->try_lock()) {
+                    return false;
+                }
+                mutex->lock();
+                return true;
+            } else {
+                mutex->lock();
+                return false;
+            }
+        }
+    };
+
+    // Spin on the mutex for up to spin_count attempts before blocking.
+    template <unsigned int spin_count = 128>
+    struct spin_then_park_wait_policy {
+        typedef std::mutex mutex_t;
+
+        template <bool track_contention>
+        static bool acquire(mutex_t *mutex) {
+            if (mutex->try_lock()) {
+                return false;
+            }
+            for (unsigned int i = 0; i < spin_count; i++) {
+                cpu_relax();
+                if (mutex->try_lock()) {
+                    return true;
+                }
+            }
+            mutex->lock();
+            return true;
+        }
+    };
+
+    //--------------------------------------------------------------------------
+    // Stats policies decide what is counted. Each provides a storage base
+    // class for basic_rwlock. record_wait is called just before a thread
+    // waits for one of the lock's mutexes, and only when records_waits is
+    // true.
+    //--------------------------------------------------------------------------
+
+    // Count nothing. The storage is empty and every call compiles away.
+    struct no_stats_policy {
+        static constexpr bool enabled = false;
+        static constexpr bool records_waits = false;
+
+        struct storage {
+            void init_stats() { }
+            void record_lock_rd(bool) { }
+            void record_lock_wr(bool) { }
+            void record_wait() { }
+        };
+    };
+
+    // Count nothing, but call hook just before a thread waits for one of
+    // the lock's mutexes. Uncontended calls pay nothing for the hook.
+    template <void (*hook)()>
+    struct wait_hook_stats_policy {
+        static constexpr bool enabled = false;
+        static constexpr bool records_waits = true;
+
+        struct storage {
+            void init_stats() { }
+            void record_lock_rd(bool) { }
+            void record_lock_wr(bool) { }
+            void record_wait() { hook(); }
+        };
+    };
+
+    // Count acquisitions of each kind, and how many of them had to wait.
+    struct counting_stats_policy {
+        static constexpr bool enabled = true;
+        static constexpr bool records_waits = false;
+
+        struct storage {
+            std::atomic<unsigned long> num_lock_rd;
+            std::atomic<unsigned long> num_contended_lock_rd;
+            std::atomic<unsigned long> num_lock_wr;
+            std::atomic<unsigned long> num_contended_lock_wr;
+
+            void init_stats() {
+                num_lock_rd = 0;
+                num_contended_lock_rd = 0;
+                num_lock_wr = 0;
+                num_contended_lock_wr = 0;
+            }
+
+            void record_lock_rd(bool contended) {
+                num_lock_rd.fetch_add(1, std::memory_order_relaxed);
+                if (contended) {
+                    num_contended_lock_rd.fetch_add(
+                        1, std::memory_order_relaxed);
+                }
+            }
+
+            void record_lock_wr(bool contended) {
+                num_lock_wr.fetch_add(1, std::memory_order_relaxed);
+                if (contended) {
+                    num_contended_lock_wr.fetch_add(
+                        1, std::memory_order_relaxed);
+                }
+            }
+
+            void record_wait() { }
+        };
+    };
+
+    //--------------------------------------------------------------------------
+    // Layout policies decide where the mutexes and counters live. Each
+    // provides a storage base class for basic_rwlock, templated on the
+    // mutex type chosen by the wait policy.
+    //--------------------------------------------------------------------------
+
+    // Allocate each mutex separately. This is the layout of rwlock_t.
+    struct pointer_layout_policy {
+        template <typename mutex_t>
+        struct storage {
+            // At any given time, at most one writer may have write access.
+            // If any readers are reading then no writer may have write
+            // access.
+            mutex_t *write_or_any_read_mutex;
+            // At any given time, more than one writer may be active.
+            // A writer is active when it is either writing or waiting to
+            // write.
+            rwlock_count_t num_active_writers;
+            mutex_t *num_active_writers_mutex;
+            mutex_t *any_active_writers_mutex;
+            // At any given time, more than one reader may be active.
+            // A reader is active when it has permission to read.
+            rwlock_count_t num_active_readers;
+            mutex_t *num_active_readers_mutex;
+            // Readers blocked waiting for writers to finish, for
+            // yield_wr to check without locking.
+            std::atomic<rwlock_count_t> num_waiting_readers;
+
+            void init_storage() {
+                write_or_any_read_mutex = new mutex_t;
+                num_active_writers_mutex = new mutex_t;
+                any_active_writers_mutex = new mutex_t;
+                num_active_readers_mutex = new mutex_t;
+            }
+
+            void uninit_storage() {
+                delete write_or_any_read_mutex;
+                delete num_active_writers_mutex;
+                delete any_active_writers_mutex;
+                delete num_active_readers_mutex;
+            }
+
+            mutex_t *woar_mutex() { return write_or_any_read_mutex; }
+            mutex_t *awnum_mutex() { return num_active_writers_mutex; }
+            mutex_t *aaw_mutex() { return any_active_writers_mutex; }
+            mutex_t *arnum_mutex() { return num_active_readers_mutex; }
+        };
+    };
+
+    // Embed the mutexes in the lock, with the reader-side and writer-side
+    // state in separate cache lines so that readers and writers updating
+    // their own counters do not invalidate each other's lines.
+    struct inline_layout_policy {
+        template <typename mutex_t>
+        struct storage {
+            alignas(64) mutex_t write_or_any_read_mutex;
+            alignas(64) rwlock_count_t num_active_writers;
+            mutex_t num_active_writers_mutex;
+            alignas(64) mutex_t any_active_writers_mutex;
+            alignas(64) rwlock_count_t num_active_readers;
+            mutex_t num_active_readers_mutex;
+            std::atomic<rwlock_count_t> num_waiting_readers;
+
+            void init_storage() { }
+            void uninit_storage() { }
+
+            mutex_t *woar_mutex() { return &write_or_any_read_mutex; }
+            mutex_t *awnum_mutex() { return &num_active_writers_mutex; }
+            mutex_t *aaw_mutex() { return &any_active_writers_mutex; }
+            mutex_t *arnum_mutex() { return &num_active_readers_mutex; }
+        };
+    };
+
+    // Read-write lock assembled from one policy of each kind. Each policy
+    // is resolved at compile time, so a configuration only contains the
+    // code it needs. The member functions are defined in
+    // simple_rwlock_basic_impl.h; include that header to instantiate a
+    // configuration other than rwlock_t.
+    template <typename bias_policy,
+              typename wait_policy,
+              typename stats_policy,
+              typename layout_policy>
+    class basic_rwlock :
+        public layout_policy::template storage<
+            typename wait_policy::mutex_t>,
+        public stats_policy::storage
+    {
+    public:
+        typedef typename wait_policy::mutex_t mutex_t;
+
+        void init();
+        void uninit();
+        void lock_rd();
+        void unlock_rd();
+        void lock_wr();
+        void unlock_wr();
+
+        // Whether any writer is active, or any reader is blocked waiting
+        // for writers, read without locking.
+        bool writers_waiting();
+        bool readers_waiting();
+
+        // Release and re-establish read or write access if a thread of
+        // the other kind is waiting, and do nothing otherwise. Return
+        // whether access was released.
+        bool yield_rd();
+        bool yield_wr();
+
+    private:
+        // Acquire a mutex through the wait policy for a thread of the
+        // given kind. Return whether it was contended, if anything needs
+        // to know; otherwise the result is always false.
+        bool acquire(mutex_t *mutex, uint8_t kind);
+        // Acquire a mutex on the reader side, counting this reader in
+        // num_waiting_readers while it is blocked.
+        bool acquire_as_reader(mutex_t *mutex);
+        rwlock_count_t load_num_active_writers();
+        void set_num_active_writers(rwlock_count_t value);
+    };
+}
+
+#endif // SIMPLE_RWLOCK_BASIC_H
@@ -0,0 +1,393 @@
+#ifndef SIMPLE_RWLOCK_BASIC_IMPL_H
+#define SIMPLE_RWLOCK_BASIC_IMPL_H
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include <simple_rwlock_debug_helpers.h>
+#include <simple_rwlock_basic.h>
+#include <simple_rwlock_probes.h>
+
+// Member function definitions of basic_rwlock. Only include this header
+// from code that instantiates its own configuration of basic_rwlock;
+// rwlock_t is instantiated once in simple_rwlock.cpp.
+namespace simple_rwlock {
+#define BASIC_RWLOCK_TEMPLATE \
+    template <typename bias_policy, typename wait_policy, \
+              typename stats_policy, typename layout_policy>
+#define BASIC_RWLOCK \
+    basic_rwlock<bias_policy, wait_policy, stats_policy, layout_policy>
+
+    BASIC_RWLOCK_TEMPLATE
+    void BASIC_RWLOCK::init() {
+        this->num_active_readers = 0;
+        this->num_active_writers = 0;
+        this->init_storage();
+        this->num_waiting_readers.store(0, std::memory_order_relaxed);
+        this->init_stats();
+    }
+
+    BASIC_RWLOCK_TEMPLATE
+    void BASIC_RWLOCK::uninit() {
+        this->uninit_storage();
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: The rwlock object is writer-biased, so any active writers
+    //              (either writing or waiting to write) must become inactive
+    //              before the reader can establish read access.
+    // Enforcement: The any_active_writers mutex must become locked.
+    //--------------------------------------------------------------------------
+    // Requirement: No writers have write access between the time any reader
+    //              has established read access and the time all readers are
+    //              no longer reading.
+    // Enforcement: The write_or_any_read mutex must be locked. Either this
+    //              reader will lock the write_or_any_read mutex or some other
+    //              reader has already locked the write_or_any_read mutex when
+    //              it became active.
+    //--------------------------------------------------------------------------
+    // Requirement: This function call must accurately determine whether or not
+    //              to lock the write_or_any_read mutex.
+    // Enforcement: The number of active readers is checked for zero while the
+    //              mutex protecting the number of active readers counter is
+    //              locked. If it is zero then lock the write_or_any_read
+    //              mutex.
+    //--------------------------------------------------------------------------
+    // Requirement: Future calls to the rwlock_lock_rd function must have the
+    //              information needed to accurately determine whether to lock
+    //              the write_or_any_read mutex.
+    // Requirement: Future calls to the rwlock_unlock_rd function must have the
+    //              information needed to accurately determine whether to
+    //              unlock the write_or_any_read mutex.
+    // Enforcement: The number of readers counter is incremented while the
+    //              mutex protecting the number of readers counter is locked.
+    //--------------------------------------------------------------------------
+    // Requirement: Other readers may start reading between the time this
+    //              reader has established its read access and the time this
+    //              reader has released its read access.
+    // Enforcement: Release the mutex protecting the number of readers counter
+    //              by the time this function completes execution.
+    //--------------------------------------------------------------------------
+    // Requirement: Writers are able to start waiting to write between the
+    //              time a reader has established read access and the time
+    //              reading completes.
+    // Enforcement: Release the any_active_writers mutex after the
+    //              write_or_any_read_mutex is locked and before this
+    //              function completes execution.
+    //--------------------------------------------------------------------------
+    // With reader_bias_policy the any_active_writers mutex is skipped and
+    // only the requirements that do not mention it apply.
+    //--------------------------------------------------------------------------
+    BASIC_RWLOCK_TEMPLATE
+    void BASIC_RWLOCK::lock_rd() {
+        RWLOCK_PROBE_ACQUIRE_START(this, rwlock_probe_kind_read);
+        bool contended = false;
+        if constexpr (bias_policy::readers_wait_for_writers) {
+            PRINT_AAWLOCK("rwlock_lock_rd", "acquiring");
+            contended |= acquire_as_reader(this->aaw_mutex());
+            PRINT_AAWLOCK("rwlock_lock_rd", "locked");
+        }
+        contended |= acquire(this->arnum_mutex(), rwlock_probe_kind_read);
+        if (this->num_active_readers == 0) {
+            PRINT_WOARLOCK("rwlock_lock_rd", "acquiring");
+            contended |= acquire_as_reader(this->woar_mutex());
+            PRINT_WOARLOCK("rwlock_lock_rd", "locked");
+        }
+        ASSERT_LOCKED(this->woar_mutex());
+        this->num_active_readers++;
+        PRINT_ARNUM("rwlock_lock_rd", this, "incremented");
+        RWLOCK_PROBE_ACQUIRED(this, rwlock_probe_kind_read, contended,
+                              this->num_active_readers,
+                              load_num_active_writers());
+        this->arnum_mutex()->unlock();
+        if constexpr (bias_policy::readers_wait_for_writers) {
+            ASSERT_LOCKED(this->aaw_mutex());
+            PRINT_AAWLOCK("rwlock_lock_rd", "releasing");
+            this->aaw_mutex()->unlock();
+            PRINT_AAWLOCK("rwlock_lock_rd", "released");
+        }
+        this->record_lock_rd(contended);
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: Waiting writers must be able to establish write access
+    //              after the last active reader has released its read access.
+    // Requirement: Readers must be able to establish read access after the
+    //              last active reader has released read access.
+    // Enforcement: The write_or_any_read mutex is unlocked if no more
+    //              readers are active.
+    //--------------------------------------------------------------------------
+    // Requirement: Future calls to the rwlock_lock_rd function must have the
+    //              information needed to accurately determine whether to
+    //              lock the write_or_any_read mutex.
+    // Requirement: Future calls to the rwlock_unlock_rd function must have
+    //              the information needed to accurately determine whether to
+    //              unlock the write_or_any_read mutex.
+    // Enforcement: The number of readers is decremented while the mutex
+    //              protecting the number of readers counter is locked.
+    //--------------------------------------------------------------------------
+    // Requirement: This function call must accurately determine whether or
+    //              not to release the write_or_any_read mutex.
+    // Enforcement: The number of readers is checked for zero while the mutex
+    //              protecting the number of readers counter is locked. If it
+    //              is zero then unlock the write_or_any_read mutex.
+    //--------------------------------------------------------------------------
+    // Requirement: Readers must be able to establish read access after any
+    //              active reader has released its read access.
+    // Enforcement: Release the mutex protecting the number of active readers
+    //              counter by the time this function completes execution.
+    //--------------------------------------------------------------------------
+    BASIC_RWLOCK_TEMPLATE
+    void BASIC_RWLOCK::unlock_rd() {
+        wait_policy::template acquire<false>(this->arnum_mutex());
+        ASSERT_POSITIVE(this->num_active_readers);
+        this->num_active_readers--;
+        PRINT_ARNUM("rwlock_unlock_rd", this, "decremented");
+        RWLOCK_PROBE_RELEASED(this, rwlock_probe_kind_read,
+                              this->num_active_readers,
+                              load_num_active_writers());
+        if (this->num_active_readers == 0) {
+            PRINT_WOARLOCK("rwlock_unlock_rd", "releasing");
+            this->woar_mutex()->unlock();
+        }
+        this->arnum_mutex()->unlock();
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: The rwlock object is writer-biased, so readers must not be
+    //              able to become active between the time this writer has
+    //              started waiting and the time it has released write access.
+    // Enforcement: The any_active_writers mutex must be locked. Either this
+    //              writer will lock the any_active_writers mutex or some other
+    //              writer has already any_active_writers mutex when it became
+    //              active.
+    //--------------------------------------------------------------------------
+    // Requirement: This function call must accurately determine whether or not
+    //              to lock the any_active_writers mutex.
+    // Enforcement: The number of active writers is checked for zero after
+    //              locking the mutex protecting the number of active writers
+    //              counter. If it is zero then lock the any_active_writers
+    //              mutex.
+    //--------------------------------------------------------------------------
+    // Requirement: Future calls to the rwlock_lock_wr function must have the
+    //              information needed to accurately determine whether to lock
+    //              the any_active_writers mutex.
+    // Requirement: Future calls to the rwlock_unlock_wr function must have the
+    //              information needed to accurately determine whether to
+    //              unlock the any_active_writers mutex.
+    // Enforcement: The number of active writers counter is incremented while
+    //              the mutex protecting the number of active writers counter
+    //              is locked.
+    //--------------------------------------------------------------------------
+    // Requirement: The writer may not have write access while any other
+    //              writers have write access.
+    // Requirement: The write may not have write access while any readers
+    //              are active.
+    // Requirement: The writer must establish write access by the time this
+    //              function completes execution.
+    // Enforcement: Always lock the write_or_any_read mutex in this funciton.
+    //--------------------------------------------------------------------------
+    // Requirement: Other writers may start waiting to write between the time
+    //              this writer starts waiting and the time this writer
+    //              establishes write access.
+    // Enforcement: Release the mutex protecting the number of writers counter
+    //              before locking the write access mutex.
+    //--------------------------------------------------------------------------
+    BASIC_RWLOCK_TEMPLATE
+    void BASIC_RWLOCK::lock_wr() {
+        RWLOCK_PROBE_ACQUIRE_START(this, rwlock_probe_kind_write);
+        bool contended = acquire(this->awnum_mutex(), rwlock_probe_kind_write);
+        if (this->num_active_writers == 0) {
+            PRINT_AAWLOCK("rwlock_lock_wr", "acquiring");
+            contended |= acquire(this->aaw_mutex(), rwlock_probe_kind_write);
+            PRINT_AAWLOCK("rwlock_lock_wr", "locked");
+        }
+        ASSERT_LOCKED(this->aaw_mutex());
+        set_num_active_writers(this->num_active_writers + 1);
+        PRINT_AWNUM("rwlock_lock_wr", this, "incremented");
+        this->awnum_mutex()->unlock();
+        PRINT_WOARLOCK("rwlock_lock_wr", "acquiring");
+        contended |= acquire(this->woar_mutex(), rwlock_probe_kind_write);
+        PRINT_WOARLOCK("rwlock_lock_wr", "locked");
+        ASSERT_ZERO(this->num_active_readers);
+        RWLOCK_PROBE_ACQUIRED(this, rwlock_probe_kind_write, contended,
+                              this->num_active_readers,
+                              load_num_active_writers());
+        this->record_lock_wr(contended);
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: Waiting writers must be able to establish write access
+    //              after a writer has released write access.
+    // Requirement: Readers must potentially be able to establish read
+    //              access after a writer has released write access.
+    // Enforcement: Always unlock the write_or_any_read mutex.
+    //--------------------------------------------------------------------------
+    // Requirement: Readers must be able to establish read access after the
+    //              last active writer has released write access.
+    // Enforcement: The any_active_writers mutex is unlocked if no more
+    //              writers are active.
+    //--------------------------------------------------------------------------
+    // Requirement: Future calls to the rwlock_lock_wr function must have the
+    //              information needed to accurately determine whether to lock
+    //              the any_active_writers mutex.
+    // Requirement: Future calls to the rwlock_unlock_wr function must have the
+    //              information needed to accurately determine whether to
+    //              unlock the any_active_writers mutex.
+    // Enforcement: The number of active writers counter is decremented while
+    //              the mutex protecting the number of active writers counter
+    //              is locked.
+    //--------------------------------------------------------------------------
+    // Requirement: This function call must accurately determine whether or not
+    //              to unlock the any_active_writers mutex.
+    // Enforcement: Check the number of active writers while the mutex
+    //              protecting the number of active writers counter is locked.
+    //              If it is zero then unlock the any_active_writers mutex.
+    //--------------------------------------------------------------------------
+    // Requirement: Writers must be able to start waiting to write after any
+    //              writer with write access has released its write access.
+    // Enforcement: Release the mutex protecting the number of active writers
+    //              counter by the time this function completes execution.
+    //--------------------------------------------------------------------------
+    BASIC_RWLOCK_TEMPLATE
+    void BASIC_RWLOCK::unlock_wr() {
+        ASSERT_ZERO(this->num_active_readers);
+        ASSERT_LOCKED(this->woar_mutex());
+        this->woar_mutex()->unlock();
+        wait_policy::template acquire<false>(this->awnum_mutex());
+        ASSERT_POSITIVE(this->num_active_writers);
+        set_num_active_writers(this->num_active_writers - 1);
+        PRINT_AWNUM("rwlock_unlock_wr", this, "decremented");
+        RWLOCK_PROBE_RELEASED(this, rwlock_probe_kind_write,
+                              this->num_active_readers,
+                              this->num_active_writers);
+        ASSERT_LOCKED(this->aaw_mutex());
+        if (this->num_active_writers == 0) {
+            PRINT_AAWLOCK("rwlock_unlock_wr", "releasing");
+            this->aaw_mutex()->unlock();
+            PRINT_AAWLOCK("rwlock_unlock_wr", "released");
+        }
+        this->awnum_mutex()->unlock();
+    }
+
+    BASIC_RWLOCK_TEMPLATE
+    bool BASIC_RWLOCK::writers_waiting() {
+        return load_num_active_writers() > 0;
+    }
+
+    BASIC_RWLOCK_TEMPLATE
+    bool BASIC_RWLOCK::readers_waiting() {
+        return this->num_waiting_readers.load(std::memory_order_relaxed) > 0;
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: Waiting writers must be able to establish write access
+    //              before this reader establishes read access again.
+    // Enforcement: Any waiting writer has already locked the
+    //              any_active_writers mutex, so with writer_bias_policy
+    //              lock_rd blocks until the writers are done. With
+    //              reader_bias_policy only the last active reader yields to
+    //              writers.
+    //--------------------------------------------------------------------------
+    BASIC_RWLOCK_TEMPLATE
+    bool BASIC_RWLOCK::yield_rd() {
+        if (!writers_waiting()) {
+            return false;
+        }
+        unlock_rd();
+        lock_rd();
+        return true;
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: At least one waiting reader must be able to establish
+    //              read access before this writer establishes write access
+    //              again.
+    // Enforcement: Readers leave the waiting count once they are past the
+    //              mutex they were blocked in, after which a writer can only
+    //              delay them, not keep them out. Wait for the count to drop
+    //              before calling lock_wr, since the released mutexes would
+    //              otherwise usually be taken again before any woken reader
+    //              gets to run. If another writer is active, readers cannot
+    //              get in until it is done, so queue up behind it in lock_wr
+    //              right away instead of yielding for its whole critical
+    //              section.
+    //--------------------------------------------------------------------------
+    BASIC_RWLOCK_TEMPLATE
+    bool BASIC_RWLOCK::yield_wr() {
+        rwlock_count_t waiting =
+            this->num_waiting_readers.load(std::memory_order_relaxed);
+        if (waiting == 0) {
+            return false;
+        }
+        unlock_wr();
+        for (;;) {
+            rwlock_count_t now =
+                this->num_waiting_readers.load(std::memory_order_relaxed);
+            if (now == 0 || now < waiting || writers_waiting()) {
+                break;
+            }
+            std::this_thread::yield();
+        }
+        lock_wr();
+        return true;
+    }
+
+    // Contention is only worked out for the stats policy or the probes.
+    // With the probes built in, or a stats policy that records waits, try
+    // the mutex first so that acquire_contended and record_wait come
+    // before the thread waits. A failed try_lock only costs anything when
+    // the thread would have waited anyway. Otherwise the wait policy only
+    // tracks contention if the stats policy counts it, and with
+    // no_stats_policy the result is unused and compiles away.
+    BASIC_RWLOCK_TEMPLATE
+    bool BASIC_RWLOCK::acquire(mutex_t *mutex, uint8_t kind) {
+        if constexpr (SIMPLE_RWLOCK_PROBES || stats_policy::records_waits) {
+            if (mutex->try_lock()) {
+                return false;
+            }
+            RWLOCK_PROBE_ACQUIRE_CONTENDED(this, kind);
+            this->record_wait();
+            wait_policy::template acquire<false>(mutex);
+            return true;
+        } else {
+            (void)kind;
+            return wait_policy::template acquire<stats_policy::enabled>(
+                mutex);
+        }
+    }
+
+    BASIC_RWLOCK_TEMPLATE
+    bool BASIC_RWLOCK::acquire_as_reader(mutex_t *mutex) {
+        if (mutex->try_lock()) {
+            return false;
+        }
+        RWLOCK_PROBE_ACQUIRE_CONTENDED(this, rwlock_probe_kind_read);
+        this->record_wait();
+        this->num_waiting_readers.fetch_add(1, std::memory_order_relaxed);
+        wait_policy::template acquire<false>(mutex);
+        this->num_waiting_readers.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // num_active_writers is only changed with its mutex locked, but
+    // writers_waiting and the probes read it without, so loads and stores
+    // must be atomic.
+    BASIC_RWLOCK_TEMPLATE
+    rwlock_count_t BASIC_RWLOCK::load_num_active_writers() {
+        return std::atomic_ref<rwlock_count_t>(this->num_active_writers)
+            .load(std::memory_order_relaxed);
+    }
+
+    BASIC_RWLOCK_TEMPLATE
+    void BASIC_RWLOCK::set_num_active_writers(rwlock_count_t value) {
+        std::atomic_ref<rwlock_count_t>(this->num_active_writers)
+            .store(value, std::memory_order_relaxed);
+    }
+
+#undef BASIC_RWLOCK
+#undef BASIC_RWLOCK_TEMPLATE
+}
+
+#endif // SIMPLE_RWLOCK_BASIC_IMPL_H
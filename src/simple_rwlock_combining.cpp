@@ -0,0 +1,140 @@
+#include <atomic>
+#include <mutex>
+
+#include <simple_rwlock_debug_helpers.h>
+#include <simple_rwlock.h>
+#include <simple_rwlock_combining.h>
+
+namespace simple_rwlock {
+    namespace {
+        //----------------------------------------------------------------------
+        // Requirement: Writes posted by one thread run in the order they
+        //              were posted, and writes from different threads run
+        //              roughly in the order they were posted.
+        // Enforcement: The publication list is most recent first, so reverse
+        //              the list before running it.
+        //----------------------------------------------------------------------
+        // Requirement: A posting thread may return as soon as its request is
+        //              marked done, which invalidates the request.
+        // Enforcement: Read the next pointer before marking a request done.
+        //----------------------------------------------------------------------
+        // Returns whether there were any requests to run. The
+        // caller must have write access to the underlying rwlock.
+        bool run_published(combining_rwlock_t *rwlock) {
+            combining_rwlock_request_t *batch =
+                rwlock->publication_list.exchange(nullptr);
+            if (!batch) {
+                return false;
+            }
+            combining_rwlock_request_t *in_order = nullptr;
+            while (batch) {
+                combining_rwlock_request_t *next = batch->next;
+                batch->next = in_order;
+                in_order = batch;
+                batch = next;
+            }
+            while (in_order) {
+                combining_rwlock_request_t *next = in_order->next;
+                in_order->function(in_order->argument);
+                in_order->done.store(true, std::memory_order_release);
+                rwlock->num_combined_writes++;
+                in_order = next;
+            }
+            rwlock->num_batches++;
+            return true;
+        }
+
+        //----------------------------------------------------------------------
+        // Requirement: Posted writes must run with write access, and many
+        //              posted writes should share a single wait for readers
+        //              to drain.
+        // Enforcement: Acquire write access once, then repeatedly take the
+        //              whole publication list and run every request in it.
+        //              Requests posted while the combiner waited for write
+        //              access are all picked up by the first pass.
+        //----------------------------------------------------------------------
+        void combine(combining_rwlock_t *rwlock) {
+            rwlock_lock_wr(&rwlock->rwlock);
+            for (unsigned int i = 0; i < combining_rwlock_max_passes; i++) {
+                if (!run_published(rwlock)) {
+                    break;
+                }
+            }
+            rwlock_unlock_wr(&rwlock->rwlock);
+        }
+    }
+
+    void combining_rwlock_init(combining_rwlock_t *rwlock) {
+        PRINT_CALLED("combining_rwlock_init");
+        rwlock_init(&rwlock->rwlock);
+        rwlock->publication_list = nullptr;
+        rwlock->combiner_mutex = new std::mutex;
+        rwlock->num_batches = 0;
+        rwlock->num_combined_writes = 0;
+    }
+
+    void combining_rwlock_uninit(combining_rwlock_t *rwlock) {
+        PRINT_CALLED("combining_rwlock_uninit");
+        ASSERT_ZERO(rwlock->publication_list.load());
+        delete rwlock->combiner_mutex;
+        rwlock_uninit(&rwlock->rwlock);
+    }
+
+    void combining_rwlock_lock_rd(combining_rwlock_t *rwlock) {
+        rwlock_lock_rd(&rwlock->rwlock);
+    }
+
+    void combining_rwlock_unlock_rd(combining_rwlock_t *rwlock) {
+        rwlock_unlock_rd(&rwlock->rwlock);
+    }
+
+    void combining_rwlock_lock_wr(combining_rwlock_t *rwlock) {
+        rwlock_lock_wr(&rwlock->rwlock);
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: Whichever thread has write access should run the writes
+    //              posted so far, so that they share this writer's wait for
+    //              readers to drain.
+    // Enforcement: Run the publication list once before releasing write
+    //              access.
+    //--------------------------------------------------------------------------
+    void combining_rwlock_unlock_wr(combining_rwlock_t *rwlock) {
+        run_published(rwlock);
+        rwlock_unlock_wr(&rwlock->rwlock);
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: Posting a write must not block other threads from posting
+    //              their own writes.
+    // Enforcement: Push the request onto the publication list with a
+    //              compare-and-swap loop.
+    //--------------------------------------------------------------------------
+    // Requirement: The posted write must have run before this function
+    //              completes execution.
+    // Enforcement: Block on the combiner mutex. Whoever holds it is running
+    //              posted requests; once this thread holds it, either the
+    //              request has been run by a previous combiner or this
+    //              thread becomes the combiner and runs it.
+    //--------------------------------------------------------------------------
+    void combining_rwlock_write(combining_rwlock_t *rwlock,
+                                void (*function)(void *), void *argument)
+    {
+        PRINT_CALLED("combining_rwlock_write");
+        combining_rwlock_request_t request;
+        request.function = function;
+        request.argument = argument;
+        request.done.store(false, std::memory_order_relaxed);
+        request.next = rwlock->publication_list.load();
+        while (!rwlock->publication_list.compare_exchange_weak(
+                   request.next, &request))
+        { }
+
+        rwlock->combiner_mutex->lock();
+        if (!request.done.load(std::memory_order_acquire)) {
+            combine(rwlock);
+        }
+        rwlock->combiner_mutex->unlock();
+        ASSERT_POSITIVE(request.done.load());
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef SIMPLE_RWLOCK_COMBINING_H
+#define SIMPLE_RWLOCK_COMBINING_H
+
+#include <atomic>
+#include <mutex>
+#include <type_traits>
+
+#include <simple_rwlock.h>
+
+namespace simple_rwlock {
+    // Maximum number of times a combiner empties the publication list
+    // before it releases write access, so that one unlucky thread does
+    // not keep running other threads' writes forever.
+    const unsigned int combining_rwlock_max_passes = 4;
+
+    // A write posted to a combining_rwlock_t. Requests live on the stack of
+    // the posting thread, which does not return until the request is done.
+    typedef struct combining_rwlock_request_t {
+        void (*function)(void *);
+        void *argument;
+        std::atomic<bool> done;
+        combining_rwlock_request_t *next;
+    } combining_rwlock_request_t;
+
+    typedef struct combining_rwlock_t {
+        // Readers and direct writers use the underlying rwlock as usual.
+        rwlock_t rwlock;
+        // Posted requests that have not run yet, most recent first.
+        std::atomic<combining_rwlock_request_t *> publication_list;
+        // At any given time, at most one thread is running posted requests.
+        std::mutex *combiner_mutex;
+        // Number of batches of posted requests run and the total number of
+        // requests run. Only updated by the thread with write access.
+        unsigned long num_batches;
+        unsigned long num_combined_writes;
+    } combining_rwlock_t;
+
+    void combining_rwlock_init(combining_rwlock_t *);
+    void combining_rwlock_uninit(combining_rwlock_t *);
+    void combining_rwlock_lock_rd(combining_rwlock_t *);
+    void combining_rwlock_unlock_rd(combining_rwlock_t *);
+    void combining_rwlock_lock_wr(combining_rwlock_t *);
+    void combining_rwlock_unlock_wr(combining_rwlock_t *);
+
+    // Run function(argument) with write access. The call may be run by
+    // another thread in a batch with other posted writes, including by a
+    // thread releasing write access with combining_rwlock_unlock_wr, but
+    // this function does not return until it has run. The function must
+    // not throw and must not try to lock the same rwlock.
+    void combining_rwlock_write(combining_rwlock_t *,
+                                void (*function)(void *), void *argument);
+
+    // Convenience overload for lambdas and other callable objects.
+    template <typename Function>
+    inline void combining_rwlock_write(combining_rwlock_t *rwlock,
+                                       Function &&function)
+    {
+        typedef typename std::remove_reference<Function>::type function_t;
+        combining_rwlock_write(
+            rwlock,
+            [](void *argument) { (*static_cast<function_t *>(argument))(); },
+            const_cast<void *>(static_cast<const void *>(&function)));
+    }
+}
+
+#endif // SIMPLE_RWLOCK_COMBINING_H
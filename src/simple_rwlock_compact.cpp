@@ -0,0 +1,251 @@
+#include <atomic>
+#include <cstdint>
+
+#include <simple_rwlock_basic.h>
+#include <simple_rwlock_debug_helpers.h>
+#include <simple_rwlock_parking_lot.h>
+#include <simple_rwlock_probes.h>
+#include <simple_rwlock_compact.h>
+
+namespace simple_rwlock {
+    static_assert(sizeof(compact_rwlock_t) == 4,
+                  "compact_rwlock_t must stay one 32-bit word");
+
+    namespace {
+        const uint32_t reader_mask = compact_rwlock_max_readers;
+        const uint32_t write_locked = 1u << 24;
+        // Set before a thread parks, and cleared with the parking lot bucket
+        // locked once no thread of that kind is left parked. A bit may stay
+        // set after its thread gave up on parking; the next unlock that
+        // sees it goes through the parking lot and clears it.
+        const uint32_t readers_parked = 1u << 25;
+        const uint32_t writers_parked = 1u << 26;
+
+        // Number of times to check the lock word before parking.
+        const unsigned int spin_count = 64;
+
+        bool readers_blocked(uint32_t state) {
+            return (state & (write_locked | writers_parked)) != 0;
+        }
+
+        bool writer_blocked(uint32_t state) {
+            return (state & (write_locked | reader_mask)) != 0;
+        }
+
+        // Try to establish read access, starting from state, which is
+        // updated to the latest value seen.
+        bool try_lock_rd(compact_rwlock_t *rwlock, uint32_t &state) {
+            while (!readers_blocked(state)) {
+                ASSERT_POSITIVE((reader_mask - (state & reader_mask)));
+                if (rwlock->state.compare_exchange_weak(
+                        state, state + 1, std::memory_order_acquire,
+                        std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool try_lock_wr(compact_rwlock_t *rwlock, uint32_t &state) {
+            while (!writer_blocked(state)) {
+                if (rwlock->state.compare_exchange_weak(
+                        state, state | write_locked,
+                        std::memory_order_acquire,
+                        std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Spin until blocked(state) is false or spin_count checks have been
+        // made, and return the last state seen.
+        uint32_t spin_while(compact_rwlock_t *rwlock,
+                            bool (*blocked)(uint32_t))
+        {
+            uint32_t state = rwlock->state.load(std::memory_order_relaxed);
+            for (unsigned int i = 0; i < spin_count && blocked(state); i++) {
+                cpu_relax();
+                state = rwlock->state.load(std::memory_order_relaxed);
+            }
+            return state;
+        }
+
+        // Wake waiters and clear the parked bits of any kind of thread
+        // that no longer has any parked.
+        void unpark(compact_rwlock_t *rwlock) {
+            parking_lot_unpark(
+                rwlock, [rwlock](const parking_lot_counts_t &remaining) {
+                    uint32_t clear = 0;
+                    if (remaining.num_readers == 0) {
+                        clear |= readers_parked;
+                    }
+                    if (remaining.num_writers == 0) {
+                        clear |= writers_parked;
+                    }
+                    rwlock->state.fetch_and(~clear,
+                                            std::memory_order_relaxed);
+                });
+        }
+    }
+
+    void compact_rwlock_init(compact_rwlock_t *rwlock) {
+        PRINT_CALLED("compact_rwlock_init");
+        rwlock->state.store(0, std::memory_order_relaxed);
+    }
+
+    void compact_rwlock_uninit(compact_rwlock_t *rwlock) {
+        PRINT_CALLED("compact_rwlock_uninit");
+        ASSERT_ZERO((rwlock->state.load() & (reader_mask | write_locked)));
+        (void)rwlock;
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: The rwlock object is writer-biased, so any active writers
+    //              must become inactive before the reader can establish read
+    //              access.
+    // Enforcement: Only increment the reader count while neither the write
+    //              locked bit nor the writers parked bit is set.
+    //--------------------------------------------------------------------------
+    // Requirement: No writer may have write access while this reader has
+    //              read access.
+    // Enforcement: The reader count and the write locked bit are in the
+    //              same word and change by compare-and-swap, so a writer
+    //              only sets the write locked bit while the count is zero.
+    //--------------------------------------------------------------------------
+    // Requirement: A reader that parks must be woken once readers may
+    //              establish read access again.
+    // Enforcement: Set the readers parked bit before parking, and only park
+    //              if it is still set and readers are still blocked while the
+    //              parking lot bucket is locked. Whoever clears the write
+    //              locked bit afterwards sees the readers parked bit and
+    //              wakes the readers.
+    //--------------------------------------------------------------------------
+    void compact_rwlock_lock_rd(compact_rwlock_t *rwlock) {
+        PRINT_CALLED("compact_rwlock_lock_rd");
+        RWLOCK_PROBE_ACQUIRE_START(rwlock, rwlock_probe_kind_read);
+        uint32_t state = rwlock->state.load(std::memory_order_relaxed);
+        // state is the value replaced, so the count is one more.
+        if (try_lock_rd(rwlock, state)) {
+            RWLOCK_PROBE_ACQUIRED(rwlock, rwlock_probe_kind_read, false,
+                                  (state & reader_mask) + 1, 0);
+            return;
+        }
+        RWLOCK_PROBE_ACQUIRE_CONTENDED(rwlock, rwlock_probe_kind_read);
+        while (true) {
+            state = spin_while(rwlock, readers_blocked);
+            if (try_lock_rd(rwlock, state)) {
+                RWLOCK_PROBE_ACQUIRED(rwlock, rwlock_probe_kind_read, true,
+                                      (state & reader_mask) + 1, 0);
+                return;
+            }
+            if ((state & readers_parked) == 0 &&
+                !rwlock->state.compare_exchange_weak(
+                    state, state | readers_parked,
+                    std::memory_order_relaxed)) {
+                continue;
+            }
+            parking_lot_park(rwlock, false, [rwlock]() {
+                uint32_t state = rwlock->state.load(
+                    std::memory_order_relaxed);
+                return (state & readers_parked) != 0 &&
+                    readers_blocked(state);
+            });
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: Waiting writers must be able to establish write access
+    //              after the last active reader has released its read access.
+    // Enforcement: The last reader to leave wakes a parked writer if the
+    //              writers parked bit is set.
+    //--------------------------------------------------------------------------
+    void compact_rwlock_unlock_rd(compact_rwlock_t *rwlock) {
+        PRINT_CALLED("compact_rwlock_unlock_rd");
+        uint32_t previous = rwlock->state.fetch_sub(
+            1, std::memory_order_release);
+        ASSERT_POSITIVE((previous & reader_mask));
+        uint32_t state = previous - 1;
+        RWLOCK_PROBE_RELEASED(rwlock, rwlock_probe_kind_read,
+                              state & reader_mask, 0);
+        if ((state & reader_mask) == 0 && (state & writers_parked) != 0) {
+            unpark(rwlock);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: The writer may not have write access while any other
+    //              writer has write access or any readers are active.
+    // Enforcement: Only set the write locked bit while it is clear and the
+    //              reader count is zero.
+    //--------------------------------------------------------------------------
+    // Requirement: The rwlock object is writer-biased, so readers must not be
+    //              able to become active while this writer is waiting.
+    // Enforcement: Set the writers parked bit before parking. Readers do not
+    //              establish read access while it is set.
+    //--------------------------------------------------------------------------
+    // Requirement: A writer that parks must be woken once it may be able to
+    //              establish write access.
+    // Enforcement: Only park if the writers parked bit is still set and the
+    //              writer is still blocked while the parking lot bucket is
+    //              locked. The last reader to leave and every writer that
+    //              releases write access wake a writer if the bit is set.
+    //--------------------------------------------------------------------------
+    void compact_rwlock_lock_wr(compact_rwlock_t *rwlock) {
+        PRINT_CALLED("compact_rwlock_lock_wr");
+        RWLOCK_PROBE_ACQUIRE_START(rwlock, rwlock_probe_kind_write);
+        uint32_t state = 0;
+        if (rwlock->state.compare_exchange_strong(
+                state, write_locked, std::memory_order_acquire,
+                std::memory_order_relaxed)) {
+            RWLOCK_PROBE_ACQUIRED(rwlock, rwlock_probe_kind_write, false,
+                                  0, 1);
+            return;
+        }
+        RWLOCK_PROBE_ACQUIRE_CONTENDED(rwlock, rwlock_probe_kind_write);
+        while (true) {
+            state = spin_while(rwlock, writer_blocked);
+            if (try_lock_wr(rwlock, state)) {
+                RWLOCK_PROBE_ACQUIRED(rwlock, rwlock_probe_kind_write, true,
+                                      0, 1);
+                return;
+            }
+            if ((state & writers_parked) == 0 &&
+                !rwlock->state.compare_exchange_weak(
+                    state, state | writers_parked,
+                    std::memory_order_relaxed)) {
+                continue;
+            }
+            parking_lot_park(rwlock, true, [rwlock]() {
+                uint32_t state = rwlock->state.load(
+                    std::memory_order_relaxed);
+                return (state & writers_parked) != 0 &&
+                    writer_blocked(state);
+            });
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: Waiting writers must be able to establish write access
+    //              after a writer has released write access, and readers
+    //              must be able to establish read access once no writers are
+    //              active.
+    // Enforcement: Clear the write locked bit, then, if either parked bit is
+    //              set, wake a parked writer if there is one and otherwise
+    //              every parked reader.
+    //--------------------------------------------------------------------------
+    void compact_rwlock_unlock_wr(compact_rwlock_t *rwlock) {
+        PRINT_CALLED("compact_rwlock_unlock_wr");
+        uint32_t state = write_locked;
+        if (rwlock->state.compare_exchange_strong(
+                state, 0, std::memory_order_release,
+                std::memory_order_relaxed)) {
+            RWLOCK_PROBE_RELEASED(rwlock, rwlock_probe_kind_write, 0, 0);
+            return;
+        }
+        ASSERT_POSITIVE((state & write_locked));
+        rwlock->state.fetch_and(~write_locked, std::memory_order_release);
+        RWLOCK_PROBE_RELEASED(rwlock, rwlock_probe_kind_write, 0, 0);
+        unpark(rwlock);
+    }
+}
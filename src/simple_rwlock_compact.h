@@ -0,0 +1,34 @@
+#ifndef SIMPLE_RWLOCK_COMPACT_H
+#define SIMPLE_RWLOCK_COMPACT_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace simple_rwlock {
+    // Writer-biased read-write lock in a single 32-bit word, for guarding
+    // very many small objects. Threads that cannot get access spin briefly
+    // and then park in the global parking lot (simple_rwlock_parking_lot.h)
+    // under the address of the lock, so the lock needs no memory of its own
+    // for waiters and nothing is allocated by compact_rwlock_init.
+    //
+    // The word holds the number of readers with read access in its low 24
+    // bits, then a bit that is set while a writer has write access, then a
+    // bit each for whether readers and writers may be parked. Readers may
+    // not establish read access while a writer has write access or is
+    // parked waiting for it.
+    typedef struct compact_rwlock_t {
+        std::atomic<uint32_t> state;
+    } compact_rwlock_t;
+
+    // Most readers that may have read access at once.
+    const uint32_t compact_rwlock_max_readers = (1u << 24) - 1;
+
+    void compact_rwlock_init(compact_rwlock_t *);
+    void compact_rwlock_uninit(compact_rwlock_t *);
+    void compact_rwlock_lock_rd(compact_rwlock_t *);
+    void compact_rwlock_unlock_rd(compact_rwlock_t *);
+    void compact_rwlock_lock_wr(compact_rwlock_t *);
+    void compact_rwlock_unlock_wr(compact_rwlock_t *);
+}
+
+#endif // SIMPLE_RWLOCK_COMPACT_H
@@ -0,0 +1,244 @@
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#include <simple_rwlock_debug_helpers.h>
+#include <simple_rwlock.h>
+#include <simple_rwlock_cond.h>
+
+namespace simple_rwlock {
+    struct rwlock_cond_waiter_t {
+        enum state_t {
+            // On the waiting queue.
+            waiting,
+            // Woken by a broadcast, on the requeued queue.
+            requeued,
+            // Off both queues and free to go after access.
+            woken
+        };
+
+        bool writer;
+        state_t state;
+        std::condition_variable wake;
+        rwlock_cond_waiter_t *next;
+    };
+
+    namespace {
+        typedef rwlock_cond_waiter_t waiter_t;
+        typedef std::chrono::steady_clock::time_point deadline_t;
+
+        void push(waiter_t *&head, waiter_t *&tail, waiter_t *waiter) {
+            waiter->next = nullptr;
+            if (tail == nullptr) {
+                head = waiter;
+            } else {
+                tail->next = waiter;
+            }
+            tail = waiter;
+        }
+
+        waiter_t *pop(waiter_t *&head, waiter_t *&tail) {
+            waiter_t *waiter = head;
+            if (waiter != nullptr) {
+                head = waiter->next;
+                if (head == nullptr) {
+                    tail = nullptr;
+                }
+                waiter->next = nullptr;
+            }
+            return waiter;
+        }
+
+        // Remove a waiter from anywhere in a queue.
+        void remove(waiter_t *&head, waiter_t *&tail, waiter_t *waiter) {
+            waiter_t *previous = nullptr;
+            for (waiter_t *w = head; w != nullptr; w = w->next) {
+                if (w == waiter) {
+                    if (previous == nullptr) {
+                        head = w->next;
+                    } else {
+                        previous->next = w->next;
+                    }
+                    if (tail == w) {
+                        tail = previous;
+                    }
+                    w->next = nullptr;
+                    return;
+                }
+                previous = w;
+            }
+        }
+
+        // Called with the mutex locked.
+        void wake(waiter_t *waiter) {
+            waiter->state = waiter_t::woken;
+            waiter->wake.notify_one();
+        }
+
+        //----------------------------------------------------------------------
+        // Requirement: A writer requeued by a broadcast must eventually be
+        //              woken, but no sooner than the writer ahead of it has
+        //              established write access.
+        // Enforcement: Every writer that returns from a wait wakes the first
+        //              requeued writer after it has established write access.
+        //              The woken writer then blocks in rwlock_lock_wr until
+        //              this writer releases write access.
+        //----------------------------------------------------------------------
+        void wake_next_requeued(rwlock_cond_t *cond) {
+            std::lock_guard<std::mutex> guard(*cond->mutex);
+            waiter_t *next = pop(cond->requeued_head, cond->requeued_tail);
+            if (next != nullptr) {
+                wake(next);
+            }
+        }
+
+        //----------------------------------------------------------------------
+        // Requirement: A signal sent after the waiter released its access
+        //              must not be missed.
+        // Enforcement: Queue the waiter before releasing access. A thread
+        //              changing the awaited state needs write access, which
+        //              it cannot get until this thread has released its
+        //              access, so its signal finds the waiter queued.
+        //----------------------------------------------------------------------
+        // Requirement: The waiter must have the same kind of access when it
+        //              returns as when it was called.
+        // Enforcement: Establish that kind of access again after being woken
+        //              or timing out, even if the wait failed.
+        //----------------------------------------------------------------------
+        bool wait(rwlock_cond_t *cond, rwlock_t *rwlock, bool writer,
+                  const deadline_t *deadline)
+        {
+            waiter_t waiter;
+            waiter.writer = writer;
+            waiter.state = waiter_t::waiting;
+            {
+                std::lock_guard<std::mutex> guard(*cond->mutex);
+                push(cond->waiting_head, cond->waiting_tail, &waiter);
+            }
+            if (writer) {
+                rwlock_unlock_wr(rwlock);
+            } else {
+                rwlock_unlock_rd(rwlock);
+            }
+
+            bool signalled = true;
+            {
+                std::unique_lock<std::mutex> guard(*cond->mutex);
+                while (waiter.state == waiter_t::waiting) {
+                    if (deadline == nullptr) {
+                        waiter.wake.wait(guard);
+                    } else if (waiter.wake.wait_until(guard, *deadline) ==
+                               std::cv_status::timeout &&
+                               waiter.state == waiter_t::waiting) {
+                        remove(cond->waiting_head, cond->waiting_tail,
+                               &waiter);
+                        signalled = false;
+                        break;
+                    }
+                }
+                // A requeued writer has been signalled already, and only
+                // waits for its turn, so the deadline no longer applies.
+                while (waiter.state == waiter_t::requeued) {
+                    waiter.wake.wait(guard);
+                }
+            }
+
+            if (writer) {
+                rwlock_lock_wr(rwlock);
+                wake_next_requeued(cond);
+            } else {
+                rwlock_lock_rd(rwlock);
+            }
+            return signalled;
+        }
+
+        deadline_t deadline_after(std::chrono::nanoseconds timeout) {
+            return std::chrono::steady_clock::now() +
+                std::chrono::duration_cast<
+                    std::chrono::steady_clock::duration>(timeout);
+        }
+    }
+
+    void rwlock_cond_init(rwlock_cond_t *cond) {
+        PRINT_CALLED("rwlock_cond_init");
+        cond->mutex = new std::mutex;
+        cond->waiting_head = nullptr;
+        cond->waiting_tail = nullptr;
+        cond->requeued_head = nullptr;
+        cond->requeued_tail = nullptr;
+    }
+
+    void rwlock_cond_uninit(rwlock_cond_t *cond) {
+        PRINT_CALLED("rwlock_cond_uninit");
+        ASSERT_ZERO(cond->waiting_head);
+        ASSERT_ZERO(cond->requeued_head);
+        delete cond->mutex;
+    }
+
+    void rwlock_cond_wait_rd(rwlock_cond_t *cond, rwlock_t *rwlock) {
+        PRINT_CALLED("rwlock_cond_wait_rd");
+        wait(cond, rwlock, false, nullptr);
+    }
+
+    void rwlock_cond_wait_wr(rwlock_cond_t *cond, rwlock_t *rwlock) {
+        PRINT_CALLED("rwlock_cond_wait_wr");
+        wait(cond, rwlock, true, nullptr);
+    }
+
+    bool rwlock_cond_timedwait_rd(rwlock_cond_t *cond, rwlock_t *rwlock,
+                                  std::chrono::nanoseconds timeout)
+    {
+        PRINT_CALLED("rwlock_cond_timedwait_rd");
+        deadline_t deadline = deadline_after(timeout);
+        return wait(cond, rwlock, false, &deadline);
+    }
+
+    bool rwlock_cond_timedwait_wr(rwlock_cond_t *cond, rwlock_t *rwlock,
+                                  std::chrono::nanoseconds timeout)
+    {
+        PRINT_CALLED("rwlock_cond_timedwait_wr");
+        deadline_t deadline = deadline_after(timeout);
+        return wait(cond, rwlock, true, &deadline);
+    }
+
+    void rwlock_cond_signal(rwlock_cond_t *cond) {
+        PRINT_CALLED("rwlock_cond_signal");
+        std::lock_guard<std::mutex> guard(*cond->mutex);
+        waiter_t *waiter = pop(cond->waiting_head, cond->waiting_tail);
+        if (waiter != nullptr) {
+            wake(waiter);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: Every waiting thread must be woken.
+    // Enforcement: Empty the waiting queue. Readers and the first writer are
+    //              woken; later writers are moved to the requeued queue,
+    //              from which each writer that establishes write access
+    //              wakes the next.
+    //--------------------------------------------------------------------------
+    // Requirement: Waiting writers should not all wake at once only to
+    //              block again on the rwlock.
+    // Enforcement: If a requeued writer is already waiting its turn, the
+    //              writers taken from the waiting queue are all requeued
+    //              behind it.
+    //--------------------------------------------------------------------------
+    void rwlock_cond_broadcast(rwlock_cond_t *cond) {
+        PRINT_CALLED("rwlock_cond_broadcast");
+        std::lock_guard<std::mutex> guard(*cond->mutex);
+        bool writer_woken = (cond->requeued_head != nullptr);
+        waiter_t *waiter;
+        while ((waiter = pop(cond->waiting_head, cond->waiting_tail)) !=
+               nullptr) {
+            if (!waiter->writer) {
+                wake(waiter);
+            } else if (!writer_woken) {
+                wake(waiter);
+                writer_woken = true;
+            } else {
+                waiter->state = waiter_t::requeued;
+                push(cond->requeued_head, cond->requeued_tail, waiter);
+            }
+        }
+    }
+}
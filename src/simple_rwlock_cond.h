@@ -0,0 +1,60 @@
+#ifndef SIMPLE_RWLOCK_COND_H
+#define SIMPLE_RWLOCK_COND_H
+
+#include <chrono>
+#include <mutex>
+
+#include <simple_rwlock.h>
+
+namespace simple_rwlock {
+    // A thread waiting on an rwlock_cond_t. Waiters live on the stack of
+    // the waiting thread, which does not return until it has been removed
+    // from the condition variable's queues.
+    typedef struct rwlock_cond_waiter_t rwlock_cond_waiter_t;
+
+    // Condition variable used together with an rwlock_t. A thread holding
+    // read or write access calls rwlock_cond_wait_rd or rwlock_cond_wait_wr,
+    // which releases that access, blocks until the condition variable is
+    // signalled, and establishes the same kind of access again before
+    // returning. As with pthread_cond_wait, a thread that sets the awaited
+    // state must do so with write access and signal after changing it,
+    // and waiters should check their predicate in a loop.
+    //
+    // rwlock_cond_broadcast wakes every waiting reader, since they can all
+    // have read access at once, but only the first waiting writer. The
+    // other writers are requeued and woken one at a time, each once the
+    // writer before it has established write access, so that they queue up
+    // on the rwlock instead of all waking to contend for it.
+    typedef struct rwlock_cond_t {
+        // Protects both queues and every waiter on them.
+        std::mutex *mutex;
+        // Threads waiting for a signal, in the order they started waiting.
+        rwlock_cond_waiter_t *waiting_head;
+        rwlock_cond_waiter_t *waiting_tail;
+        // Writers woken by a broadcast that are waiting for their turn to
+        // go after write access.
+        rwlock_cond_waiter_t *requeued_head;
+        rwlock_cond_waiter_t *requeued_tail;
+    } rwlock_cond_t;
+
+    void rwlock_cond_init(rwlock_cond_t *);
+    void rwlock_cond_uninit(rwlock_cond_t *);
+
+    // The caller must have read access, or write access, to the rwlock.
+    void rwlock_cond_wait_rd(rwlock_cond_t *, rwlock_t *);
+    void rwlock_cond_wait_wr(rwlock_cond_t *, rwlock_t *);
+
+    // As above, but give up waiting for a signal after timeout. Access is
+    // established again either way. Return false if the wait timed out.
+    bool rwlock_cond_timedwait_rd(rwlock_cond_t *, rwlock_t *,
+                                  std::chrono::nanoseconds timeout);
+    bool rwlock_cond_timedwait_wr(rwlock_cond_t *, rwlock_t *,
+                                  std::chrono::nanoseconds timeout);
+
+    // Wake the thread that has been waiting longest, if any.
+    void rwlock_cond_signal(rwlock_cond_t *);
+    // Wake every waiting thread, requeueing all but one writer.
+    void rwlock_cond_broadcast(rwlock_cond_t *);
+}
+
+#endif // SIMPLE_RWLOCK_COND_H
@@ -0,0 +1,273 @@
+#include <atomic>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define SIMPLE_RWLOCK_HAVE_RTM_INTRINSICS
+#endif
+
+#include <simple_rwlock_debug_helpers.h>
+#include <simple_rwlock.h>
+#include <simple_rwlock_elided.h>
+
+namespace simple_rwlock {
+    namespace {
+#ifdef SIMPLE_RWLOCK_HAVE_RTM_INTRINSICS
+        // Committed transactions are counted in a thread-local batch so that
+        // elided readers do not all write to the same statistics counter.
+        // The batch only ever refers to the lock most recently read by this
+        // thread; switching locks drops the pending count rather than
+        // writing to a lock that may no longer exist.
+        const unsigned long commit_batch_size = 64;
+        struct commit_batch_t {
+            const elided_rwlock_t *rwlock;
+            unsigned long num_commits;
+        };
+        thread_local commit_batch_t commit_batch = { nullptr, 0 };
+
+        void count_commit(elided_rwlock_t *rwlock) {
+            if (commit_batch.rwlock != rwlock) {
+                commit_batch.rwlock = rwlock;
+                commit_batch.num_commits = 0;
+            }
+            commit_batch.num_commits++;
+            if (commit_batch.num_commits == commit_batch_size) {
+                rwlock->num_commits.fetch_add(commit_batch_size,
+                                              std::memory_order_relaxed);
+                commit_batch.num_commits = 0;
+            }
+            // Only write to the streak when it has to change so that it
+            // stays shared in every reader's cache in the common case.
+            if (rwlock->abort_streak.load(std::memory_order_relaxed) != 0) {
+                rwlock->abort_streak.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        // Abort code used when the transaction finds an active writer.
+        const unsigned int writer_active_abort_code = 0xff;
+
+        bool detect_rtm() {
+            unsigned int eax = 0;
+            unsigned int ebx = 0;
+            unsigned int ecx = 0;
+            unsigned int edx = 0;
+            if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+                return false;
+            }
+            return (ebx & bit_RTM) != 0;
+        }
+
+        // Start a transaction and subscribe to the number of active writers.
+        // Returns _XBEGIN_STARTED if the caller is now running inside the
+        // transaction, or the abort status otherwise.
+        __attribute__((target("rtm")))
+        unsigned int begin_elided_read(elided_rwlock_t *rwlock) {
+            unsigned int status = _xbegin();
+            if (status == _XBEGIN_STARTED &&
+                rwlock->num_active_writers.load(
+                    std::memory_order_relaxed) != 0)
+            {
+                _xabort(writer_active_abort_code);
+            }
+            return status;
+        }
+
+        // The locks this thread holds elided, in the order it read them.
+        // Nested transactions are flattened into the outermost one, so
+        // every entry was pushed inside the same transaction and an abort
+        // empties the list again. Whether an unlock commits or calls
+        // rwlock_unlock_rd depends only on whether its lock is listed,
+        // so locks may be released in any order, and read access taken
+        // through the fallback is never mistaken for an elided read.
+        const unsigned int max_elided_reads = 8;
+        struct elided_reads_t {
+            const elided_rwlock_t *rwlocks[max_elided_reads];
+            unsigned int num_rwlocks;
+        };
+        thread_local elided_reads_t elided_reads = { { }, 0 };
+
+        // Remove one entry of the lock from the list and return whether
+        // there was one.
+        bool forget_elided_read(const elided_rwlock_t *rwlock) {
+            for (unsigned int i = elided_reads.num_rwlocks; i > 0; i--) {
+                if (elided_reads.rwlocks[i - 1] == rwlock) {
+                    elided_reads.num_rwlocks--;
+                    for (unsigned int j = i - 1;
+                         j < elided_reads.num_rwlocks; j++)
+                    {
+                        elided_reads.rwlocks[j] = elided_reads.rwlocks[j + 1];
+                    }
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Leave one level of the transaction, committing it if this was
+        // the last lock held elided.
+        __attribute__((target("rtm")))
+        void end_elided_read() {
+            _xend();
+        }
+
+        // Record why a transaction aborted. Returns whether it is
+        // worth retrying the transaction before falling back.
+        bool count_abort(elided_rwlock_t *rwlock, unsigned int status) {
+            bool retry = (status & _XABORT_RETRY) != 0;
+            if ((status & _XABORT_EXPLICIT) != 0 &&
+                _XABORT_CODE(status) == writer_active_abort_code)
+            {
+                // The writer will keep the lock for a while; wait for it
+                // in rwlock_lock_rd rather than spinning on transactions.
+                rwlock->num_aborts_writer++;
+                retry = false;
+            } else if ((status & _XABORT_CONFLICT) != 0) {
+                rwlock->num_aborts_conflict++;
+            } else if ((status & _XABORT_CAPACITY) != 0) {
+                rwlock->num_aborts_capacity++;
+            } else {
+                rwlock->num_aborts_other++;
+            }
+            if (++rwlock->abort_streak >= elided_rwlock_abort_streak_limit) {
+                rwlock->elision_enabled = false;
+            }
+            return retry;
+        }
+#else
+        bool detect_rtm() {
+            return false;
+        }
+#endif // SIMPLE_RWLOCK_HAVE_RTM_INTRINSICS
+
+        const bool rtm_supported = detect_rtm();
+    }
+
+    bool elided_rwlock_elision_supported() {
+        return rtm_supported;
+    }
+
+    void elided_rwlock_init(elided_rwlock_t *rwlock) {
+        PRINT_CALLED("elided_rwlock_init");
+        rwlock_init(&rwlock->rwlock);
+        rwlock->num_active_writers = 0;
+        rwlock->elision_enabled = rtm_supported;
+        rwlock->abort_streak = 0;
+        rwlock->num_commits = 0;
+        rwlock->num_aborts_writer = 0;
+        rwlock->num_aborts_conflict = 0;
+        rwlock->num_aborts_capacity = 0;
+        rwlock->num_aborts_other = 0;
+        rwlock->num_fallback_reads = 0;
+    }
+
+    void elided_rwlock_uninit(elided_rwlock_t *rwlock) {
+        PRINT_CALLED("elided_rwlock_uninit");
+        rwlock_uninit(&rwlock->rwlock);
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: A read section must not write to the lock when it can run
+    //              as a transaction.
+    // Enforcement: If elision is enabled, start a transaction and return
+    //              inside it. The transaction only reads the number of
+    //              active writers.
+    //--------------------------------------------------------------------------
+    // Requirement: No writer may have write access while an elided reader
+    //              is running.
+    // Enforcement: Abort the transaction if any writer is active. A writer
+    //              that becomes active later increments the counter, which
+    //              is in the transaction's read set, so the hardware aborts
+    //              the transaction.
+    //--------------------------------------------------------------------------
+    // Requirement: The reader must establish read access even if the
+    //              transaction cannot commit.
+    // Enforcement: After elided_rwlock_max_attempts aborts, or after an
+    //              abort the hardware reports as not worth retrying, fall
+    //              back to rwlock_lock_rd.
+    //--------------------------------------------------------------------------
+    void elided_rwlock_lock_rd(elided_rwlock_t *rwlock) {
+        PRINT_CALLED("elided_rwlock_lock_rd");
+#ifdef SIMPLE_RWLOCK_HAVE_RTM_INTRINSICS
+        if (rtm_supported &&
+            rwlock->elision_enabled.load(std::memory_order_relaxed) &&
+            elided_reads.num_rwlocks < max_elided_reads)
+        {
+            for (unsigned int i = 0; i < elided_rwlock_max_attempts; i++) {
+                unsigned int status = begin_elided_read(rwlock);
+                if (status == _XBEGIN_STARTED) {
+                    elided_reads.rwlocks[elided_reads.num_rwlocks++] = rwlock;
+                    return;
+                }
+                if (!count_abort(rwlock, status)) {
+                    break;
+                }
+            }
+        }
+#endif
+        rwlock->num_fallback_reads++;
+        rwlock_lock_rd(&rwlock->rwlock);
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: Release read access in the same way it was established,
+    //              even if this thread holds other locks and releases them
+    //              in a different order than it read them.
+    // Enforcement: Leave the transaction if this thread holds this lock
+    //              elided, otherwise call rwlock_unlock_rd. Whether this
+    //              thread is running inside a transaction says nothing
+    //              about how it read this particular lock.
+    //--------------------------------------------------------------------------
+    void elided_rwlock_unlock_rd(elided_rwlock_t *rwlock) {
+#ifdef SIMPLE_RWLOCK_HAVE_RTM_INTRINSICS
+        if (forget_elided_read(rwlock)) {
+            end_elided_read();
+            count_commit(rwlock);
+            return;
+        }
+#endif
+        // Only report the call outside of a transaction,
+        // since writing to stdout would abort it.
+        PRINT_CALLED("elided_rwlock_unlock_rd");
+        rwlock_unlock_rd(&rwlock->rwlock);
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: Elided readers must not run while a writer is active,
+    //              including while it waits for non-elided readers.
+    // Enforcement: Increment the number of active writers before waiting
+    //              in rwlock_lock_wr, and decrement it only after write
+    //              access has been released.
+    //--------------------------------------------------------------------------
+    void elided_rwlock_lock_wr(elided_rwlock_t *rwlock) {
+        PRINT_CALLED("elided_rwlock_lock_wr");
+        rwlock->num_active_writers++;
+        rwlock_lock_wr(&rwlock->rwlock);
+    }
+
+    void elided_rwlock_unlock_wr(elided_rwlock_t *rwlock) {
+        PRINT_CALLED("elided_rwlock_unlock_wr");
+        rwlock_unlock_wr(&rwlock->rwlock);
+        ASSERT_POSITIVE(rwlock->num_active_writers.load());
+        rwlock->num_active_writers--;
+    }
+
+    void elided_rwlock_set_elision(elided_rwlock_t *rwlock, bool enabled) {
+        rwlock->abort_streak = 0;
+        rwlock->elision_enabled = enabled && rtm_supported;
+    }
+
+    void elided_rwlock_get_stats(elided_rwlock_t *rwlock,
+                                 elided_rwlock_stats_t *stats)
+    {
+        stats->num_commits = rwlock->num_commits.load();
+        stats->num_aborts_writer = rwlock->num_aborts_writer.load();
+        stats->num_aborts_conflict = rwlock->num_aborts_conflict.load();
+        stats->num_aborts_capacity = rwlock->num_aborts_capacity.load();
+        stats->num_aborts_other = rwlock->num_aborts_other.load();
+        stats->num_fallback_reads = rwlock->num_fallback_reads.load();
+        stats->num_attempts = stats->num_commits +
+            stats->num_aborts_writer + stats->num_aborts_conflict +
+            stats->num_aborts_capacity + stats->num_aborts_other;
+        stats->elision_enabled = rwlock->elision_enabled.load();
+    }
+}
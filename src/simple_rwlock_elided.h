@@ -0,0 +1,77 @@
+#ifndef SIMPLE_RWLOCK_ELIDED_H
+#define SIMPLE_RWLOCK_ELIDED_H
+
+#include <atomic>
+
+#include <simple_rwlock.h>
+
+namespace simple_rwlock {
+    // Number of times an elided read is attempted before falling back to
+    // rwlock_lock_rd, as long as the hardware reports that a retry may
+    // succeed.
+    const unsigned int elided_rwlock_max_attempts = 3;
+
+    // Elision is turned off for a lock once this many transactions in a
+    // row have aborted without any transaction committing in between.
+    const unsigned long elided_rwlock_abort_streak_limit = 64;
+
+    typedef struct elided_rwlock_stats_t {
+        // Transactions started, including retries.
+        unsigned long num_attempts;
+        // Transactions committed. Committed transactions are counted per
+        // thread and only added here in batches, so this may lag behind.
+        unsigned long num_commits;
+        // Transactions aborted because a writer was active.
+        unsigned long num_aborts_writer;
+        // Transactions aborted by a memory conflict with another thread.
+        unsigned long num_aborts_conflict;
+        // Transactions aborted because the read set did not fit in cache.
+        unsigned long num_aborts_capacity;
+        // Transactions aborted for any other reason, such as a system call
+        // or an interrupt inside the read section.
+        unsigned long num_aborts_other;
+        // Reads that used rwlock_lock_rd instead of a transaction.
+        unsigned long num_fallback_reads;
+        bool elision_enabled;
+    } elided_rwlock_stats_t;
+
+    typedef struct elided_rwlock_t {
+        // Read sections that are not elided, and all write
+        // sections, are protected by the underlying rwlock.
+        rwlock_t rwlock;
+        // A writer is active when it is either writing or waiting to
+        // write. Elided readers read this counter inside their transaction,
+        // so incrementing it aborts every elided reader in progress. It is
+        // kept in its own cache line so that elided readers only ever share
+        // the line, and never write to it.
+        alignas(64) std::atomic<rwlock_count_t> num_active_writers;
+        // Whether read sections are attempted as transactions at all.
+        std::atomic<bool> elision_enabled;
+        // Statistics, kept away from the line read by elided readers.
+        alignas(64) std::atomic<unsigned long> abort_streak;
+        std::atomic<unsigned long> num_commits;
+        std::atomic<unsigned long> num_aborts_writer;
+        std::atomic<unsigned long> num_aborts_conflict;
+        std::atomic<unsigned long> num_aborts_capacity;
+        std::atomic<unsigned long> num_aborts_other;
+        std::atomic<unsigned long> num_fallback_reads;
+    } elided_rwlock_t;
+
+    void elided_rwlock_init(elided_rwlock_t *);
+    void elided_rwlock_uninit(elided_rwlock_t *);
+    void elided_rwlock_lock_rd(elided_rwlock_t *);
+    void elided_rwlock_unlock_rd(elided_rwlock_t *);
+    void elided_rwlock_lock_wr(elided_rwlock_t *);
+    void elided_rwlock_unlock_wr(elided_rwlock_t *);
+
+    // Turn elision on or off for one lock. Turning it on has no effect
+    // on machines without hardware transactional memory.
+    void elided_rwlock_set_elision(elided_rwlock_t *, bool enabled);
+    void elided_rwlock_get_stats(elided_rwlock_t *, elided_rwlock_stats_t *);
+
+    // Whether the CPU supports restricted transactional memory.
+    // Detected once at runtime with cpuid.
+    bool elided_rwlock_elision_supported();
+}
+
+#endif // SIMPLE_RWLOCK_ELIDED_H
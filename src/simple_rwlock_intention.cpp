@@ -0,0 +1,221 @@
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include <simple_rwlock_debug_helpers.h>
+#include <simple_rwlock_intention.h>
+#include <simple_rwlock_probes.h>
+
+namespace simple_rwlock {
+    struct intention_rwlock_waiter_t {
+        intention_mode_t mode;
+        bool granted;
+        std::condition_variable wake;
+        intention_rwlock_waiter_t *next;
+    };
+
+    namespace {
+        typedef intention_rwlock_waiter_t waiter_t;
+
+        const bool compatible[intention_num_modes][intention_num_modes] = {
+            //          IS     IX     S      SIX    X
+            /* IS  */ { true,  true,  true,  true,  false },
+            /* IX  */ { true,  true,  false, false, false },
+            /* S   */ { true,  false, true,  false, false },
+            /* SIX */ { true,  false, false, false, false },
+            /* X   */ { false, false, false, false, false },
+        };
+
+        bool compatible_with_granted(const intention_rwlock_t *rwlock,
+                                     intention_mode_t mode)
+        {
+            for (int other = 0; other < intention_num_modes; other++) {
+                if (rwlock->num_granted[other] != 0 &&
+                    !compatible[mode][other]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Whether a request for mode may be granted ahead of every
+        // waiter from the head of the queue up to, but not including,
+        // stop.
+        bool compatible_with_waiting(const intention_rwlock_t *rwlock,
+                                     intention_mode_t mode,
+                                     const waiter_t *stop)
+        {
+            for (const waiter_t *waiter = rwlock->waiting_head;
+                 waiter != stop; waiter = waiter->next) {
+                if (!compatible[mode][waiter->mode]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Probes report IS and S holders as readers and IX, SIX and X
+        // holders, which may write below or at the node, as writers.
+        [[maybe_unused]] uint8_t probe_kind(intention_mode_t mode) {
+            return (intention_parent_mode(mode) == intention_mode_is)
+                ? rwlock_probe_kind_read : rwlock_probe_kind_write;
+        }
+
+        [[maybe_unused]] unsigned long probe_num_readers(
+            const intention_rwlock_t *rwlock)
+        {
+            return rwlock->num_granted[intention_mode_is] +
+                rwlock->num_granted[intention_mode_s];
+        }
+
+        [[maybe_unused]] unsigned long probe_num_writers(
+            const intention_rwlock_t *rwlock)
+        {
+            return rwlock->num_granted[intention_mode_ix] +
+                rwlock->num_granted[intention_mode_six] +
+                rwlock->num_granted[intention_mode_x];
+        }
+
+        // Grant every waiter that no longer conflicts with a granted mode
+        // or with a waiter ahead of it, and take it off the queue.
+        void grant_waiters(intention_rwlock_t *rwlock) {
+            waiter_t *previous = nullptr;
+            waiter_t *waiter = rwlock->waiting_head;
+            while (waiter != nullptr) {
+                waiter_t *next = waiter->next;
+                if (compatible_with_granted(rwlock, waiter->mode) &&
+                    compatible_with_waiting(rwlock, waiter->mode, waiter)) {
+                    if (previous == nullptr) {
+                        rwlock->waiting_head = next;
+                    } else {
+                        previous->next = next;
+                    }
+                    if (rwlock->waiting_tail == waiter) {
+                        rwlock->waiting_tail = previous;
+                    }
+                    rwlock->num_granted[waiter->mode]++;
+                    waiter->granted = true;
+                    waiter->wake.notify_one();
+                } else {
+                    previous = waiter;
+                }
+                waiter = next;
+            }
+        }
+    }
+
+    bool intention_modes_compatible(intention_mode_t a, intention_mode_t b) {
+        return compatible[a][b];
+    }
+
+    intention_mode_t intention_parent_mode(intention_mode_t mode) {
+        return (mode == intention_mode_is || mode == intention_mode_s)
+            ? intention_mode_is : intention_mode_ix;
+    }
+
+    void intention_rwlock_init(intention_rwlock_t *rwlock) {
+        PRINT_CALLED("intention_rwlock_init");
+        rwlock->mutex = new std::mutex;
+        for (int mode = 0; mode < intention_num_modes; mode++) {
+            rwlock->num_granted[mode] = 0;
+        }
+        rwlock->waiting_head = nullptr;
+        rwlock->waiting_tail = nullptr;
+    }
+
+    void intention_rwlock_uninit(intention_rwlock_t *rwlock) {
+        PRINT_CALLED("intention_rwlock_uninit");
+        ASSERT_ZERO((rwlock->waiting_head != nullptr));
+        delete rwlock->mutex;
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: The mode may not be granted while an incompatible mode
+    //              is granted.
+    // Requirement: Requests that conflict are granted in the order they were
+    //              made, so that compatible requests cannot keep a waiting
+    //              request out forever.
+    // Enforcement: Grant the mode at once only if it is compatible with
+    //              every granted mode and with every waiting request, and
+    //              otherwise queue behind the waiting requests until
+    //              grant_waiters finds both true.
+    //--------------------------------------------------------------------------
+    void intention_rwlock_lock(intention_rwlock_t *rwlock,
+                               intention_mode_t mode)
+    {
+        PRINT_CALLED("intention_rwlock_lock");
+        RWLOCK_PROBE_ACQUIRE_START(rwlock, probe_kind(mode));
+        std::unique_lock<std::mutex> guard(*rwlock->mutex);
+        if (compatible_with_granted(rwlock, mode) &&
+            compatible_with_waiting(rwlock, mode, nullptr)) {
+            rwlock->num_granted[mode]++;
+            RWLOCK_PROBE_ACQUIRED(rwlock, probe_kind(mode), false,
+                                  probe_num_readers(rwlock),
+                                  probe_num_writers(rwlock));
+            return;
+        }
+        RWLOCK_PROBE_ACQUIRE_CONTENDED(rwlock, probe_kind(mode));
+        waiter_t waiter;
+        waiter.mode = mode;
+        waiter.granted = false;
+        waiter.next = nullptr;
+        if (rwlock->waiting_tail == nullptr) {
+            rwlock->waiting_head = &waiter;
+        } else {
+            rwlock->waiting_tail->next = &waiter;
+        }
+        rwlock->waiting_tail = &waiter;
+        while (!waiter.granted) {
+            waiter.wake.wait(guard);
+        }
+        RWLOCK_PROBE_ACQUIRED(rwlock, probe_kind(mode), true,
+                              probe_num_readers(rwlock),
+                              probe_num_writers(rwlock));
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: Waiting requests must be granted once nothing they
+    //              conflict with is granted or ahead of them.
+    // Enforcement: Release the mode and check every waiting request again.
+    //--------------------------------------------------------------------------
+    void intention_rwlock_unlock(intention_rwlock_t *rwlock,
+                                 intention_mode_t mode)
+    {
+        PRINT_CALLED("intention_rwlock_unlock");
+        std::lock_guard<std::mutex> guard(*rwlock->mutex);
+        ASSERT_POSITIVE(rwlock->num_granted[mode]);
+        rwlock->num_granted[mode]--;
+        RWLOCK_PROBE_RELEASED(rwlock, probe_kind(mode),
+                              probe_num_readers(rwlock),
+                              probe_num_writers(rwlock));
+        if (rwlock->num_granted[mode] == 0 &&
+            rwlock->waiting_head != nullptr) {
+            grant_waiters(rwlock);
+        }
+    }
+
+    void intention_rwlock_lock_path(intention_rwlock_t *const *path,
+                                    size_t depth, intention_mode_t mode)
+    {
+        PRINT_CALLED("intention_rwlock_lock_path");
+        ASSERT_POSITIVE(depth);
+        intention_mode_t parent_mode = intention_parent_mode(mode);
+        for (size_t i = 0; i + 1 < depth; i++) {
+            intention_rwlock_lock(path[i], parent_mode);
+        }
+        intention_rwlock_lock(path[depth - 1], mode);
+    }
+
+    void intention_rwlock_unlock_path(intention_rwlock_t *const *path,
+                                      size_t depth, intention_mode_t mode)
+    {
+        PRINT_CALLED("intention_rwlock_unlock_path");
+        ASSERT_POSITIVE(depth);
+        intention_mode_t parent_mode = intention_parent_mode(mode);
+        intention_rwlock_unlock(path[depth - 1], mode);
+        for (size_t i = depth - 1; i > 0; i--) {
+            intention_rwlock_unlock(path[i - 1], parent_mode);
+        }
+    }
+}
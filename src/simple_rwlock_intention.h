@@ -0,0 +1,74 @@
+#ifndef SIMPLE_RWLOCK_INTENTION_H
+#define SIMPLE_RWLOCK_INTENTION_H
+
+#include <cstddef>
+#include <mutex>
+
+namespace simple_rwlock {
+    // Modes of a multi-granularity lock, for data organized as a tree,
+    // such as tables of pages of rows, with one intention_rwlock_t per
+    // node. A thread locks the node it works on in S (read) or X (write)
+    // mode, and every ancestor of that node in the matching intention
+    // mode first, from the root down: IS above an S lock and IX above an X
+    // lock. SIX reads a whole subtree while writing some of it, and is
+    // taken above IX locks on the nodes being written.
+    //
+    // Which modes may be held on one node at once:
+    //
+    //            IS   IX   S    SIX  X
+    //      IS    yes  yes  yes  yes  no
+    //      IX    yes  yes  no   no   no
+    //      S     yes  no   yes  no   no
+    //      SIX   yes  no   no   no   no
+    //      X     no   no   no   no   no
+    //
+    // So lockers of unrelated subtrees only share intention locks and do
+    // not block each other, while an S or X lock on a node keeps out
+    // writers or everything below it.
+    typedef enum intention_mode_t {
+        intention_mode_is = 0,
+        intention_mode_ix,
+        intention_mode_s,
+        intention_mode_six,
+        intention_mode_x,
+        intention_num_modes
+    } intention_mode_t;
+
+    typedef struct intention_rwlock_waiter_t intention_rwlock_waiter_t;
+
+    // One node's lock. Requests are granted in order where they conflict:
+    // a request waits while it conflicts with a granted mode or with an
+    // earlier request that is still waiting, so that, as with rwlock_t,
+    // a stream of compatible lockers cannot keep a waiting writer out.
+    typedef struct intention_rwlock_t {
+        // Protects everything below.
+        std::mutex *mutex;
+        // Number of holders of each mode.
+        unsigned long num_granted[intention_num_modes];
+        // Requests that are waiting, in the order they were made.
+        intention_rwlock_waiter_t *waiting_head;
+        intention_rwlock_waiter_t *waiting_tail;
+    } intention_rwlock_t;
+
+    bool intention_modes_compatible(intention_mode_t, intention_mode_t);
+
+    // Mode to lock the ancestors of a node in before locking the node in
+    // mode: IS for IS and S, and IX for IX, SIX and X.
+    intention_mode_t intention_parent_mode(intention_mode_t mode);
+
+    void intention_rwlock_init(intention_rwlock_t *);
+    void intention_rwlock_uninit(intention_rwlock_t *);
+    void intention_rwlock_lock(intention_rwlock_t *, intention_mode_t);
+    void intention_rwlock_unlock(intention_rwlock_t *, intention_mode_t);
+
+    // Lock a node and its ancestors. path holds the locks from the root
+    // down to the node, which is last; every lock but the last is taken in
+    // intention_parent_mode(mode) and the last in mode. Unlock with the
+    // same path and mode, which releases the locks from the node up.
+    void intention_rwlock_lock_path(intention_rwlock_t *const *path,
+                                    size_t depth, intention_mode_t mode);
+    void intention_rwlock_unlock_path(intention_rwlock_t *const *path,
+                                      size_t depth, intention_mode_t mode);
+}
+
+#endif // SIMPLE_RWLOCK_INTENTION_H
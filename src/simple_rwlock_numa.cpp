@@ -0,0 +1,257 @@
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <sched.h>
+#include <string>
+#include <thread>
+
+#include <simple_rwlock_debug_helpers.h>
+#include <simple_rwlock_numa.h>
+#include <simple_rwlock_probes.h>
+
+namespace simple_rwlock {
+    namespace {
+        // Parse a sysfs list such as "0", "0-1" or "0,2-3"
+        // and return one more than the highest entry.
+        unsigned int parse_sysfs_list_bound(const std::string &list) {
+            unsigned int bound = 0;
+            unsigned int value = 0;
+            bool have_value = false;
+            for (char c : list) {
+                if (c >= '0' && c <= '9') {
+                    value = value * 10 + (c - '0');
+                    have_value = true;
+                } else {
+                    if (have_value && value + 1 > bound) {
+                        bound = value + 1;
+                    }
+                    value = 0;
+                    have_value = false;
+                }
+            }
+            if (have_value && value + 1 > bound) {
+                bound = value + 1;
+            }
+            return bound;
+        }
+
+        unsigned int read_num_nodes() {
+            std::ifstream online("/sys/devices/system/node/online");
+            std::string list;
+            if (!online || !std::getline(online, list)) {
+                return 1;
+            }
+            unsigned int bound = parse_sysfs_list_bound(list);
+            return (bound == 0) ? 1 : bound;
+        }
+
+        // The sum of the per-node reader counters. Once a writer is active
+        // no reader can increment a counter and keep its read access, so
+        // every counter only decreases and a sum of zero read one counter
+        // at a time means that there are no readers left.
+        long sum_active_readers(numa_rwlock_t *rwlock) {
+            long sum = 0;
+            for (unsigned int i = 0; i < rwlock->num_nodes; i++) {
+                sum += rwlock->nodes[i].num_active_readers.load();
+            }
+            return sum;
+        }
+    }
+
+    unsigned int numa_num_nodes() {
+        static const unsigned int num_nodes = read_num_nodes();
+        return num_nodes;
+    }
+
+    unsigned int numa_current_node() {
+        unsigned int cpu = 0;
+        unsigned int node = 0;
+        if (getcpu(&cpu, &node) != 0) {
+            return 0;
+        }
+        return node;
+    }
+
+    void numa_rwlock_init(numa_rwlock_t *rwlock) {
+        PRINT_CALLED("numa_rwlock_init");
+        rwlock->num_active_writers = 0;
+        rwlock->global_write_locked = false;
+        rwlock->writer_node = 0;
+        rwlock->num_nodes = numa_num_nodes();
+        rwlock->handoff_bound = numa_rwlock_default_handoff_bound;
+        rwlock->nodes = new numa_rwlock_node_t[rwlock->num_nodes];
+        for (unsigned int i = 0; i < rwlock->num_nodes; i++) {
+            rwlock->nodes[i].num_active_readers = 0;
+            rwlock->nodes[i].num_waiting_writers = 0;
+            rwlock->nodes[i].owns_global_lock = false;
+            rwlock->nodes[i].num_local_handoffs = 0;
+        }
+    }
+
+    void numa_rwlock_uninit(numa_rwlock_t *rwlock) {
+        PRINT_CALLED("numa_rwlock_uninit");
+        delete[] rwlock->nodes;
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: The rwlock object is writer-biased, so any active writers
+    //              must become inactive before the reader can establish read
+    //              access.
+    // Enforcement: Wait for the number of active writers to become zero.
+    //--------------------------------------------------------------------------
+    // Requirement: No writer may have write access while this reader has
+    //              read access.
+    // Enforcement: Increment this node's reader counter and then check the
+    //              number of active writers again. A writer increments the
+    //              number of active writers before it checks the reader
+    //              counters, so either the writer sees this reader or this
+    //              reader sees the writer and backs off.
+    //--------------------------------------------------------------------------
+    // Requirement: Readers on different nodes must not write to the same
+    //              cache line.
+    // Enforcement: Only the counter of the node this reader is running on
+    //              is modified.
+    //--------------------------------------------------------------------------
+    void numa_rwlock_lock_rd(numa_rwlock_t *rwlock) {
+        PRINT_CALLED("numa_rwlock_lock_rd");
+        RWLOCK_PROBE_ACQUIRE_START(rwlock, rwlock_probe_kind_read);
+        [[maybe_unused]] bool contended = false;
+        numa_rwlock_node_t *node =
+            &rwlock->nodes[numa_current_node() % rwlock->num_nodes];
+        while (true) {
+            if (rwlock->num_active_writers.load() != 0) {
+                RWLOCK_PROBE_ACQUIRE_CONTENDED(rwlock, rwlock_probe_kind_read);
+                contended = true;
+                do {
+                    std::this_thread::yield();
+                } while (rwlock->num_active_writers.load() != 0);
+            }
+            node->num_active_readers++;
+            if (rwlock->num_active_writers.load() == 0) {
+                break;
+            }
+            node->num_active_readers--;
+        }
+        RWLOCK_PROBE_ACQUIRED(rwlock, rwlock_probe_kind_read, contended,
+                              rwlock_probe_count_unknown,
+                              rwlock->num_active_writers.load());
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: Waiting writers must be able to establish write access
+    //              after the last active reader has released its read access.
+    // Enforcement: Decrement the counter of the node this reader is running
+    //              on. Writers wait on the sum over all nodes.
+    //--------------------------------------------------------------------------
+    void numa_rwlock_unlock_rd(numa_rwlock_t *rwlock) {
+        PRINT_CALLED("numa_rwlock_unlock_rd");
+        numa_rwlock_node_t *node =
+            &rwlock->nodes[numa_current_node() % rwlock->num_nodes];
+        node->num_active_readers--;
+        RWLOCK_PROBE_RELEASED(rwlock, rwlock_probe_kind_read,
+                              rwlock_probe_count_unknown,
+                              rwlock->num_active_writers.load());
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: The rwlock object is writer-biased, so readers must not be
+    //              able to become active between the time this writer has
+    //              started waiting and the time it has released write access.
+    // Enforcement: Increment the number of active writers before waiting.
+    //--------------------------------------------------------------------------
+    // Requirement: Writers on the same node must contend with each other
+    //              without touching memory homed on other nodes.
+    // Enforcement: Writers queue up on their node's local writer mutex.
+    //--------------------------------------------------------------------------
+    // Requirement: The writer may not have write access while any other
+    //              writer has write access.
+    // Enforcement: Either this writer acquires the global write lock, or
+    //              it inherits the global write lock from the previous writer
+    //              on this node through the local writer mutex.
+    //--------------------------------------------------------------------------
+    // Requirement: The writer may not have write access while any readers
+    //              are active.
+    // Enforcement: After acquiring the global write lock, wait for the sum
+    //              of the reader counters to become zero. A writer that
+    //              inherits the global write lock does not need to wait,
+    //              because readers have been kept out since the global write
+    //              lock was first acquired.
+    //--------------------------------------------------------------------------
+    void numa_rwlock_lock_wr(numa_rwlock_t *rwlock) {
+        PRINT_CALLED("numa_rwlock_lock_wr");
+        RWLOCK_PROBE_ACQUIRE_START(rwlock, rwlock_probe_kind_write);
+        [[maybe_unused]] bool contended = false;
+        rwlock->num_active_writers++;
+        unsigned int node_index = numa_current_node() % rwlock->num_nodes;
+        numa_rwlock_node_t *node = &rwlock->nodes[node_index];
+        node->num_waiting_writers++;
+        if (!node->local_writer_mutex.try_lock()) {
+            RWLOCK_PROBE_ACQUIRE_CONTENDED(rwlock, rwlock_probe_kind_write);
+            contended = true;
+            node->local_writer_mutex.lock();
+        }
+        node->num_waiting_writers--;
+        if (!node->owns_global_lock) {
+            bool expected = false;
+            if (!rwlock->global_write_locked.compare_exchange_strong(
+                    expected, true)) {
+                RWLOCK_PROBE_ACQUIRE_CONTENDED(rwlock,
+                                               rwlock_probe_kind_write);
+                contended = true;
+                do {
+                    expected = false;
+                    std::this_thread::yield();
+                } while (!rwlock->global_write_locked.compare_exchange_weak(
+                             expected, true));
+            }
+            node->owns_global_lock = true;
+            node->num_local_handoffs = 0;
+            if (sum_active_readers(rwlock) != 0) {
+                RWLOCK_PROBE_ACQUIRE_CONTENDED(rwlock,
+                                               rwlock_probe_kind_write);
+                contended = true;
+                do {
+                    std::this_thread::yield();
+                } while (sum_active_readers(rwlock) != 0);
+            }
+        }
+        rwlock->writer_node = node_index;
+        ASSERT_ZERO(sum_active_readers(rwlock));
+        RWLOCK_PROBE_ACQUIRED(rwlock, rwlock_probe_kind_write, contended,
+                              rwlock_probe_count_unknown,
+                              rwlock->num_active_writers.load());
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: Write access should stay on the same node while writers
+    //              on that node are waiting, but writers on other nodes must
+    //              not be starved.
+    // Enforcement: Keep the global write lock for the node if any local
+    //              writers are waiting and the node has handed the lock off
+    //              fewer than handoff_bound times in a row. Otherwise release
+    //              the global write lock.
+    //--------------------------------------------------------------------------
+    // Requirement: Readers must be able to establish read access after the
+    //              last active writer has released write access.
+    // Enforcement: Decrement the number of active writers.
+    //--------------------------------------------------------------------------
+    void numa_rwlock_unlock_wr(numa_rwlock_t *rwlock) {
+        PRINT_CALLED("numa_rwlock_unlock_wr");
+        ASSERT_ZERO(sum_active_readers(rwlock));
+        numa_rwlock_node_t *node = &rwlock->nodes[rwlock->writer_node];
+        if (node->num_waiting_writers.load() > 0 &&
+            node->num_local_handoffs < rwlock->handoff_bound)
+        {
+            node->num_local_handoffs++;
+        } else {
+            node->owns_global_lock = false;
+            rwlock->global_write_locked = false;
+        }
+        ASSERT_POSITIVE(rwlock->num_active_writers.load());
+        rwlock->num_active_writers--;
+        RWLOCK_PROBE_RELEASED(rwlock, rwlock_probe_kind_write,
+                              rwlock_probe_count_unknown,
+                              rwlock->num_active_writers.load());
+        node->local_writer_mutex.unlock();
+    }
+}
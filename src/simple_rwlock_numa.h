@@ -0,0 +1,60 @@
+#ifndef SIMPLE_RWLOCK_NUMA_H
+#define SIMPLE_RWLOCK_NUMA_H
+
+#include <atomic>
+#include <mutex>
+
+#include <simple_rwlock.h>
+
+namespace simple_rwlock {
+    // Default number of consecutive times the write lock may be handed to a
+    // waiting writer on the same node before it must be released globally.
+    const rwlock_count_t numa_rwlock_default_handoff_bound = 64;
+
+    // State kept separately for each NUMA node. Each node gets its own
+    // cache line so that readers and writers on one node never touch
+    // memory homed on another node unless a writer must cross over.
+    typedef struct alignas(64) numa_rwlock_node_t {
+        // Readers that have established read access while running on this
+        // node. A reader that migrates between locking and unlocking
+        // decrements a different node's counter, so an individual counter
+        // may be negative; only the sum over all nodes is meaningful.
+        std::atomic<long> num_active_readers;
+        // Writers on this node queue up on the local writer mutex.
+        std::mutex local_writer_mutex;
+        std::atomic<rwlock_count_t> num_waiting_writers;
+        // Whether the writer holding the local writer mutex inherited the
+        // global write lock from the previous writer on this node.
+        // Only accessed while the local writer mutex is locked.
+        bool owns_global_lock;
+        rwlock_count_t num_local_handoffs;
+    } numa_rwlock_node_t;
+
+    typedef struct numa_rwlock_t {
+        // A writer is active when it is either writing or waiting to write.
+        // Readers only read this counter, so it stays in a shared state in
+        // every node's cache until a writer shows up.
+        std::atomic<rwlock_count_t> num_active_writers;
+        // At any given time, at most one node owns the global write lock.
+        std::atomic<bool> global_write_locked;
+        // Node of the writer that currently has write access.
+        unsigned int writer_node;
+        unsigned int num_nodes;
+        rwlock_count_t handoff_bound;
+        numa_rwlock_node_t *nodes;
+    } numa_rwlock_t;
+
+    void numa_rwlock_init(numa_rwlock_t *);
+    void numa_rwlock_uninit(numa_rwlock_t *);
+    void numa_rwlock_lock_rd(numa_rwlock_t *);
+    void numa_rwlock_unlock_rd(numa_rwlock_t *);
+    void numa_rwlock_lock_wr(numa_rwlock_t *);
+    void numa_rwlock_unlock_wr(numa_rwlock_t *);
+
+    // Number of NUMA nodes reported by sysfs, or 1 if it cannot be read.
+    unsigned int numa_num_nodes();
+    // Node of the CPU the calling thread is running on, or 0 if unknown.
+    unsigned int numa_current_node();
+}
+
+#endif // SIMPLE_RWLOCK_NUMA_H
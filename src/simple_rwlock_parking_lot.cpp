@@ -0,0 +1,133 @@
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+#include <simple_rwlock_parking_lot.h>
+
+namespace simple_rwlock {
+    namespace {
+        // Enough buckets that unrelated locks rarely share one, in 32KiB.
+        const unsigned int num_bucket_bits = 9;
+        const unsigned int num_buckets = 1u << num_bucket_bits;
+
+        typedef struct waiter_t {
+            const void *address;
+            bool writer;
+            // Set by the waking thread with the bucket locked.
+            bool woken;
+            std::condition_variable wake;
+            waiter_t *next;
+        } waiter_t;
+
+        // Waiters are queued in the order they parked.
+        typedef struct alignas(64) bucket_t {
+            std::mutex mutex;
+            waiter_t *head;
+            waiter_t *tail;
+        } bucket_t;
+
+        bucket_t buckets[num_buckets];
+
+        thread_local waiter_t this_waiter;
+
+        bucket_t &bucket_for(const void *address) {
+            // Fibonacci hashing spreads the aligned addresses of
+            // neighbouring locks over the whole table.
+            uint64_t key = (uint64_t)(uintptr_t)address;
+            return buckets[(key * 0x9e3779b97f4a7c15ull) >>
+                           (64 - num_bucket_bits)];
+        }
+    }
+
+    bool parking_lot_park(const void *address, bool writer,
+                          bool (*validate)(void *), void *context)
+    {
+        bucket_t &bucket = bucket_for(address);
+        waiter_t &waiter = this_waiter;
+        std::unique_lock<std::mutex> guard(bucket.mutex);
+        if (!validate(context)) {
+            return false;
+        }
+        waiter.address = address;
+        waiter.writer = writer;
+        waiter.woken = false;
+        waiter.next = nullptr;
+        if (bucket.tail == nullptr) {
+            bucket.head = &waiter;
+        } else {
+            bucket.tail->next = &waiter;
+        }
+        bucket.tail = &waiter;
+        while (!waiter.woken) {
+            waiter.wake.wait(guard);
+        }
+        return true;
+    }
+
+    unsigned int parking_lot_unpark(const void *address,
+                                    void (*before_wake)(
+                                        void *,
+                                        const parking_lot_counts_t &),
+                                    void *context)
+    {
+        bucket_t &bucket = bucket_for(address);
+        std::lock_guard<std::mutex> guard(bucket.mutex);
+        parking_lot_counts_t parked = { 0, 0 };
+        for (waiter_t *w = bucket.head; w != nullptr; w = w->next) {
+            if (w->address == address) {
+                if (w->writer) {
+                    parked.num_writers++;
+                } else {
+                    parked.num_readers++;
+                }
+            }
+        }
+        bool wake_writer = (parked.num_writers > 0);
+        parking_lot_counts_t remaining = parked;
+        if (wake_writer) {
+            remaining.num_writers--;
+        } else {
+            remaining.num_readers = 0;
+        }
+        before_wake(context, remaining);
+
+        // Unlink the chosen waiters, then wake them. A woken waiter cannot
+        // return until the bucket mutex is released, so its entry stays
+        // valid until then.
+        waiter_t *woken = nullptr;
+        waiter_t **woken_tail = &woken;
+        waiter_t *previous = nullptr;
+        waiter_t *w = bucket.head;
+        unsigned int num_woken = 0;
+        while (w != nullptr) {
+            waiter_t *next = w->next;
+            bool chosen = (w->address == address) &&
+                (w->writer == wake_writer) &&
+                (!wake_writer || num_woken == 0);
+            if (chosen) {
+                if (previous == nullptr) {
+                    bucket.head = next;
+                } else {
+                    previous->next = next;
+                }
+                if (bucket.tail == w) {
+                    bucket.tail = previous;
+                }
+                w->next = nullptr;
+                *woken_tail = w;
+                woken_tail = &w->next;
+                num_woken++;
+            } else {
+                previous = w;
+            }
+            w = next;
+        }
+        while (woken != nullptr) {
+            waiter_t *next = woken->next;
+            woken->woken = true;
+            woken->wake.notify_one();
+            woken = next;
+        }
+        return num_woken;
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef SIMPLE_RWLOCK_PARKING_LOT_H
+#define SIMPLE_RWLOCK_PARKING_LOT_H
+
+#include <type_traits>
+
+namespace simple_rwlock {
+    // Global table of wait queues shared by every lock that parks threads
+    // through it, keyed by the address of the lock. A lock only needs a few
+    // bits of its own to say that threads are parked on it, so locks that
+    // never have waiters cost nothing more than their lock word.
+    //
+    // Each address hashes to one of a fixed number of buckets. A bucket has
+    // a mutex and a queue of the threads parked on any address that hashes
+    // to it; a thread's queue entry lives in thread-local storage.
+
+    // Number of threads parked on an address, by kind.
+    typedef struct parking_lot_counts_t {
+        unsigned int num_readers;
+        unsigned int num_writers;
+    } parking_lot_counts_t;
+
+    // Park the calling thread on address as a reader or a writer, unless
+    // validate(context) returns false. validate runs with the bucket
+    // locked, so an unpark on the same address either happens before it
+    // and is seen by it, or happens after the thread is queued and wakes
+    // it. Return whether the thread parked, in which case it has since
+    // been woken.
+    bool parking_lot_park(const void *address, bool writer,
+                          bool (*validate)(void *), void *context);
+
+    // Wake the longest-parked writer on address if there is one, and
+    // otherwise every reader parked on it. before_wake(context, remaining)
+    // runs first with the bucket locked, and is told how many threads stay
+    // parked, so that the caller can update its lock word to match before
+    // another thread can park. Return the number of threads woken.
+    unsigned int parking_lot_unpark(const void *address,
+                                    void (*before_wake)(
+                                        void *,
+                                        const parking_lot_counts_t &),
+                                    void *context);
+
+    // Convenience overloads for lambdas and other callable objects.
+    template <typename Validate>
+    inline bool parking_lot_park(const void *address, bool writer,
+                                 Validate &&validate)
+    {
+        typedef typename std::remove_reference<Validate>::type validate_t;
+        return parking_lot_park(
+            address, writer,
+            [](void *context) {
+                return (*static_cast<validate_t *>(context))();
+            },
+            static_cast<void *>(&validate));
+    }
+
+    template <typename BeforeWake>
+    inline unsigned int parking_lot_unpark(const void *address,
+                                           BeforeWake &&before_wake)
+    {
+        typedef typename std::remove_reference<BeforeWake>::type
+            before_wake_t;
+        return parking_lot_unpark(
+            address,
+            [](void *context, const parking_lot_counts_t &remaining) {
+                (*static_cast<before_wake_t *>(context))(remaining);
+            },
+            static_cast<void *>(&before_wake));
+    }
+}
+
+#endif // SIMPLE_RWLOCK_PARKING_LOT_H
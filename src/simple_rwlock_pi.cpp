@@ -0,0 +1,203 @@
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <system_error>
+
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <simple_rwlock_debug_helpers.h>
+#include <simple_rwlock_pi.h>
+#include <simple_rwlock_probes.h>
+
+namespace simple_rwlock {
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+                  "futex words must be plain 32-bit words");
+
+    namespace {
+        const uint32_t writer_waiting = 1u << 31;
+        const uint32_t reader_mask = writer_waiting - 1;
+
+        thread_local uint32_t thread_tid = 0;
+
+        // The child of fork() runs the forking thread under a new thread
+        // id, so it must not keep using the cached one.
+        void forget_tid_in_child() {
+            thread_tid = 0;
+        }
+
+        uint32_t current_tid() {
+            if (thread_tid == 0) {
+                // Registered before any thread caches its id.
+                static const int registered =
+                    pthread_atfork(nullptr, nullptr, forget_tid_in_child);
+                (void)registered;
+                thread_tid = (uint32_t)syscall(SYS_gettid);
+            }
+            return thread_tid;
+        }
+
+        long futex(std::atomic<uint32_t> *word, int op, uint32_t value) {
+            return syscall(SYS_futex, (uint32_t *)word, op, value,
+                           nullptr, nullptr, 0);
+        }
+
+        // Take the any_active_writers futex. If it is held, block in the
+        // kernel, which raises the holder to the priority of the highest
+        // blocked thread until it releases the futex. Return whether the
+        // futex was held. kind is only passed to the probe.
+        bool lock_pi(pi_rwlock_t *rwlock, [[maybe_unused]] uint8_t kind) {
+            uint32_t expected = 0;
+            if (rwlock->any_active_writers.compare_exchange_strong(
+                    expected, current_tid(), std::memory_order_acquire,
+                    std::memory_order_relaxed)) {
+                return false;
+            }
+            RWLOCK_PROBE_ACQUIRE_CONTENDED(rwlock, kind);
+            // The kernel retries by itself after a signal, and fails with
+            // EAGAIN while the holder is exiting. Any other error, such as
+            // EDEADLK when this thread already holds the futex or ENOSYS
+            // when the kernel lacks PI futexes, would fail the same way
+            // on every retry, so report it as std::mutex::lock would.
+            while (futex(&rwlock->any_active_writers,
+                         FUTEX_LOCK_PI_PRIVATE, 0) != 0) {
+                if (errno != EAGAIN && errno != EINTR) {
+                    throw std::system_error(errno, std::generic_category(),
+                                            "FUTEX_LOCK_PI");
+                }
+            }
+            return true;
+        }
+
+        // Release the futex, handing it to the highest-priority blocked
+        // thread if the kernel has marked it as having any.
+        void unlock_pi(pi_rwlock_t *rwlock) {
+            uint32_t expected = current_tid();
+            if (rwlock->any_active_writers.compare_exchange_strong(
+                    expected, 0, std::memory_order_release,
+                    std::memory_order_relaxed)) {
+                return;
+            }
+            if (futex(&rwlock->any_active_writers,
+                      FUTEX_UNLOCK_PI_PRIVATE, 0) != 0) {
+                throw std::system_error(errno, std::generic_category(),
+                                        "FUTEX_UNLOCK_PI");
+            }
+        }
+    }
+
+    void pi_rwlock_init(pi_rwlock_t *rwlock) {
+        PRINT_CALLED("pi_rwlock_init");
+        rwlock->any_active_writers.store(0, std::memory_order_relaxed);
+        rwlock->num_active_readers.store(0, std::memory_order_relaxed);
+    }
+
+    void pi_rwlock_uninit(pi_rwlock_t *rwlock) {
+        PRINT_CALLED("pi_rwlock_uninit");
+        ASSERT_ZERO(rwlock->any_active_writers.load());
+        ASSERT_ZERO(rwlock->num_active_readers.load());
+        (void)rwlock;
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: The rwlock object is writer-biased, so any active writers
+    //              must become inactive before the reader can establish read
+    //              access.
+    // Enforcement: The any_active_writers futex must become locked, which a
+    //              writer holds from the time it starts waiting until it
+    //              releases write access.
+    //--------------------------------------------------------------------------
+    // Requirement: A writer that is preempted while readers wait behind it
+    //              must be boosted to the priority of those readers.
+    // Enforcement: Readers block on the any_active_writers futex with
+    //              FUTEX_LOCK_PI.
+    //--------------------------------------------------------------------------
+    // Requirement: Writers must be able to start waiting to write between the
+    //              time a reader has established read access and the time
+    //              reading completes.
+    // Enforcement: Release the any_active_writers futex once the reader is
+    //              counted.
+    //--------------------------------------------------------------------------
+    void pi_rwlock_lock_rd(pi_rwlock_t *rwlock) {
+        PRINT_CALLED("pi_rwlock_lock_rd");
+        RWLOCK_PROBE_ACQUIRE_START(rwlock, rwlock_probe_kind_read);
+        [[maybe_unused]] bool contended =
+            lock_pi(rwlock, rwlock_probe_kind_read);
+        [[maybe_unused]] uint32_t previous =
+            rwlock->num_active_readers.fetch_add(1, std::memory_order_relaxed);
+        unlock_pi(rwlock);
+        RWLOCK_PROBE_ACQUIRED(rwlock, rwlock_probe_kind_read, contended,
+                              (previous & reader_mask) + 1, 0);
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: A waiting writer must be able to establish write access
+    //              after the last active reader has released its read access.
+    // Enforcement: The reader that brings the count to zero wakes the writer
+    //              if the writer waiting bit is set.
+    //--------------------------------------------------------------------------
+    void pi_rwlock_unlock_rd(pi_rwlock_t *rwlock) {
+        PRINT_CALLED("pi_rwlock_unlock_rd");
+        uint32_t previous = rwlock->num_active_readers.fetch_sub(
+            1, std::memory_order_release);
+        ASSERT_POSITIVE((previous & reader_mask));
+        RWLOCK_PROBE_RELEASED(rwlock, rwlock_probe_kind_read,
+                              (previous & reader_mask) - 1,
+                              (previous & writer_waiting) != 0);
+        if (previous == (writer_waiting | 1)) {
+            futex(&rwlock->num_active_readers, FUTEX_WAKE_PRIVATE, 1);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: The writer may not have write access while any other
+    //              writer has write access, and readers may not become active
+    //              while this writer is waiting or writing.
+    // Enforcement: Hold the any_active_writers futex from the start of this
+    //              function until pi_rwlock_unlock_wr. Readers and writers
+    //              blocked on it boost this writer.
+    //--------------------------------------------------------------------------
+    // Requirement: The writer may not have write access while any readers
+    //              are active.
+    // Enforcement: Set the writer waiting bit and wait in the kernel until
+    //              the reader count is zero. No reader can be counted in
+    //              while the futex is held, so the count stays zero.
+    //--------------------------------------------------------------------------
+    void pi_rwlock_lock_wr(pi_rwlock_t *rwlock) {
+        PRINT_CALLED("pi_rwlock_lock_wr");
+        RWLOCK_PROBE_ACQUIRE_START(rwlock, rwlock_probe_kind_write);
+        [[maybe_unused]] bool contended =
+            lock_pi(rwlock, rwlock_probe_kind_write);
+        if (rwlock->num_active_readers.load(std::memory_order_acquire) == 0) {
+            RWLOCK_PROBE_ACQUIRED(rwlock, rwlock_probe_kind_write, contended,
+                                  0, 1);
+            return;
+        }
+        RWLOCK_PROBE_ACQUIRE_CONTENDED(rwlock, rwlock_probe_kind_write);
+        uint32_t state = rwlock->num_active_readers.fetch_or(
+            writer_waiting, std::memory_order_acquire) | writer_waiting;
+        while ((state & reader_mask) != 0) {
+            futex(&rwlock->num_active_readers, FUTEX_WAIT_PRIVATE, state);
+            state = rwlock->num_active_readers.load(
+                std::memory_order_acquire);
+        }
+        rwlock->num_active_readers.store(0, std::memory_order_relaxed);
+        RWLOCK_PROBE_ACQUIRED(rwlock, rwlock_probe_kind_write, true, 0, 1);
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: Waiting writers and readers must be able to establish
+    //              access after a writer has released write access, highest
+    //              priority first.
+    // Enforcement: Release the any_active_writers futex, which the kernel
+    //              hands to its highest-priority waiter.
+    //--------------------------------------------------------------------------
+    void pi_rwlock_unlock_wr(pi_rwlock_t *rwlock) {
+        PRINT_CALLED("pi_rwlock_unlock_wr");
+        ASSERT_ZERO(rwlock->num_active_readers.load());
+        unlock_pi(rwlock);
+        RWLOCK_PROBE_RELEASED(rwlock, rwlock_probe_kind_write, 0, 0);
+    }
+}
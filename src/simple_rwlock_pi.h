@@ -0,0 +1,43 @@
+#ifndef SIMPLE_RWLOCK_PI_H
+#define SIMPLE_RWLOCK_PI_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace simple_rwlock {
+    // Writer-biased read-write lock for programs with real-time threads.
+    // Writers hold a priority-inheriting futex (FUTEX_LOCK_PI) for as long
+    // as they are active, so a writer holding or waiting for write access
+    // runs at the priority of the highest-priority thread blocked behind
+    // it, and a preempted low-priority writer cannot hold up a SCHED_FIFO
+    // writer for longer than its own critical section.
+    //
+    // Readers take the same futex only for as long as it takes to count
+    // themselves in, so a reader blocked behind a writer also boosts that
+    // writer. Readers with read access own nothing the kernel can see,
+    // though, so they are never boosted: a writer waiting for readers to
+    // leave waits for them at their own priorities. Keep read sections
+    // short, or run readers at the priority of the writers they may delay.
+    //
+    // If the kernel refuses the futex, for example without PI futex
+    // support or when a thread locks it twice, the lock and unlock
+    // functions throw std::system_error, as std::mutex::lock does.
+    typedef struct pi_rwlock_t {
+        // 0 while no writer is active, and otherwise the thread id of the
+        // thread holding it, with FUTEX_WAITERS set by the kernel if any
+        // other thread is blocked on it.
+        std::atomic<uint32_t> any_active_writers;
+        // Number of readers with read access, and a bit that is set while
+        // a writer waits in the kernel for the count to reach zero.
+        std::atomic<uint32_t> num_active_readers;
+    } pi_rwlock_t;
+
+    void pi_rwlock_init(pi_rwlock_t *);
+    void pi_rwlock_uninit(pi_rwlock_t *);
+    void pi_rwlock_lock_rd(pi_rwlock_t *);
+    void pi_rwlock_unlock_rd(pi_rwlock_t *);
+    void pi_rwlock_lock_wr(pi_rwlock_t *);
+    void pi_rwlock_unlock_wr(pi_rwlock_t *);
+}
+
+#endif // SIMPLE_RWLOCK_PI_H
@@ -0,0 +1,194 @@
+#ifndef SIMPLE_RWLOCK_PREEMPTION_H
+#define SIMPLE_RWLOCK_PREEMPTION_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <simple_rwlock_basic.h>
+
+// Wait policy for basic_rwlock on machines running more threads than they
+// have CPUs. Spinning only pays off while the thread holding the mutex is
+// running; once it has been descheduled, every spinning thread is burning
+// a time slice the holder could have used. This policy spins for a bounded
+// time, gives the CPU away with sched_yield as it goes, and blocks as soon
+// as it sees a sign that the holder is not running.
+namespace simple_rwlock {
+    namespace preemption {
+        inline thread_local pid_t cached_tid = 0;
+
+        // The child of fork runs as a new thread with a new id, but
+        // inherits the parent thread's cached_tid.
+        inline void forget_tid_in_child() {
+            cached_tid = 0;
+        }
+
+        inline pid_t current_tid() {
+            if (cached_tid == 0) {
+                // Registered before any thread caches its id.
+                static const int registered =
+                    pthread_atfork(nullptr, nullptr, forget_tid_in_child);
+                (void)registered;
+                cached_tid = (pid_t)syscall(SYS_gettid);
+            }
+            return cached_tid;
+        }
+
+        // The kernel's encoding of CPU clock ids, from
+        // include/linux/posix-timers_types.h: the clock of one thread is
+        // MAKE_THREAD_CPUCLOCK(tid, CPUCLOCK_SCHED), that is
+        // (~tid << 3) | CPUCLOCK_PERTHREAD_MASK | CPUCLOCK_SCHED. This is
+        // part of the kernel ABI, and glibc builds the clock id of
+        // pthread_getcpuclockid the same way.
+        const clockid_t cpuclock_perthread_mask = 4;
+        const clockid_t cpuclock_sched = 2;
+
+        inline clockid_t make_thread_cpuclock(pid_t tid) {
+            return (clockid_t)(~(unsigned int)tid << 3) |
+                cpuclock_perthread_mask | cpuclock_sched;
+        }
+
+        // Nanoseconds of CPU time used so far by thread tid of this
+        // process, or 0 if the thread no longer exists. This is the clock
+        // that pthread_getcpuclockid gives, made from the thread id
+        // instead of a pthread_t, since the thread may have exited and
+        // pthread_getcpuclockid must not be given the pthread_t of a
+        // thread that has been joined or detached and exited. The kernel
+        // brings the clock up to date for a thread that is running.
+        inline uint64_t thread_cpu_time_ns(pid_t tid) {
+            clockid_t clock = make_thread_cpuclock(tid);
+            timespec now;
+            if (clock_gettime(clock, &now) != 0) {
+                return 0;
+            }
+            return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+        }
+
+        inline uint64_t now_ns() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        // std::mutex that remembers the thread id of the thread that last
+        // locked it, until it is unlocked. Readers of basic_rwlock may
+        // unlock the write_or_any_read mutex from a different thread than
+        // the one that locked it, so the holder is only a hint.
+        class holder_mutex {
+        public:
+            holder_mutex() : holder_(0) { }
+
+            void lock() {
+                mutex_.lock();
+                holder_.store(current_tid(), std::memory_order_relaxed);
+            }
+            bool try_lock() {
+                if (!mutex_.try_lock()) {
+                    return false;
+                }
+                holder_.store(current_tid(), std::memory_order_relaxed);
+                return true;
+            }
+            void unlock() {
+                holder_.store(0, std::memory_order_relaxed);
+                mutex_.unlock();
+            }
+            // Thread id of the holder, or 0 if unknown.
+            pid_t holder() const {
+                return holder_.load(std::memory_order_relaxed);
+            }
+
+        private:
+            std::mutex mutex_;
+            std::atomic<pid_t> holder_;
+        };
+
+        // Whether the holder of a mutex has had any CPU time between two
+        // calls to stalled.
+        class holder_probe {
+        public:
+            holder_probe() : tid_(0), cpu_time_ns_(0) { }
+
+            // Return true if holder held the mutex at the previous call
+            // too and has not run since.
+            bool stalled(pid_t holder) {
+                if (holder == 0) {
+                    tid_ = 0;
+                    return false;
+                }
+                uint64_t cpu_time_ns = thread_cpu_time_ns(holder);
+                bool result = (cpu_time_ns != 0) && (holder == tid_) &&
+                    (cpu_time_ns == cpu_time_ns_);
+                tid_ = holder;
+                cpu_time_ns_ = cpu_time_ns;
+                return result;
+            }
+
+        private:
+            pid_t tid_;
+            uint64_t cpu_time_ns_;
+        };
+    }
+
+    // Spin on the mutex for up to spin_ns nanoseconds before blocking.
+    // Every yield_interval attempts, give the CPU away with sched_yield,
+    // and block right away if either:
+    //
+    // - sched_yield took longer than slow_yield_ns, meaning some other
+    //   thread was waiting for this CPU, so there are more runnable threads
+    //   than CPUs and the holder may well be one of the ones waiting, or
+    // - with check_holder, the thread that locked the mutex has used no
+    //   CPU time since the last check, meaning it is blocked or preempted.
+    //
+    // check_holder makes every lock of the mutex record the caller's
+    // thread id, and every check cost one clock_gettime system call.
+    template <unsigned long spin_ns = 50000,
+              bool check_holder = true,
+              unsigned int yield_interval = 64,
+              unsigned long slow_yield_ns = 10000>
+    struct preemption_tolerant_wait_policy {
+        typedef typename std::conditional<check_holder,
+                                          preemption::holder_mutex,
+                                          std::mutex>::type mutex_t;
+
+        template <bool track_contention>
+        static bool acquire(mutex_t *mutex) {
+            if (mutex->try_lock()) {
+                return false;
+            }
+            uint64_t deadline = preemption::now_ns() + spin_ns;
+            preemption::holder_probe probe;
+            for (unsigned int i = 1; ; i++) {
+                cpu_relax();
+                if (mutex->try_lock()) {
+                    return true;
+                }
+                if (i % yield_interval != 0) {
+                    continue;
+                }
+                if constexpr (check_holder) {
+                    if (probe.stalled(mutex->holder())) {
+                        break;
+                    }
+                }
+                uint64_t before = preemption::now_ns();
+                sched_yield();
+                uint64_t after = preemption::now_ns();
+                if (after - before > slow_yield_ns || after >= deadline) {
+                    break;
+                }
+            }
+            mutex->lock();
+            return true;
+        }
+    };
+}
+
+#endif // SIMPLE_RWLOCK_PREEMPTION_H
@@ -0,0 +1,84 @@
+#ifndef SIMPLE_RWLOCK_PROBES_H
+#define SIMPLE_RWLOCK_PROBES_H
+
+#include <cstdint>
+
+// USDT (user-level statically defined tracing) probes for the lock events
+// of the locks in this library, in the "simple_rwlock" provider. Each probe
+// compiles to a single NOP and an ELF note naming it, and costs nothing
+// else until a tracer such as bpftrace attaches to it. Arguments are only
+// read by an attached tracer.
+//
+//     acquire_start(lock, kind)
+//         A thread called lock_rd or lock_wr.
+//     acquire_contended(lock, kind)
+//         The thread found the lock unavailable and is about to wait. Fires
+//         once for each thing waited for in turn: each of the mutexes of a
+//         basic_rwlock, or for example the local writer mutex, the global
+//         write lock and then the readers of a numa_rwlock_t.
+//     acquired(lock, kind, contended, num_active_readers,
+//              num_active_writers)
+//         The thread established access. contended is 1 if it fired
+//         acquire_contended first.
+//     released(lock, kind, num_active_readers, num_active_writers)
+//         The thread released access. The counters are taken after the
+//         release.
+//
+// kind is rwlock_probe_kind_read or rwlock_probe_kind_write. The counters
+// are the lock's own counts of active readers and writers, as described in
+// the header of each lock, and so only compare between locks of the same
+// type. A lock that keeps no single count passes
+// rwlock_probe_count_unknown instead: numa_rwlock_t, and adaptive_rwlock_t
+// in the distributed mode, for readers, and range_rwlock_t for both.
+// intention_rwlock_t counts IS and S holders as readers and IX, SIX and X
+// holders as writers, and its kind follows the same split.
+//
+// Every lock fires the probes: rwlock_t and every basic_rwlock
+// configuration, numa_rwlock_t, compact_rwlock_t, pi_rwlock_t,
+// adaptive_rwlock_t, range_rwlock_t, intention_rwlock_t and
+// async_rwlock_t. elided_rwlock_t and combining_rwlock_t fire them through
+// their underlying rwlock_t, which is at the same address, except that
+// elided reads fire none: the breakpoint of an attached tracer would abort
+// the transaction. async_rwlock_t fires acquired for a coroutine that had
+// to wait on the thread that granted it access, so the thread of acquired
+// may differ from that of acquire_start and released. Example bpftrace
+// scripts are in tools/bpftrace.
+//
+// The probes are built in when <sys/sdt.h> (from systemtap-sdt-dev or
+// systemtap-sdt-devel) is found. Define SIMPLE_RWLOCK_NO_PROBES to leave
+// them out.
+#if !defined(SIMPLE_RWLOCK_NO_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define SIMPLE_RWLOCK_PROBES 1
+#endif
+#endif
+
+#ifndef SIMPLE_RWLOCK_PROBES
+#define SIMPLE_RWLOCK_PROBES 0
+#endif
+
+namespace simple_rwlock {
+    const uint8_t rwlock_probe_kind_read = 0;
+    const uint8_t rwlock_probe_kind_write = 1;
+    const long rwlock_probe_count_unknown = -1;
+}
+
+#if SIMPLE_RWLOCK_PROBES
+#define RWLOCK_PROBE_ACQUIRE_START(lock, kind) \
+    DTRACE_PROBE2(simple_rwlock, acquire_start, lock, kind)
+#define RWLOCK_PROBE_ACQUIRE_CONTENDED(lock, kind) \
+    DTRACE_PROBE2(simple_rwlock, acquire_contended, lock, kind)
+#define RWLOCK_PROBE_ACQUIRED(lock, kind, contended, readers, writers) \
+    DTRACE_PROBE5(simple_rwlock, acquired, lock, kind, contended, \
+                  readers, writers)
+#define RWLOCK_PROBE_RELEASED(lock, kind, readers, writers) \
+    DTRACE_PROBE4(simple_rwlock, released, lock, kind, readers, writers)
+#else
+#define RWLOCK_PROBE_ACQUIRE_START(lock, kind)
+#define RWLOCK_PROBE_ACQUIRE_CONTENDED(lock, kind)
+#define RWLOCK_PROBE_ACQUIRED(lock, kind, contended, readers, writers)
+#define RWLOCK_PROBE_RELEASED(lock, kind, readers, writers)
+#endif
+
+#endif // SIMPLE_RWLOCK_PROBES_H
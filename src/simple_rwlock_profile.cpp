@@ -0,0 +1,275 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+#include <execinfo.h>
+
+#include <simple_rwlock_profile.h>
+#include <simple_rwlock_trace.h>
+
+namespace simple_rwlock {
+    namespace {
+        // Frames at the top of every sampled stack that belong to the
+        // profiler: rwlock_profile_lock_acquired, and rwlock_lock_rd or
+        // rwlock_lock_wr.
+        const int num_profiler_frames = 2;
+
+        // One call site. A thread claims a free entry by setting its hash,
+        // fills in the stack, and then sets ready. Another thread sampling
+        // the same stack before ready is set claims an entry of its own;
+        // rwlock_profile_top_sites merges such duplicates.
+        typedef struct site_entry_t {
+            // 0 while free.
+            std::atomic<uint64_t> hash;
+            std::atomic<bool> ready;
+            void *frames[rwlock_profile_max_frames];
+            unsigned int num_frames;
+            uint8_t kind;
+            std::atomic<unsigned long> num_samples;
+            std::atomic<uint64_t> total_wait_ns;
+            std::atomic<uint64_t> max_wait_ns;
+        } site_entry_t;
+
+        site_entry_t site_table[rwlock_profile_max_sites];
+        std::atomic<unsigned int> current_sample_period(1);
+        std::atomic<unsigned long> num_dropped(0);
+        // Incremented by every rwlock_profile_start, so that threads
+        // restart their countdown with the new sample period.
+        std::atomic<unsigned long> profile_generation(0);
+        // Threads between deciding to record a sample and finishing with
+        // the table. rwlock_profile_start turns profiling off and waits
+        // for this to reach 0 before it clears the table, so that no
+        // entry is reset between being claimed and being made ready.
+        std::atomic<unsigned long> num_recording(0);
+
+        typedef struct thread_sampler_t {
+            unsigned long generation;
+            // Contended calls left until the next sample.
+            unsigned int countdown;
+        } thread_sampler_t;
+
+        thread_local thread_sampler_t thread_sampler = { 0, 0 };
+        // When the current lock call started waiting, or 0 if it has not.
+        thread_local uint64_t wait_start_ns = 0;
+
+        bool profile_enabled() {
+            return (rwlock_instrumentation.load() &
+                    rwlock_instrument_profile) != 0;
+        }
+
+        // FNV-1a over the frame addresses and the kind, never 0.
+        uint64_t hash_stack(void *const *frames, unsigned int num_frames,
+                            uint8_t kind)
+        {
+            uint64_t hash = 14695981039346656037ull;
+            for (unsigned int i = 0; i < num_frames; i++) {
+                hash = (hash ^ (uintptr_t)frames[i]) * 1099511628211ull;
+            }
+            hash = (hash ^ kind) * 1099511628211ull;
+            return (hash == 0) ? 1 : hash;
+        }
+
+        bool same_stack(void *const *frames, unsigned int num_frames,
+                        uint8_t kind, void *const *other_frames,
+                        unsigned int other_num_frames, uint8_t other_kind)
+        {
+            return kind == other_kind && num_frames == other_num_frames &&
+                std::equal(frames, frames + num_frames, other_frames);
+        }
+
+        void add_sample(site_entry_t &entry, uint64_t wait_ns) {
+            entry.num_samples.fetch_add(1, std::memory_order_relaxed);
+            entry.total_wait_ns.fetch_add(wait_ns, std::memory_order_relaxed);
+            uint64_t max_wait_ns =
+                entry.max_wait_ns.load(std::memory_order_relaxed);
+            while (wait_ns > max_wait_ns &&
+                   !entry.max_wait_ns.compare_exchange_weak(
+                       max_wait_ns, wait_ns, std::memory_order_relaxed)) {
+            }
+        }
+
+        // Find or claim the entry of a stack by linear probing.
+        void record_sample(void *const *frames, unsigned int num_frames,
+                           uint8_t kind, uint64_t wait_ns)
+        {
+            uint64_t hash = hash_stack(frames, num_frames, kind);
+            for (unsigned int i = 0; i < rwlock_profile_max_sites; i++) {
+                site_entry_t &entry =
+                    site_table[(hash + i) % rwlock_profile_max_sites];
+                uint64_t entry_hash =
+                    entry.hash.load(std::memory_order_acquire);
+                if (entry_hash == 0 &&
+                    entry.hash.compare_exchange_strong(
+                        entry_hash, hash, std::memory_order_acquire)) {
+                    std::copy(frames, frames + num_frames, entry.frames);
+                    entry.num_frames = num_frames;
+                    entry.kind = kind;
+                    entry.ready.store(true, std::memory_order_release);
+                    add_sample(entry, wait_ns);
+                    return;
+                }
+                if (entry_hash == hash &&
+                    entry.ready.load(std::memory_order_acquire) &&
+                    same_stack(frames, num_frames, kind, entry.frames,
+                               entry.num_frames, entry.kind)) {
+                    add_sample(entry, wait_ns);
+                    return;
+                }
+            }
+            num_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        const char *kind_name(uint8_t kind) {
+            return (kind == rwlock_trace_kind_read) ? "read" : "write";
+        }
+    }
+
+    void rwlock_profile_record_wait() {
+        if (wait_start_ns == 0 && profile_enabled()) {
+            wait_start_ns = rwlock_trace_now_ns();
+        }
+    }
+
+    void rwlock_profile_lock_call() {
+        wait_start_ns = 0;
+    }
+
+    void rwlock_profile_lock_acquired(uint8_t kind) {
+        if (wait_start_ns == 0) {
+            return;
+        }
+        uint64_t wait_ns = rwlock_trace_now_ns() - wait_start_ns;
+        wait_start_ns = 0;
+        thread_sampler_t &sampler = thread_sampler;
+        unsigned long generation =
+            profile_generation.load(std::memory_order_acquire);
+        if (sampler.generation != generation) {
+            sampler.generation = generation;
+            sampler.countdown =
+                current_sample_period.load(std::memory_order_relaxed);
+        }
+        if (--sampler.countdown != 0) {
+            return;
+        }
+        sampler.countdown =
+            current_sample_period.load(std::memory_order_relaxed);
+
+        void *frames[num_profiler_frames + rwlock_profile_max_frames];
+        int num_frames = backtrace(
+            frames, num_profiler_frames + rwlock_profile_max_frames);
+        if (num_frames <= num_profiler_frames) {
+            return;
+        }
+        // Both sides use sequentially consistent operations, so either
+        // rwlock_profile_start sees this thread counted in, or this thread
+        // sees profiling turned off and leaves the table alone.
+        num_recording.fetch_add(1);
+        if (profile_enabled()) {
+            record_sample(frames + num_profiler_frames,
+                          num_frames - num_profiler_frames, kind, wait_ns);
+        }
+        num_recording.fetch_sub(1);
+    }
+
+    void rwlock_profile_start(unsigned int sample_period) {
+        rwlock_instrumentation.fetch_and(~rwlock_instrument_profile);
+        while (num_recording.load() != 0) {
+            std::this_thread::yield();
+        }
+        for (auto &entry : site_table) {
+            entry.ready.store(false, std::memory_order_relaxed);
+            entry.num_samples.store(0, std::memory_order_relaxed);
+            entry.total_wait_ns.store(0, std::memory_order_relaxed);
+            entry.max_wait_ns.store(0, std::memory_order_relaxed);
+            entry.hash.store(0, std::memory_order_release);
+        }
+        num_dropped.store(0, std::memory_order_relaxed);
+        current_sample_period.store(
+            (sample_period == 0) ? 1 : sample_period);
+        // backtrace loads the unwinder the first time it is called, which
+        // allocates. Do that here rather than inside a lock call.
+        void *frame;
+        backtrace(&frame, 1);
+        profile_generation.fetch_add(1, std::memory_order_release);
+        rwlock_instrumentation.fetch_or(rwlock_instrument_profile);
+    }
+
+    void rwlock_profile_stop() {
+        rwlock_instrumentation.fetch_and(~rwlock_instrument_profile);
+    }
+
+    void rwlock_profile_top_sites(size_t max_sites,
+                                  std::vector<rwlock_profile_site_t> *sites)
+    {
+        sites->clear();
+        for (auto &entry : site_table) {
+            if (entry.hash.load(std::memory_order_acquire) == 0 ||
+                !entry.ready.load(std::memory_order_acquire)) {
+                continue;
+            }
+            auto same = std::find_if(
+                sites->begin(), sites->end(),
+                [&entry](const rwlock_profile_site_t &site) {
+                    return same_stack(site.frames, site.num_frames,
+                                      site.kind, entry.frames,
+                                      entry.num_frames, entry.kind);
+                });
+            if (same == sites->end()) {
+                rwlock_profile_site_t site = {};
+                std::copy(entry.frames, entry.frames + entry.num_frames,
+                          site.frames);
+                site.num_frames = entry.num_frames;
+                site.kind = entry.kind;
+                same = sites->insert(sites->end(), site);
+            }
+            same->num_samples += entry.num_samples.load();
+            same->total_wait_ns += entry.total_wait_ns.load();
+            same->max_wait_ns = std::max(same->max_wait_ns,
+                                         (uint64_t)entry.max_wait_ns.load());
+        }
+        std::sort(sites->begin(), sites->end(),
+                  [](const rwlock_profile_site_t &a,
+                     const rwlock_profile_site_t &b) {
+                      return a.total_wait_ns > b.total_wait_ns;
+                  });
+        if (sites->size() > max_sites) {
+            sites->resize(max_sites);
+        }
+    }
+
+    unsigned long rwlock_profile_num_dropped() {
+        return num_dropped.load();
+    }
+
+    void rwlock_profile_dump(std::ostream &out, size_t max_sites) {
+        std::vector<rwlock_profile_site_t> sites;
+        rwlock_profile_top_sites(max_sites, &sites);
+        out << "rwlock_t contended call sites by total wait, sampling 1 in "
+            << std::dec << current_sample_period.load()
+            << " contended calls, " << rwlock_profile_num_dropped()
+            << " samples dropped"
+            << std::endl;
+        for (size_t i = 0; i < sites.size(); i++) {
+            const rwlock_profile_site_t &site = sites[i];
+            out << "#" << (i + 1) << " " << kind_name(site.kind) << ": "
+                << site.num_samples << " samples, total wait "
+                << site.total_wait_ns << " ns, max wait "
+                << site.max_wait_ns << " ns" << std::endl;
+            char **symbols = backtrace_symbols(site.frames, site.num_frames);
+            for (unsigned int j = 0; j < site.num_frames; j++) {
+                out << "    ";
+                if (symbols != nullptr) {
+                    out << symbols[j];
+                } else {
+                    out << site.frames[j];
+                }
+                out << std::endl;
+            }
+            free(symbols);
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef SIMPLE_RWLOCK_PROFILE_H
+#define SIMPLE_RWLOCK_PROFILE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include <simple_rwlock_trace.h>
+
+namespace simple_rwlock {
+    // Sampling profiler for the call sites that wait in rwlock_t.
+    //
+    // Call rwlock_profile_start(n) to sample one in n rwlock_lock_rd and
+    // rwlock_lock_wr calls that had to wait for the lock. Each sample
+    // records the caller's stack and how long the call took, and is added
+    // to a fixed-size table of call sites without taking any lock. Call
+    // rwlock_profile_top_sites or rwlock_profile_dump to see the call sites
+    // that waited longest in total. The clock is only read by calls that
+    // have to wait, once when they start waiting and once when they get
+    // access. While neither profiling nor tracing, the rwlock_t functions
+    // only pay for one relaxed atomic load.
+
+    // Frames kept of each sampled stack, starting at the caller of
+    // rwlock_lock_rd or rwlock_lock_wr.
+    const unsigned int rwlock_profile_max_frames = 16;
+    // Distinct stacks the table can hold. Samples of further stacks are
+    // dropped and counted.
+    const unsigned int rwlock_profile_max_sites = 1024;
+
+    typedef struct rwlock_profile_site_t {
+        void *frames[rwlock_profile_max_frames];
+        unsigned int num_frames;
+        // rwlock_trace_kind_read or rwlock_trace_kind_write.
+        uint8_t kind;
+        unsigned long num_samples;
+        // Nanoseconds from the first time the lock call had to wait until
+        // access was acquired, over the sampled calls only.
+        uint64_t total_wait_ns;
+        uint64_t max_wait_ns;
+    } rwlock_profile_site_t;
+
+    // Discard earlier samples and start sampling one in sample_period
+    // contended calls in each thread. May be called while other threads
+    // are in rwlock_t calls: it first waits for samples being recorded to
+    // finish. Samples of calls already waiting may land in either run.
+    // Must not be called while another thread is in
+    // rwlock_profile_top_sites or rwlock_profile_dump.
+    void rwlock_profile_start(unsigned int sample_period);
+    // Stop sampling. The table keeps its samples until the next start.
+    void rwlock_profile_stop();
+
+    // Set sites to at most max_sites call sites, in decreasing order of
+    // total wait.
+    void rwlock_profile_top_sites(size_t max_sites,
+                                  std::vector<rwlock_profile_site_t> *sites);
+    // Samples dropped because the table was full.
+    unsigned long rwlock_profile_num_dropped();
+    // Write the top max_sites call sites to out, with their stacks
+    // symbolized by backtrace_symbols. Link with -rdynamic to see the names
+    // of functions in the executable.
+    void rwlock_profile_dump(std::ostream &out, size_t max_sites);
+
+    // Called by the rwlock_t functions, only while rwlock_instrumentation
+    // has rwlock_instrument_profile set. rwlock_profile_lock_call forgets
+    // any wait noted by an earlier call. rwlock_profile_record_wait, called
+    // by rwlock_t itself, notes when the call started waiting, and
+    // rwlock_profile_lock_acquired samples the call if it waited. The
+    // sampled stack starts at the caller of the rwlock_t function, so
+    // rwlock_profile_lock_acquired must be called directly from it and
+    // not as a tail call.
+    void rwlock_profile_lock_call();
+    void rwlock_profile_lock_acquired(uint8_t kind);
+}
+
+#endif // SIMPLE_RWLOCK_PROFILE_H
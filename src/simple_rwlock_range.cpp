@@ -0,0 +1,176 @@
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+
+#include <simple_rwlock_debug_helpers.h>
+#include <simple_rwlock_probes.h>
+#include <simple_rwlock_range.h>
+
+namespace simple_rwlock {
+    namespace {
+        typedef range_rwlock_range_t range_t;
+        typedef std::multimap<uint64_t, range_t *> range_map_t;
+        typedef std::multiset<uint64_t> length_set_t;
+
+        bool overlap(const range_t *a, const range_t *b) {
+            return a->start < b->end && b->start < a->end;
+        }
+
+        bool conflict(const range_t *a, const range_t *b) {
+            return (a->writer || b->writer) && overlap(a, b);
+        }
+
+        [[maybe_unused]] uint8_t probe_kind(const range_t *range) {
+            return range->writer ? rwlock_probe_kind_write
+                : rwlock_probe_kind_read;
+        }
+
+        // First entry of the map that could overlap range. Every entry
+        // before it ends at or before range->start.
+        range_map_t::iterator first_candidate(range_rwlock_t *rwlock,
+                                              const range_t *range)
+        {
+            uint64_t max_length = rwlock->lengths->empty()
+                ? 0 : *rwlock->lengths->rbegin();
+            uint64_t lowest_start = (range->start >= max_length)
+                ? range->start - max_length + 1 : 0;
+            return rwlock->ranges->lower_bound(lowest_start);
+        }
+
+        void lock(range_rwlock_t *rwlock, range_t *range, uint64_t offset,
+                  uint64_t length, bool writer)
+        {
+            if (length == 0) {
+                throw std::invalid_argument("range_rwlock: length is zero");
+            }
+            if (offset + length < offset) {
+                throw std::invalid_argument(
+                    "range_rwlock: offset + length overflows");
+            }
+            range->start = offset;
+            range->end = offset + length;
+            range->writer = writer;
+            range->num_blockers = 0;
+            RWLOCK_PROBE_ACQUIRE_START(rwlock, probe_kind(range));
+            std::unique_lock<std::mutex> guard(*rwlock->mutex);
+            range->sequence = rwlock->next_sequence++;
+            for (auto it = first_candidate(rwlock, range);
+                 it != rwlock->ranges->end() && it->first < range->end;
+                 ++it) {
+                if (conflict(it->second, range)) {
+                    range->num_blockers++;
+                }
+            }
+            rwlock->lengths->insert(length);
+            rwlock->ranges->insert(std::make_pair(range->start, range));
+            bool contended = (range->num_blockers != 0);
+            if (contended) {
+                RWLOCK_PROBE_ACQUIRE_CONTENDED(rwlock, probe_kind(range));
+                do {
+                    range->granted.wait(guard);
+                } while (range->num_blockers != 0);
+            }
+            // The lock keeps no count of readers and writers, only of
+            // ranges.
+            RWLOCK_PROBE_ACQUIRED(rwlock, probe_kind(range), contended,
+                                  rwlock_probe_count_unknown,
+                                  rwlock_probe_count_unknown);
+        }
+
+        void unlock(range_rwlock_t *rwlock, range_t *range) {
+            std::lock_guard<std::mutex> guard(*rwlock->mutex);
+            ASSERT_ZERO(range->num_blockers);
+            range_map_t::iterator self = rwlock->ranges->end();
+            for (auto it = first_candidate(rwlock, range);
+                 it != rwlock->ranges->end() && it->first < range->end;
+                 ++it) {
+                range_t *other = it->second;
+                if (other == range) {
+                    self = it;
+                } else if (other->sequence > range->sequence &&
+                           conflict(other, range)) {
+                    ASSERT_POSITIVE(other->num_blockers);
+                    if (--other->num_blockers == 0) {
+                        other->granted.notify_one();
+                    }
+                }
+            }
+            ASSERT_ZERO((self == rwlock->ranges->end()));
+            rwlock->ranges->erase(self);
+            rwlock->lengths->erase(
+                rwlock->lengths->find(range->end - range->start));
+            RWLOCK_PROBE_RELEASED(rwlock, probe_kind(range),
+                                  rwlock_probe_count_unknown,
+                                  rwlock_probe_count_unknown);
+        }
+    }
+
+    void range_rwlock_init(range_rwlock_t *rwlock) {
+        PRINT_CALLED("range_rwlock_init");
+        rwlock->mutex = new std::mutex;
+        rwlock->ranges = new range_map_t;
+        rwlock->lengths = new length_set_t;
+        rwlock->next_sequence = 0;
+    }
+
+    void range_rwlock_uninit(range_rwlock_t *rwlock) {
+        PRINT_CALLED("range_rwlock_uninit");
+        ASSERT_ZERO(rwlock->ranges->size());
+        delete rwlock->lengths;
+        delete rwlock->ranges;
+        delete rwlock->mutex;
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: No writer may have write access to any part of the range
+    //              while this reader has read access to it.
+    // Requirement: The rwlock object is writer-biased, so writers waiting
+    //              for an overlapping range must have had write access
+    //              before this reader can establish read access.
+    // Enforcement: Count the overlapping writer ranges already in the map,
+    //              whether they are locked or waiting, and wait until each of
+    //              them has been unlocked.
+    //--------------------------------------------------------------------------
+    void range_rwlock_lock_rd(range_rwlock_t *rwlock, range_t *range,
+                              uint64_t offset, uint64_t length)
+    {
+        PRINT_CALLED("range_rwlock_lock_rd");
+        lock(rwlock, range, offset, length, false);
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: Ranges that waited for this one must be able to
+    //              establish access once nothing else they overlap is ahead
+    //              of them.
+    // Enforcement: Remove the range from the map and take it off the count
+    //              of every later range it conflicts with, waking each range
+    //              whose count reaches zero.
+    //--------------------------------------------------------------------------
+    void range_rwlock_unlock_rd(range_rwlock_t *rwlock, range_t *range) {
+        PRINT_CALLED("range_rwlock_unlock_rd");
+        unlock(rwlock, range);
+    }
+
+    //--------------------------------------------------------------------------
+    // Requirement: The writer may not have write access to any part of the
+    //              range while any other thread has access to it.
+    // Enforcement: Count every overlapping range already in the map and
+    //              wait until each of them has been unlocked. Ranges added
+    //              later count this one in turn.
+    //--------------------------------------------------------------------------
+    void range_rwlock_lock_wr(range_rwlock_t *rwlock, range_t *range,
+                              uint64_t offset, uint64_t length)
+    {
+        PRINT_CALLED("range_rwlock_lock_wr");
+        lock(rwlock, range, offset, length, true);
+    }
+
+    void range_rwlock_unlock_wr(range_rwlock_t *rwlock, range_t *range) {
+        PRINT_CALLED("range_rwlock_unlock_wr");
+        ASSERT_POSITIVE(range->writer);
+        unlock(rwlock, range);
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef SIMPLE_RWLOCK_RANGE_H
+#define SIMPLE_RWLOCK_RANGE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+
+namespace simple_rwlock {
+    // One locked or waiting range of a range_rwlock_t. The caller provides
+    // it, usually on the stack, and must keep it alive and pass it to the
+    // matching unlock call. Its fields belong to the lock.
+    typedef struct range_rwlock_range_t {
+        uint64_t start;
+        uint64_t end;
+        bool writer;
+        // Order in which the range was requested.
+        uint64_t sequence;
+        // Overlapping ranges requested earlier that this one must wait
+        // for. The range is locked once this reaches zero.
+        unsigned long num_blockers;
+        std::condition_variable granted;
+    } range_rwlock_range_t;
+
+    // Read-write lock over byte ranges [offset, offset + length) of
+    // something large, such as a memory-mapped file. Ranges that do not
+    // overlap never wait for each other; where ranges overlap, the rules
+    // of rwlock_t apply to them.
+    //
+    // Every range, locked or waiting, is kept in a map ordered by start,
+    // and waits for the overlapping ranges requested before it that it
+    // conflicts with: a reader waits for earlier writers, and a writer
+    // waits for everything earlier. So a reader never gets past a writer
+    // that is waiting for an overlapping range, which is the writer bias
+    // of rwlock_t applied to each overlap, and no range waits forever.
+    //
+    // A range can only overlap entries that start less than the longest
+    // current length before it, so each lock and unlock visits the entries
+    // in that window of the map. One long range widens the window for
+    // every other range, but only for as long as it is held.
+    typedef struct range_rwlock_t {
+        // Protects everything below and every range in ranges.
+        std::mutex *mutex;
+        std::multimap<uint64_t, range_rwlock_range_t *> *ranges;
+        // Length of every range in ranges. The largest bounds how far
+        // before a range an overlapping one may start.
+        std::multiset<uint64_t> *lengths;
+        uint64_t next_sequence;
+    } range_rwlock_t;
+
+    void range_rwlock_init(range_rwlock_t *);
+    void range_rwlock_uninit(range_rwlock_t *);
+
+    // length must not be zero, and offset + length must not overflow.
+    // Either throws std::invalid_argument without locking anything.
+    void range_rwlock_lock_rd(range_rwlock_t *, range_rwlock_range_t *,
+                              uint64_t offset, uint64_t length);
+    void range_rwlock_unlock_rd(range_rwlock_t *, range_rwlock_range_t *);
+    void range_rwlock_lock_wr(range_rwlock_t *, range_rwlock_range_t *,
+                              uint64_t offset, uint64_t length);
+    void range_rwlock_unlock_wr(range_rwlock_t *, range_rwlock_range_t *);
+}
+
+#endif // SIMPLE_RWLOCK_RANGE_H
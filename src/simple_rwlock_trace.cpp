@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <simple_rwlock_trace.h>
+
+namespace simple_rwlock {
+    std::atomic<unsigned int> rwlock_instrumentation(0);
+
+    namespace {
+        const char trace_magic[8] = { 'S', 'R', 'W', 'T', 'R', 'A', 'C', 'E' };
+        // Version 2 widened lock_id from 16 to 32 bits, and version 3
+        // widened wait_ns and hold_ns from 32 to 64 bits.
+        const uint32_t trace_version = 3;
+
+        typedef struct trace_file_header_t {
+            char magic[8];
+            uint32_t version;
+            uint32_t record_size;
+            uint64_t num_records;
+        } trace_file_header_t;
+
+        // Maximum number of locks one thread may hold at once and
+        // still have its sections recorded.
+        const unsigned int max_open_sections = 16;
+
+        typedef struct open_section_t {
+            const void *rwlock;
+            uint64_t call_ns;
+            uint64_t acquired_ns;
+            uint8_t kind;
+        } open_section_t;
+
+        // Records made by one thread. The thread appends with the mutex
+        // held, which is only contended while a trace is starting or
+        // stopping. Buffers are never freed, so a thread's pointer to its
+        // buffer stays valid across traces.
+        typedef struct thread_buffer_t {
+            std::mutex mutex;
+            std::vector<rwlock_trace_record_t> records;
+        } thread_buffer_t;
+
+        // State of the current trace, protected by trace_mutex.
+        std::mutex trace_mutex;
+        std::vector<thread_buffer_t *> thread_buffers;
+        std::unordered_map<const void *, uint32_t> lock_ids;
+        uint32_t next_thread_id = 0;
+        // Incremented by every rwlock_trace_start, so that threads
+        // renumber themselves and forget their cached lock ids.
+        std::atomic<unsigned long> trace_generation(0);
+        std::atomic<uint64_t> trace_start_ns(0);
+
+        typedef struct thread_state_t {
+            thread_buffer_t *buffer;
+            unsigned long generation;
+            uint32_t thread_id;
+            // Last lock looked up, to skip the shared map in loops.
+            const void *cached_rwlock;
+            uint32_t cached_lock_id;
+            unsigned int num_open_sections;
+            open_section_t open_sections[max_open_sections];
+        } thread_state_t;
+
+        thread_local thread_state_t thread_state = {
+            nullptr, 0, 0, nullptr, 0, 0, {}
+        };
+
+        // Make sure this thread has a buffer and an id in the current
+        // trace. Return false if no trace is running.
+        bool join_trace(thread_state_t &state) {
+            unsigned long generation =
+                trace_generation.load(std::memory_order_acquire);
+            if (state.buffer != nullptr && state.generation == generation) {
+                return true;
+            }
+            std::lock_guard<std::mutex> guard(trace_mutex);
+            if (!rwlock_trace_enabled()) {
+                return false;
+            }
+            if (state.buffer == nullptr) {
+                state.buffer = new thread_buffer_t;
+                thread_buffers.push_back(state.buffer);
+            }
+            state.generation = trace_generation.load();
+            state.thread_id = next_thread_id++;
+            state.cached_rwlock = nullptr;
+            state.num_open_sections = 0;
+            return true;
+        }
+
+        uint32_t lock_id(thread_state_t &state, const void *rwlock) {
+            if (state.cached_rwlock == rwlock) {
+                return state.cached_lock_id;
+            }
+            uint32_t id;
+            {
+                std::lock_guard<std::mutex> guard(trace_mutex);
+                auto found = lock_ids.find(rwlock);
+                if (found == lock_ids.end()) {
+                    id = (uint32_t)lock_ids.size();
+                    lock_ids[rwlock] = id;
+                } else {
+                    id = found->second;
+                }
+            }
+            state.cached_rwlock = rwlock;
+            state.cached_lock_id = id;
+            return id;
+        }
+    }
+
+    uint64_t rwlock_trace_now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void rwlock_trace_record_acquired(const void *rwlock, uint8_t kind,
+                                      uint64_t call_ns)
+    {
+        thread_state_t &state = thread_state;
+        if (!join_trace(state) ||
+            state.num_open_sections == max_open_sections) {
+            return;
+        }
+        open_section_t &section =
+            state.open_sections[state.num_open_sections++];
+        section.rwlock = rwlock;
+        section.call_ns = call_ns;
+        section.acquired_ns = rwlock_trace_now_ns();
+        section.kind = kind;
+    }
+
+    void rwlock_trace_record_unlock(const void *rwlock) {
+        uint64_t unlock_ns = rwlock_trace_now_ns();
+        thread_state_t &state = thread_state;
+        if (state.buffer == nullptr ||
+            state.generation != trace_generation.load()) {
+            return;
+        }
+        // Sections are usually released in the reverse of the order they
+        // were acquired in, so search from the most recent.
+        unsigned int i = state.num_open_sections;
+        while (i > 0 && state.open_sections[i - 1].rwlock != rwlock) {
+            i--;
+        }
+        if (i == 0) {
+            // Acquired before the trace started, or not recorded.
+            return;
+        }
+        open_section_t section = state.open_sections[i - 1];
+        std::copy(state.open_sections + i,
+                  state.open_sections + state.num_open_sections,
+                  state.open_sections + i - 1);
+        state.num_open_sections--;
+
+        uint64_t start_ns = trace_start_ns.load(std::memory_order_relaxed);
+        rwlock_trace_record_t record;
+        record.call_ns = (section.call_ns > start_ns)
+            ? section.call_ns - start_ns : 0;
+        record.wait_ns = section.acquired_ns - section.call_ns;
+        record.hold_ns = unlock_ns - section.acquired_ns;
+        record.thread_id = state.thread_id;
+        record.lock_id = lock_id(state, rwlock);
+        record.kind = section.kind;
+        memset(record.reserved, 0, sizeof(record.reserved));
+        std::lock_guard<std::mutex> guard(state.buffer->mutex);
+        if (rwlock_trace_enabled()) {
+            state.buffer->records.push_back(record);
+        }
+    }
+
+    void rwlock_trace_start() {
+        std::lock_guard<std::mutex> guard(trace_mutex);
+        for (auto buffer : thread_buffers) {
+            std::lock_guard<std::mutex> buffer_guard(buffer->mutex);
+            buffer->records.clear();
+        }
+        lock_ids.clear();
+        next_thread_id = 0;
+        trace_start_ns.store(rwlock_trace_now_ns());
+        trace_generation.fetch_add(1, std::memory_order_release);
+        rwlock_instrumentation.fetch_or(rwlock_instrument_trace);
+    }
+
+    bool rwlock_trace_stop(const std::string &path) {
+        std::vector<rwlock_trace_record_t> records;
+        {
+            std::lock_guard<std::mutex> guard(trace_mutex);
+            rwlock_instrumentation.fetch_and(~rwlock_instrument_trace);
+            for (auto buffer : thread_buffers) {
+                std::lock_guard<std::mutex> buffer_guard(buffer->mutex);
+                records.insert(records.end(), buffer->records.begin(),
+                               buffer->records.end());
+                buffer->records.clear();
+            }
+        }
+        std::sort(records.begin(), records.end(),
+                  [](const rwlock_trace_record_t &a,
+                     const rwlock_trace_record_t &b) {
+                      return a.call_ns < b.call_ns;
+                  });
+
+        trace_file_header_t header;
+        memcpy(header.magic, trace_magic, sizeof(header.magic));
+        header.version = trace_version;
+        header.record_size = sizeof(rwlock_trace_record_t);
+        header.num_records = records.size();
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write((const char *)&header, sizeof(header));
+        file.write((const char *)records.data(),
+                   records.size() * sizeof(rwlock_trace_record_t));
+        return file.good();
+    }
+
+    bool rwlock_trace_read(const std::string &path,
+                           std::vector<rwlock_trace_record_t> *records)
+    {
+        records->clear();
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        std::streamoff file_size = file.tellg();
+        trace_file_header_t header;
+        if (!file.seekg(0) || !file.read((char *)&header, sizeof(header)) ||
+            memcmp(header.magic, trace_magic, sizeof(header.magic)) != 0 ||
+            header.version != trace_version ||
+            header.record_size != sizeof(rwlock_trace_record_t)) {
+            return false;
+        }
+        // Check the count against the file before allocating for it, so
+        // that a corrupt header cannot ask for more than the file holds.
+        uint64_t max_records = (uint64_t)(file_size - sizeof(header)) /
+            sizeof(rwlock_trace_record_t);
+        if (header.num_records > max_records) {
+            return false;
+        }
+        records->resize(header.num_records);
+        if (!file.read((char *)records->data(),
+                       header.num_records * sizeof(rwlock_trace_record_t))) {
+            records->clear();
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,95 @@
+#ifndef SIMPLE_RWLOCK_TRACE_H
+#define SIMPLE_RWLOCK_TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace simple_rwlock {
+    // Recording of the critical sections of every rwlock_t in a program,
+    // for replaying the same traffic against other locks offline.
+    //
+    // Call rwlock_trace_start() to begin recording and rwlock_trace_stop()
+    // to write what was recorded to a file. While recording, each
+    // rwlock_lock_rd/rwlock_lock_wr and its matching unlock produce one
+    // record. While neither recording nor profiling, the rwlock_t
+    // functions only pay for one relaxed atomic load.
+
+    const uint8_t rwlock_trace_kind_read = 0;
+    const uint8_t rwlock_trace_kind_write = 1;
+
+    // One critical section. Threads and locks are numbered from 0 in the
+    // order they first appear in the trace.
+    typedef struct rwlock_trace_record_t {
+        // Nanoseconds from rwlock_trace_start() to the lock call.
+        uint64_t call_ns;
+        // Nanoseconds from the lock call until access was acquired.
+        uint64_t wait_ns;
+        // Nanoseconds from acquiring access until the unlock call.
+        uint64_t hold_ns;
+        uint32_t thread_id;
+        uint32_t lock_id;
+        // rwlock_trace_kind_read or rwlock_trace_kind_write.
+        uint8_t kind;
+        uint8_t reserved[7];
+    } rwlock_trace_record_t;
+
+    // Discard anything recorded before and start recording.
+    void rwlock_trace_start();
+
+    // Stop recording and write the records, ordered by call_ns, to path.
+    // Sections still held when recording stops are left out. Return
+    // false if the file could not be written.
+    bool rwlock_trace_stop(const std::string &path);
+
+    // Read a file written by rwlock_trace_stop. Return false, with records
+    // empty, if the file could not be read, is not a trace, or is shorter
+    // than its header says.
+    bool rwlock_trace_read(const std::string &path,
+                           std::vector<rwlock_trace_record_t> *records);
+
+    // Bits of rwlock_instrumentation, one for each kind of instrumentation
+    // that is on. The rwlock_t functions load it once per call and take
+    // the plain path when it is 0.
+    const unsigned int rwlock_instrument_trace = 1;
+    const unsigned int rwlock_instrument_profile = 2;
+    extern std::atomic<unsigned int> rwlock_instrumentation;
+
+    // Called by the rwlock_t functions with the value they loaded from
+    // rwlock_instrumentation. rwlock_trace_lock_call returns 0 when not
+    // recording, and otherwise a timestamp to pass to
+    // rwlock_trace_lock_acquired once access is acquired.
+    uint64_t rwlock_trace_now_ns();
+    void rwlock_trace_record_acquired(const void *rwlock, uint8_t kind,
+                                      uint64_t call_ns);
+    void rwlock_trace_record_unlock(const void *rwlock);
+
+    inline bool rwlock_trace_enabled() {
+        return (rwlock_instrumentation.load(std::memory_order_relaxed) &
+                rwlock_instrument_trace) != 0;
+    }
+
+    inline uint64_t rwlock_trace_lock_call(unsigned int instrumentation) {
+        if ((instrumentation & rwlock_instrument_trace) == 0) {
+            return 0;
+        }
+        return rwlock_trace_now_ns();
+    }
+
+    inline void rwlock_trace_lock_acquired(const void *rwlock, uint8_t kind,
+                                           uint64_t call_ns)
+    {
+        if (call_ns != 0) {
+            rwlock_trace_record_acquired(rwlock, kind, call_ns);
+        }
+    }
+
+    inline void rwlock_trace_unlock_call(const void *rwlock) {
+        if (rwlock_trace_enabled()) {
+            rwlock_trace_record_unlock(rwlock);
+        }
+    }
+}
+
+#endif // SIMPLE_RWLOCK_TRACE_H
@@ -0,0 +1,209 @@
+#ifndef SIMPLE_RWLOCK_VERSIONED_H
+#define SIMPLE_RWLOCK_VERSIONED_H
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace simple_rwlock {
+    // Container for read-mostly values that replaces the pattern of
+    // rwlock_lock_rd, copying a struct, then rwlock_unlock_rd.
+    //
+    // Readers call snapshot() and get a reference-counted pointer to an
+    // immutable version of the value, without copying it. Writers build a
+    // complete new value, outside of any lock, and swap it in; a version
+    // is freed when the last snapshot of it is dropped. Concurrent writers
+    // using update() retry on the newer value rather than waiting for each
+    // other to build theirs.
+    //
+    // Publication is lock-free, using split reference counts. The current
+    // version is one 64-bit atomic word holding the version's address in
+    // its low 48 bits and, in its high 16 bits, the number of readers that
+    // are between loading the word and taking a reference of their own. A
+    // reader increments that count with the same fetch_add that loads the
+    // address, so the version cannot be freed before the reader has
+    // incremented its reference count, and then takes its increment back
+    // out of the word. A writer that swaps the version out moves the count
+    // left in the word onto the old version's reference count, and those
+    // readers take their increment back out of that instead. No step waits
+    // for another thread, but readers of the same version still contend on
+    // the word and on the version's reference count.
+    //
+    // This relies on user-space addresses fitting in 48 bits, as they do
+    // on x86-64 and on AArch64 Linux unless a program asks mmap for higher
+    // ones, and on fewer than 65536 threads taking snapshots at once.
+    template <typename T>
+    class versioned {
+        typedef struct node_t {
+            template <typename... Args>
+            explicit node_t(Args &&...args) :
+                value(std::forward<Args>(args)...),
+                num_refs(1)
+            { }
+
+            const T value;
+            // Snapshots of this version, plus one while it is current.
+            std::atomic<long> num_refs;
+        } node_t;
+
+        static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                      "versioned needs lock-free 64-bit atomics");
+        static constexpr int address_bits = 48;
+        static constexpr uint64_t address_mask =
+            (uint64_t(1) << address_bits) - 1;
+        static constexpr uint64_t one_reader = uint64_t(1) << address_bits;
+
+        static node_t *node_of(uint64_t word) {
+            return (node_t *)(uintptr_t)(word & address_mask);
+        }
+
+        static uint64_t num_readers_of(uint64_t word) {
+            return word >> address_bits;
+        }
+
+        // Drop n references, and free the version with the last one.
+        static void release(node_t *node, long n) {
+            if (node->num_refs.fetch_sub(n, std::memory_order_acq_rel) == n) {
+                delete node;
+            }
+        }
+
+        static uint64_t make_node(T &&value) {
+            node_t *node = new node_t(std::move(value));
+            uint64_t word = (uint64_t)(uintptr_t)node;
+            if ((word & ~address_mask) != 0) {
+                // Memory the word cannot address is as good as none.
+                delete node;
+                throw std::bad_alloc();
+            }
+            return word;
+        }
+
+        // Give up the reference that the current_ word held to the version
+        // in old_word, and hand its reader count over to the version.
+        static void retire(uint64_t old_word) {
+            release(node_of(old_word), 1 - (long)num_readers_of(old_word));
+        }
+
+    public:
+        // Shared, read-only handle to one version of the value.
+        class snapshot_t {
+        public:
+            snapshot_t() : node_(nullptr) { }
+            snapshot_t(const snapshot_t &other) : node_(other.node_) {
+                if (node_ != nullptr) {
+                    node_->num_refs.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            snapshot_t(snapshot_t &&other) : node_(other.node_) {
+                other.node_ = nullptr;
+            }
+            snapshot_t &operator=(snapshot_t other) {
+                std::swap(node_, other.node_);
+                return *this;
+            }
+            ~snapshot_t() { reset(); }
+
+            void reset() {
+                if (node_ != nullptr) {
+                    release(node_, 1);
+                    node_ = nullptr;
+                }
+            }
+            const T *get() const { return &node_->value; }
+            const T &operator*() const { return node_->value; }
+            const T *operator->() const { return &node_->value; }
+            explicit operator bool() const { return node_ != nullptr; }
+
+        private:
+            friend class versioned;
+
+            // Takes over a reference the caller already holds.
+            explicit snapshot_t(node_t *node) : node_(node) { }
+
+            node_t *node_;
+        };
+
+        explicit versioned(T initial_value) :
+            current_(make_node(std::move(initial_value))),
+            version_(0)
+        { }
+
+        ~versioned() {
+            retire(current_.load(std::memory_order_acquire));
+        }
+
+        versioned(const versioned &) = delete;
+        versioned &operator=(const versioned &) = delete;
+
+        // Return the current version of the value.
+        snapshot_t snapshot() const {
+            uint64_t word = current_.fetch_add(one_reader,
+                                               std::memory_order_acquire);
+            node_t *node = node_of(word);
+            node->num_refs.fetch_add(1, std::memory_order_relaxed);
+            // Take this reader's count back out of the word. If a writer
+            // has swapped the version out meanwhile, it moved the count
+            // onto num_refs, so take it out of there instead; the reference
+            // taken above keeps that from being the last one.
+            word += one_reader;
+            while (!current_.compare_exchange_weak(
+                       word, word - one_reader, std::memory_order_release,
+                       std::memory_order_relaxed)) {
+                if (node_of(word) != node) {
+                    node->num_refs.fetch_sub(1, std::memory_order_relaxed);
+                    break;
+                }
+            }
+            return snapshot_t(node);
+        }
+
+        // Replace the value, regardless of what it currently is.
+        void publish(T new_value) {
+            uint64_t new_word = make_node(std::move(new_value));
+            retire(current_.exchange(new_word, std::memory_order_acq_rel));
+            version_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Replace the value with function(current value). If another writer
+        // publishes first, function is called again on the newer value, so
+        // it must not have side effects beyond building the new value.
+        template <typename Function>
+        void update(Function &&function) {
+            while (true) {
+                snapshot_t expected = snapshot();
+                uint64_t new_word = make_node(function(*expected));
+                uint64_t word = current_.load(std::memory_order_relaxed);
+                // Readers coming and going change the word without
+                // changing the version, so only give up once the version
+                // itself has changed.
+                while (node_of(word) == expected.node_) {
+                    if (current_.compare_exchange_weak(
+                            word, new_word, std::memory_order_acq_rel,
+                            std::memory_order_relaxed)) {
+                        retire(word);
+                        version_.fetch_add(1, std::memory_order_relaxed);
+                        return;
+                    }
+                }
+                release(node_of(new_word), 1);
+            }
+        }
+
+        // Number of values published since construction. The count is
+        // incremented after the new value is swapped in, so it can lag
+        // behind snapshot(): a reader may see a new value while version()
+        // still returns the number from before it was published.
+        unsigned long version() const {
+            return version_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        // Mutable because snapshot() counts itself in while it loads.
+        mutable std::atomic<uint64_t> current_;
+        std::atomic<unsigned long> version_;
+    };
+}
+
+#endif // SIMPLE_RWLOCK_VERSIONED_H
@@ -1,7 +1,11 @@
 #include <simple_rwlock.h>
 #include <simple_rwlock_test/tester.h>
 
-int main() {
+int main(int argc, char *argv[]) {
+    simple_rwlock_test::tester_options_t options;
+    if (!simple_rwlock_test::Tester::parse_options(argc, argv, options)) {
+        return 2;
+    }
     simple_rwlock_test::Tester tester;
-    return tester.run_tests();
+    return tester.run_tests(options);
 }
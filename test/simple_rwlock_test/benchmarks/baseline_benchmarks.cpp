@@ -0,0 +1,203 @@
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <simple_rwlock_test/clock.h>
+#include <simple_rwlock_test/cycle_clock.h>
+#include <simple_rwlock_test/histogram.h>
+#include <simple_rwlock_test/perf_counters.h>
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/benchmarks/bench_common.h>
+#include <simple_rwlock_test/benchmarks/lock_adapters.h>
+#include <simple_rwlock_test/benchmarks/baseline_benchmarks.h>
+
+namespace simple_rwlock_test {
+    using namespace bench_common;
+    using namespace lock_adapters;
+
+    namespace bench_baseline_comparison {
+        struct workload_t {
+            const char *name;
+            // Every writes_every-th operation is a write, or none if 0.
+            unsigned long writes_every;
+            unsigned int num_threads;
+        };
+
+        const workload_t workloads[] = {
+            { "read-only x1", 0, 1 },
+            { "read-only x4", 0, 4 },
+            { "15:1 x1", 16, 1 },
+            { "15:1 x4", 16, 4 },
+            { "1:1 x4", 2, 4 },
+        };
+        const unsigned int num_workloads =
+            sizeof(workloads) / sizeof(workloads[0]);
+
+        // Summary of one workload run against one lock.
+        struct result_t {
+            double million_ops_per_second;
+            double read_p50_ns;
+            double read_p99_ns;
+            double write_p99_ns;
+        };
+
+        struct lock_results_t {
+            std::string lock_name;
+            result_t results[num_workloads];
+        };
+
+        // Time taken to acquire each kind of access by one thread.
+        struct thread_histograms_t {
+            Histogram wait_rd;
+            Histogram wait_wr;
+        };
+
+        template <typename Adapter>
+        void worker_thread(Adapter *lock,                   // Shared
+                           unsigned long *data,             // Shared
+                           unsigned long writes_every,      // Not shared
+                           thread_histograms_t *histograms) // Not shared
+        {
+            unsigned long sink = 0;
+            for (unsigned long i = 0; i < bench_iterations; i++) {
+                CycleClock::clk_ticks_t start = CycleClock::start_ticks();
+                if (writes_every != 0 && i % writes_every == 0) {
+                    lock->lock_wr();
+                    histograms->wait_wr.record(CycleClock::elapsed_ticks(
+                        start, CycleClock::stop_ticks()));
+                    *data = *data + 1;
+                    lock->unlock_wr();
+                } else {
+                    lock->lock_rd();
+                    histograms->wait_rd.record(CycleClock::elapsed_ticks(
+                        start, CycleClock::stop_ticks()));
+                    sink += *data;
+                    lock->unlock_rd();
+                }
+            }
+            (void)sink;
+        }
+
+        template <typename Adapter>
+        result_t run_workload(const workload_t &workload) {
+            Adapter lock;
+            unsigned long data = 0;
+            lock.init();
+            std::vector<thread_histograms_t> histograms(workload.num_threads);
+            std::string variant_name =
+                std::string(Adapter::name()) + ", " + workload.name;
+            std::vector<int> cpus = place_threads(
+                "bench_baseline_comparison", variant_name,
+                workload.num_threads);
+            PerfCounters counters(perf_counters_enabled);
+            counters.start();
+            Clock workload_clock;
+            std::vector<std::thread> threads;
+            for (unsigned int i = 0; i < workload.num_threads; i++) {
+                threads.push_back(start_thread(cpus, i, worker_thread<Adapter>,
+                                               &lock, &data,
+                                               workload.writes_every,
+                                               &histograms[i]));
+            }
+            for (auto &thread : threads) {
+                thread.join();
+            }
+            Clock::clk_latency_t latency = workload_clock.latency_from_start();
+            counters.stop();
+            lock.uninit();
+
+            Histogram wait_rd;
+            Histogram wait_wr;
+            for (const auto &thread_histograms : histograms) {
+                wait_rd.merge(thread_histograms.wait_rd);
+                wait_wr.merge(thread_histograms.wait_wr);
+            }
+            unsigned long num_ops = workload.num_threads * bench_iterations;
+            print_perf_counters("bench_baseline_comparison", variant_name,
+                                num_ops, counters);
+            export_histogram("bench_baseline_comparison", variant_name,
+                             "read wait", wait_rd);
+            export_histogram("bench_baseline_comparison", variant_name,
+                             "write wait", wait_wr);
+
+            result_t result;
+            result.million_ops_per_second =
+                (latency > 0) ? num_ops * 1.0 / latency : 0.0;
+            result.read_p50_ns = CycleClock::ticks_to_nanoseconds(
+                wait_rd.value_at_percentile(50.0));
+            result.read_p99_ns = CycleClock::ticks_to_nanoseconds(
+                wait_rd.value_at_percentile(99.0));
+            result.write_p99_ns = (wait_wr.count() == 0) ? -1.0 :
+                CycleClock::ticks_to_nanoseconds(
+                    wait_wr.value_at_percentile(99.0));
+            return result;
+        }
+
+        template <typename Adapter>
+        lock_results_t run_lock() {
+            lock_results_t lock_results;
+            lock_results.lock_name = Adapter::name();
+            for (unsigned int i = 0; i < num_workloads; i++) {
+                lock_results.results[i] = run_workload<Adapter>(workloads[i]);
+            }
+            return lock_results;
+        }
+
+        // Print one table with a row per lock and a column per workload.
+        // Negative values are printed as "-".
+        void print_table(const std::string &title,
+                         const std::vector<lock_results_t> &all_results,
+                         double result_t::*field)
+        {
+            const int name_width = 32;
+            const int column_width = 14;
+            std::stringstream print_stream;
+            print_stream << std::endl << "bench_baseline_comparison: "
+                << title << std::endl << std::setw(name_width) << std::left
+                << "lock" << std::right;
+            for (unsigned int i = 0; i < num_workloads; i++) {
+                print_stream << std::setw(column_width) << workloads[i].name;
+            }
+            print_stream << std::endl;
+            for (const auto &lock_results : all_results) {
+                print_stream << std::setw(name_width) << std::left
+                    << lock_results.lock_name << std::right;
+                for (unsigned int i = 0; i < num_workloads; i++) {
+                    double value = lock_results.results[i].*field;
+                    print_stream << std::setw(column_width);
+                    if (value < 0.0) {
+                        print_stream << "-";
+                    } else {
+                        print_stream << std::setprecision(4) << value;
+                    }
+                }
+                print_stream << std::endl;
+            }
+            std::cout << print_stream.str();
+        }
+    }
+    BenchBaselineComparison::BenchBaselineComparison(Clock &tester_clock) :
+        Test("bench_baseline_comparison", tester_clock)
+    { }
+    int BenchBaselineComparison::run_test_body() {
+        using namespace bench_baseline_comparison;
+        std::vector<lock_results_t> all_results;
+        all_results.push_back(run_lock<rwlock_adapter>());
+        all_results.push_back(run_lock<compact_rwlock_adapter>());
+        all_results.push_back(run_lock<pthread_reader_pref_adapter>());
+        all_results.push_back(run_lock<pthread_writer_pref_adapter>());
+        all_results.push_back(run_lock<shared_mutex_adapter>());
+        print_table("throughput (million operations per second)",
+                    all_results, &result_t::million_ops_per_second);
+        print_table("p50 read acquire (nanoseconds)", all_results,
+                    &result_t::read_p50_ns);
+        print_table("p99 read acquire (nanoseconds)", all_results,
+                    &result_t::read_p99_ns);
+        print_table("p99 write acquire (nanoseconds)", all_results,
+                    &result_t::write_p99_ns);
+        return 0;
+    }
+}
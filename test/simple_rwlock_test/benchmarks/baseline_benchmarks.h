@@ -0,0 +1,19 @@
+#ifndef SRWLT_BENCH_BASELINE_H
+#define SRWLT_BENCH_BASELINE_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // bench_baseline_comparison: Run the same read-only, read-mostly and
+    // balanced workloads on 1 and 4 threads against rwlock_t,
+    // compact_rwlock_t, pthread_rwlock_t with reader preference and with
+    // writer preference, and std::shared_mutex. Print side-by-side tables
+    // of throughput and of the time taken to acquire read and write access.
+    class BenchBaselineComparison : public Test {
+    public:
+        BenchBaselineComparison(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_BENCH_BASELINE_H
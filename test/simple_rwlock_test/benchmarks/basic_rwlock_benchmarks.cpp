@@ -0,0 +1,186 @@
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <simple_rwlock.h>
+#include <simple_rwlock_basic.h>
+#include <simple_rwlock_basic_impl.h>
+#include <simple_rwlock_test/clock.h>
+#include <simple_rwlock_test/perf_counters.h>
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/benchmarks/bench_common.h>
+#include <simple_rwlock_test/benchmarks/lock_adapters.h>
+#include <simple_rwlock_test/benchmarks/basic_rwlock_benchmarks.h>
+
+namespace simple_rwlock_test {
+    using namespace simple_rwlock;
+    using namespace bench_common;
+
+    namespace bench_basic_rwlock_configurations {
+        const unsigned long writes_every = 16;
+
+        // The rwlock_t algorithm written out by hand, with the layout,
+        // bias and waiting of rwlock_t and nothing else.
+        struct handwritten_rwlock_t {
+            std::mutex *write_or_any_read_mutex;
+            long num_active_writers;
+            std::mutex *num_active_writers_mutex;
+            std::mutex *any_active_writers_mutex;
+            long num_active_readers;
+            std::mutex *num_active_readers_mutex;
+
+            void init() {
+                num_active_readers = 0;
+                num_active_writers = 0;
+                write_or_any_read_mutex = new std::mutex;
+                num_active_writers_mutex = new std::mutex;
+                any_active_writers_mutex = new std::mutex;
+                num_active_readers_mutex = new std::mutex;
+            }
+
+            void uninit() {
+                delete write_or_any_read_mutex;
+                delete num_active_writers_mutex;
+                delete any_active_writers_mutex;
+                delete num_active_readers_mutex;
+            }
+
+            void lock_rd() {
+                any_active_writers_mutex->lock();
+                num_active_readers_mutex->lock();
+                if (num_active_readers == 0) {
+                    write_or_any_read_mutex->lock();
+                }
+                num_active_readers++;
+                num_active_readers_mutex->unlock();
+                any_active_writers_mutex->unlock();
+            }
+
+            void unlock_rd() {
+                num_active_readers_mutex->lock();
+                num_active_readers--;
+                if (num_active_readers == 0) {
+                    write_or_any_read_mutex->unlock();
+                }
+                num_active_readers_mutex->unlock();
+            }
+
+            void lock_wr() {
+                num_active_writers_mutex->lock();
+                if (num_active_writers == 0) {
+                    any_active_writers_mutex->lock();
+                }
+                num_active_writers++;
+                num_active_writers_mutex->unlock();
+                write_or_any_read_mutex->lock();
+            }
+
+            void unlock_wr() {
+                write_or_any_read_mutex->unlock();
+                num_active_writers_mutex->lock();
+                num_active_writers--;
+                if (num_active_writers == 0) {
+                    any_active_writers_mutex->unlock();
+                }
+                num_active_writers_mutex->unlock();
+            }
+        };
+
+        // rwlock_t only differs from no_stats_t by the hook it calls
+        // before waiting, for the contention profiler.
+        typedef rwlock_t same_as_rwlock_t;
+        typedef basic_rwlock<writer_bias_policy, park_wait_policy,
+                             no_stats_policy, pointer_layout_policy>
+            no_stats_t;
+        typedef basic_rwlock<writer_bias_policy, park_wait_policy,
+                             no_stats_policy, inline_layout_policy>
+            inline_layout_t;
+        typedef basic_rwlock<writer_bias_policy, spin_then_park_wait_policy<>,
+                             no_stats_policy, pointer_layout_policy>
+            spin_then_park_t;
+        typedef basic_rwlock<writer_bias_policy, park_wait_policy,
+                             counting_stats_policy, pointer_layout_policy>
+            counting_stats_t;
+        typedef basic_rwlock<reader_bias_policy, park_wait_policy,
+                             no_stats_policy, pointer_layout_policy>
+            reader_bias_t;
+
+        template <typename lock_t>
+        void worker_thread(lock_t *rwlock,          // Shared
+                           unsigned long *data)     // Shared
+        {
+            unsigned long sink = 0;
+            for (unsigned long i = 0; i < bench_iterations; i++) {
+                if (i % writes_every == 0) {
+                    rwlock->lock_wr();
+                    *data = *data + 1;
+                    rwlock->unlock_wr();
+                } else {
+                    rwlock->lock_rd();
+                    sink += *data;
+                    rwlock->unlock_rd();
+                }
+            }
+            (void)sink;
+        }
+
+        template <typename lock_t>
+        void run_variant(std::string variant_name, unsigned int num_threads) {
+            lock_t rwlock;
+            unsigned long data = 0;
+            rwlock.init();
+            variant_name += ", " + std::to_string(num_threads) + " threads";
+            std::vector<int> cpus = place_threads(
+                "bench_basic_rwlock_configurations", variant_name,
+                num_threads);
+            PerfCounters counters(perf_counters_enabled);
+            counters.start();
+            Clock variant_clock;
+            std::vector<std::thread> threads;
+            for (unsigned int i = 0; i < num_threads; i++) {
+                threads.push_back(start_thread(cpus, i, worker_thread<lock_t>,
+                                               &rwlock, &data));
+            }
+            for (auto &thread : threads) {
+                thread.join();
+            }
+            Clock::clk_latency_t latency = variant_clock.latency_from_start();
+            counters.stop();
+            rwlock.uninit();
+            print_throughput("bench_basic_rwlock_configurations",
+                             variant_name, num_threads * bench_iterations,
+                             latency);
+            print_perf_counters("bench_basic_rwlock_configurations",
+                                variant_name, num_threads * bench_iterations,
+                                counters);
+        }
+
+        void run_all_variants(unsigned int num_threads) {
+            run_variant<handwritten_rwlock_t>("hand-written", num_threads);
+            run_variant<same_as_rwlock_t>("basic_rwlock as rwlock_t",
+                                          num_threads);
+            run_variant<no_stats_t>("no_stats_policy", num_threads);
+            // rwlock_t through the C API, which is compiled
+            // into the library instead of inlined here.
+            run_variant<lock_adapters::rwlock_adapter>("rwlock_t C API",
+                                                       num_threads);
+            run_variant<inline_layout_t>("inline_layout_policy", num_threads);
+            run_variant<spin_then_park_t>("spin_then_park_wait_policy",
+                                          num_threads);
+            run_variant<counting_stats_t>("counting_stats_policy",
+                                          num_threads);
+            run_variant<reader_bias_t>("reader_bias_policy", num_threads);
+        }
+    }
+    BenchBasicRwlockConfigurations::BenchBasicRwlockConfigurations(
+        Clock &tester_clock) :
+        Test("bench_basic_rwlock_configurations", tester_clock)
+    { }
+    int BenchBasicRwlockConfigurations::run_test_body() {
+        using namespace bench_basic_rwlock_configurations;
+        run_all_variants(1);
+        run_all_variants(4);
+        return 0;
+    }
+}
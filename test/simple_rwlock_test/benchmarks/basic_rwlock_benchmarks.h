@@ -0,0 +1,20 @@
+#ifndef SRWLT_BENCH_BASIC_RWLOCK_H
+#define SRWLT_BENCH_BASIC_RWLOCK_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // bench_basic_rwlock_configurations: Run the same mix of 15 reads to
+    // every write against a hand-written copy of the rwlock_t algorithm,
+    // against the basic_rwlock configuration that rwlock_t is built from,
+    // and against other basic_rwlock configurations, including the one
+    // rwlock_t would be without the profiler's wait hook. Each mix is run by
+    // one thread and then by 4 threads.
+    class BenchBasicRwlockConfigurations : public Test {
+    public:
+        BenchBasicRwlockConfigurations(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_BENCH_BASIC_RWLOCK_H
@@ -0,0 +1,212 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <simple_rwlock_test/clock.h>
+#include <simple_rwlock_test/cycle_clock.h>
+#include <simple_rwlock_test/histogram.h>
+#include <simple_rwlock_test/perf_counters.h>
+#include <simple_rwlock_test/topology.h>
+#include <simple_rwlock_test/benchmarks/bench_common.h>
+
+namespace simple_rwlock_test {
+    namespace bench_common {
+        std::string results_path;
+        bool perf_counters_enabled = false;
+        std::string replay_trace_path;
+        Topology::placement_t placement = Topology::placement_unpinned;
+
+        namespace {
+            // Placement of the variant that ran last, as JSON fields.
+            std::string placement_fields = "\"placement\": \"unpinned\"";
+
+            // Escape a string for use as a JSON string value.
+            std::string json_string(const std::string &value) {
+                std::string quoted = "\"";
+                for (char c : value) {
+                    if (c == '"' || c == '\\') {
+                        quoted += '\\';
+                    }
+                    quoted += c;
+                }
+                return quoted + "\"";
+            }
+        }
+
+        void print_histogram(std::string bench_name,
+                             std::string variant_name,
+                             std::string metric_name,
+                             const Histogram &histogram)
+        {
+            if (histogram.count() == 0) {
+                return;
+            }
+            std::stringstream print_stream;
+            print_stream << bench_name << " [" << variant_name << "]: "
+                << metric_name << ": ";
+            histogram.print_percentiles(print_stream);
+            std::cout << print_stream.str() << std::endl;
+            export_histogram(bench_name, variant_name, metric_name,
+                             histogram);
+        }
+
+        void print_throughput(std::string bench_name,
+                              std::string variant_name,
+                              unsigned long num_ops,
+                              Clock::clk_latency_t latency)
+        {
+            std::stringstream print_stream;
+            print_stream << bench_name << " [" << variant_name << "]: "
+                << num_ops << " operations in "
+                << Clock::latency_to_string(latency);
+            if (latency > 0) {
+                print_stream << " ("
+                    << (num_ops * 1000000.0 / latency)
+                    << " operations per second)";
+            }
+            std::cout << print_stream.str() << std::endl;
+        }
+
+        void print_op_stats(std::string bench_name,
+                            std::string variant_name,
+                            std::string op_name,
+                            const CycleClock::op_stats_t &stats)
+        {
+            std::stringstream print_stream;
+            print_stream << bench_name << " [" << variant_name << "]: "
+                << op_name << ": " << stats.num_ops << " timed, mean "
+                << stats.mean_nanoseconds() << " nanoseconds";
+            if (stats.num_ops > 0) {
+                print_stream << ", min "
+                    << CycleClock::ticks_to_nanoseconds(stats.min_ticks)
+                    << " nanoseconds";
+                if (CycleClock::uses_tsc()) {
+                    print_stream << " (mean "
+                        << (stats.total_ticks * 1.0 / stats.num_ops)
+                        << " cycles, min " << stats.min_ticks << " cycles)";
+                }
+            }
+            std::cout << print_stream.str() << std::endl;
+        }
+
+        void print_perf_counters(std::string bench_name,
+                                 std::string variant_name,
+                                 unsigned long num_ops,
+                                 const PerfCounters &counters)
+        {
+            if (!counters.enabled()) {
+                return;
+            }
+            std::stringstream print_stream;
+            print_stream << bench_name << " [" << variant_name << "]: ";
+            if (!counters.any_available()) {
+                print_stream << "no perf counters, "
+                    << counters.unavailable_reason();
+                std::cout << print_stream.str() << std::endl;
+                return;
+            }
+            std::stringstream fields;
+            fields << "\"bench\": " << json_string(bench_name)
+                << ", \"variant\": " << json_string(variant_name)
+                << ", \"metric\": \"perf counters per operation\""
+                << ", " << placement_fields
+                << ", \"num_ops\": " << num_ops;
+            print_stream << "per operation:";
+            for (int i = 0; i < PerfCounters::num_events; i++) {
+                PerfCounters::event_t event = (PerfCounters::event_t)i;
+                const char *name = PerfCounters::event_name(event);
+                print_stream << ((i == 0) ? " " : ", ") << name << " ";
+                if (!counters.available(event)) {
+                    print_stream << "n/a";
+                    continue;
+                }
+                double per_op = (num_ops > 0)
+                    ? counters.value(event) / num_ops : 0.0;
+                print_stream << per_op;
+                fields << ", " << json_string(name) << ": " << per_op;
+            }
+            std::cout << print_stream.str() << std::endl;
+            if (!results_path.empty()) {
+                std::ofstream results_file(results_path, std::ios::app);
+                results_file << "{" << fields.str() << "}" << std::endl;
+            }
+        }
+
+        void export_histogram(std::string bench_name,
+                              std::string variant_name,
+                              std::string metric_name,
+                              const Histogram &histogram)
+        {
+            if (results_path.empty()) {
+                return;
+            }
+            std::stringstream fields;
+            fields << "\"bench\": " << json_string(bench_name)
+                << ", \"variant\": " << json_string(variant_name)
+                << ", \"metric\": " << json_string(metric_name)
+                << ", " << placement_fields;
+            std::ofstream results_file(results_path, std::ios::app);
+            histogram.write_json(results_file, fields.str());
+            results_file << std::endl;
+        }
+
+        void print_lock_op_histograms(std::string bench_name,
+                                      std::string variant_name,
+                                      const lock_op_histograms_t &histograms)
+        {
+            print_histogram(bench_name, variant_name, "read wait",
+                            histograms.wait_rd);
+            print_histogram(bench_name, variant_name, "read hold",
+                            histograms.hold_rd);
+            print_histogram(bench_name, variant_name, "write wait",
+                            histograms.wait_wr);
+            print_histogram(bench_name, variant_name, "write hold",
+                            histograms.hold_wr);
+        }
+
+        std::vector<int> place_threads(std::string bench_name,
+                                       std::string variant_name,
+                                       unsigned int num_threads)
+        {
+            const Topology &topology = Topology::system();
+            std::vector<int> cpus;
+            if (!topology.place(placement, num_threads, &cpus)) {
+                std::cout << bench_name << " [" << variant_name
+                    << "]: placement " << Topology::placement_name(placement)
+                    << " is not possible on " << topology.summary()
+                    << ", threads are unpinned" << std::endl;
+                record_placement(bench_name, variant_name, "unpinned", cpus);
+                return cpus;
+            }
+            record_placement(bench_name, variant_name,
+                             Topology::placement_name(placement), cpus);
+            return cpus;
+        }
+
+        void record_placement(std::string bench_name,
+                              std::string variant_name,
+                              std::string placement_name,
+                              const std::vector<int> &cpus)
+        {
+            std::stringstream fields;
+            std::stringstream cpu_list;
+            fields << std::dec << "\"placement\": "
+                << json_string(placement_name) << ", \"cpus\": [";
+            cpu_list << std::dec;
+            for (unsigned int i = 0; i < cpus.size(); i++) {
+                fields << ((i == 0) ? "" : ", ") << cpus[i];
+                cpu_list << ((i == 0) ? "" : ",") << cpus[i];
+            }
+            fields << "], \"topology\": "
+                << json_string(Topology::system().summary());
+            placement_fields = fields.str();
+            if (cpus.empty()) {
+                return;
+            }
+            std::cout << bench_name << " [" << variant_name
+                << "]: placement " << placement_name << " on CPUs "
+                << cpu_list.str() << std::endl;
+        }
+    }
+}
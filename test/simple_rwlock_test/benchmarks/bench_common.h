@@ -0,0 +1,118 @@
+#ifndef SRWLT_BENCH_COMMON_H
+#define SRWLT_BENCH_COMMON_H
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <simple_rwlock_test/clock.h>
+#include <simple_rwlock_test/cycle_clock.h>
+#include <simple_rwlock_test/histogram.h>
+#include <simple_rwlock_test/perf_counters.h>
+#include <simple_rwlock_test/topology.h>
+
+namespace simple_rwlock_test {
+    namespace bench_common {
+#ifdef DEBUG
+        // Every lock call is logged in debug builds,
+        // so only do enough work to exercise the code.
+        const unsigned long bench_iterations = 200;
+#else
+        const unsigned long bench_iterations = 200000;
+#endif
+
+        // File that benchmark results are appended to as JSON lines,
+        // one object per histogram, or empty to only print them. Set
+        // from the command line before any benchmark runs.
+        extern std::string results_path;
+
+        // Whether benchmarks should count hardware and software events
+        // with PerfCounters. Set from the command line.
+        extern bool perf_counters_enabled;
+
+        // Trace written by rwlock_trace_stop for bench_trace_replay to
+        // replay, or empty to use a synthetic one. Set from the command
+        // line.
+        extern std::string replay_trace_path;
+
+        // Strategy for pinning benchmark threads to CPUs. Set from the
+        // command line.
+        extern Topology::placement_t placement;
+
+        // Choose a CPU for each of the num_threads threads of one variant
+        // of a benchmark with placement, report the choice, and record it
+        // so that results appended to results_path afterwards say where
+        // the threads ran. Return an empty list if threads are unpinned,
+        // including when placement is not possible on this machine.
+        std::vector<int> place_threads(std::string bench_name,
+                                       std::string variant_name,
+                                       unsigned int num_threads);
+
+        // Report and record a placement chosen by the benchmark itself
+        // rather than by place_threads.
+        void record_placement(std::string bench_name,
+                              std::string variant_name,
+                              std::string placement_name,
+                              const std::vector<int> &cpus);
+
+        // Start a thread running function(args...), pinned to the CPU
+        // that cpus gives for thread_index, or unpinned if cpus is empty.
+        template <typename Function, typename... Args>
+        std::thread start_thread(const std::vector<int> &cpus,
+                                 unsigned int thread_index,
+                                 Function function, Args... args)
+        {
+            int cpu = cpus.empty() ? -1 : cpus[thread_index % cpus.size()];
+            return std::thread([=]() {
+                if (cpu >= 0) {
+                    Topology::pin_to_cpu(cpu);
+                }
+                function(args...);
+            });
+        }
+
+        // Report the number of operations per second performed
+        // by one variant of a benchmark, along with the latency.
+        void print_throughput(std::string bench_name,
+                              std::string variant_name,
+                              unsigned long num_ops,
+                              Clock::clk_latency_t latency);
+
+        // Report the mean and minimum time of one kind of
+        // operation timed with CycleClock.
+        void print_op_stats(std::string bench_name,
+                            std::string variant_name,
+                            std::string op_name,
+                            const CycleClock::op_stats_t &stats);
+
+        // Report the events counted while one variant of a benchmark
+        // ran, divided by the number of lock operations it performed,
+        // and append them to results_path if it is set. Prints nothing
+        // if counting is not enabled.
+        void print_perf_counters(std::string bench_name,
+                                 std::string variant_name,
+                                 unsigned long num_ops,
+                                 const PerfCounters &counters);
+
+        // Append a histogram to results_path if it is set.
+        void export_histogram(std::string bench_name,
+                              std::string variant_name,
+                              std::string metric_name,
+                              const Histogram &histogram);
+
+        // Report the percentiles of a histogram, and append it to
+        // results_path if it is set. Prints nothing if it is empty.
+        void print_histogram(std::string bench_name,
+                             std::string variant_name,
+                             std::string metric_name,
+                             const Histogram &histogram);
+
+        // Report the percentiles of each histogram, and append
+        // them to results_path if it is set.
+        void print_lock_op_histograms(std::string bench_name,
+                                      std::string variant_name,
+                                      const lock_op_histograms_t &histograms);
+    } // End of bench_common namespace
+} // End of simple_rwlock_test namespace
+
+#endif // SRWLT_BENCH_COMMON_H
@@ -0,0 +1,299 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <simple_rwlock_test/clock.h>
+#include <simple_rwlock_test/cycle_clock.h>
+#include <simple_rwlock_test/histogram.h>
+#include <simple_rwlock_test/perf_counters.h>
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/benchmarks/bench_common.h>
+#include <simple_rwlock_test/benchmarks/lock_adapters.h>
+#include <simple_rwlock_test/benchmarks/cache_benchmarks.h>
+
+namespace simple_rwlock_test {
+    using namespace bench_common;
+    using namespace lock_adapters;
+
+    namespace bench_cache {
+        const unsigned int num_threads = 4;
+        const size_t cache_capacity = 4096;
+        // Skew of the hot keys. Rank r is looked up in proportion to
+        // 1 / (r + 1)^zipf_theta, as in YCSB.
+        const double zipf_theta = 0.99;
+        // Misses look up keys from a range this many times larger than
+        // the cache, so that they almost never hit.
+        const uint64_t cold_key_multiplier = 1000;
+
+        struct workload_t {
+            const char *name;
+            // Share of lookups that go to the hot keys, which all fit in
+            // the cache. The rest miss and fill the cache, evicting
+            // entries that were not recently used.
+            double hit_ratio;
+            // Share of operations that update an entry instead of looking
+            // one up.
+            double update_ratio;
+        };
+
+        const workload_t workloads[] = {
+            { "99% hits, 0.1% updates", 0.99, 0.001 },
+            { "99% hits, 5% updates", 0.99, 0.05 },
+            { "90% hits, 1% updates", 0.90, 0.01 },
+        };
+
+        typedef struct value_t {
+            uint64_t words[8];
+        } value_t;
+
+        // Cumulative probabilities of the ranks of a Zipfian distribution,
+        // shared read-only by every thread.
+        class ZipfTable {
+        public:
+            ZipfTable(size_t num_ranks, double theta) :
+                cdf_(num_ranks)
+            {
+                double sum = 0.0;
+                for (size_t i = 0; i < num_ranks; i++) {
+                    sum += 1.0 / std::pow((double)(i + 1), theta);
+                    cdf_[i] = sum;
+                }
+                for (auto &p : cdf_) {
+                    p /= sum;
+                }
+            }
+
+            // Rank for a uniform value in [0, 1).
+            uint64_t rank(double uniform) const {
+                auto found = std::upper_bound(cdf_.begin(), cdf_.end(),
+                                              uniform);
+                return std::min<size_t>(found - cdf_.begin(),
+                                        cdf_.size() - 1);
+            }
+
+        private:
+            std::vector<double> cdf_;
+        };
+
+        // Hash index over a fixed array of entries, evicting with the
+        // CLOCK approximation of least recently used. A hit only sets the
+        // entry's referenced flag, so lookups need nothing more than read
+        // access; fills and updates take write access.
+        template <typename Adapter>
+        class Cache {
+        public:
+            explicit Cache(size_t capacity) :
+                entries_(new entry_t[capacity]),
+                capacity_(capacity),
+                size_(0),
+                hand_(0)
+            {
+                index_.reserve(capacity * 2);
+                lock_.init();
+            }
+
+            ~Cache() { lock_.uninit(); }
+
+            bool get(uint64_t key, value_t *value) {
+                lock_.lock_rd();
+                auto found = index_.find(key);
+                bool hit = (found != index_.end());
+                if (hit) {
+                    entry_t &entry = entries_[found->second];
+                    entry.referenced.store(true, std::memory_order_relaxed);
+                    *value = entry.value;
+                }
+                lock_.unlock_rd();
+                return hit;
+            }
+
+            void put(uint64_t key, const value_t &value) {
+                lock_.lock_wr();
+                auto found = index_.find(key);
+                if (found != index_.end()) {
+                    entries_[found->second].value = value;
+                } else {
+                    size_t slot = evict();
+                    entries_[slot].key = key;
+                    entries_[slot].value = value;
+                    entries_[slot].referenced.store(
+                        false, std::memory_order_relaxed);
+                    index_[key] = slot;
+                }
+                lock_.unlock_wr();
+            }
+
+        private:
+            struct entry_t {
+                uint64_t key;
+                value_t value;
+                std::atomic<bool> referenced;
+            };
+
+            // Return a free slot, freeing the first entry the clock hand
+            // finds unreferenced if the cache is full. Requires write
+            // access.
+            size_t evict() {
+                if (size_ < capacity_) {
+                    return size_++;
+                }
+                while (entries_[hand_].referenced.load(
+                           std::memory_order_relaxed)) {
+                    entries_[hand_].referenced.store(
+                        false, std::memory_order_relaxed);
+                    hand_ = (hand_ + 1) % capacity_;
+                }
+                size_t slot = hand_;
+                hand_ = (hand_ + 1) % capacity_;
+                index_.erase(entries_[slot].key);
+                return slot;
+            }
+
+            std::unique_ptr<entry_t[]> entries_;
+            std::unordered_map<uint64_t, size_t> index_;
+            size_t capacity_;
+            size_t size_;
+            size_t hand_;
+            Adapter lock_;
+        };
+
+        struct thread_results_t {
+            Histogram get_latency;
+            Histogram put_latency;
+            unsigned long num_gets;
+            unsigned long num_hits;
+        };
+
+        value_t make_value(uint64_t key) {
+            value_t value;
+            for (unsigned int i = 0; i < 8; i++) {
+                value.words[i] = key + i;
+            }
+            return value;
+        }
+
+        template <typename Adapter>
+        void worker_thread(unsigned int thread_num,         // Not shared
+                           Cache<Adapter> *cache,           // Shared
+                           const ZipfTable *zipf,           // Shared
+                           const workload_t *workload,      // Shared
+                           thread_results_t *results)       // Not shared
+        {
+            std::mt19937_64 random(thread_num);
+            std::uniform_real_distribution<double> uniform(0.0, 1.0);
+            std::uniform_int_distribution<uint64_t> cold_keys(
+                cache_capacity, cache_capacity * cold_key_multiplier);
+            results->num_gets = 0;
+            results->num_hits = 0;
+            uint64_t sink = 0;
+            for (unsigned long i = 0; i < bench_iterations; i++) {
+                bool hot = uniform(random) < workload->hit_ratio;
+                uint64_t key = hot ? zipf->rank(uniform(random))
+                    : cold_keys(random);
+                CycleClock::clk_ticks_t start = CycleClock::start_ticks();
+                if (uniform(random) < workload->update_ratio) {
+                    cache->put(key, make_value(key + i));
+                    results->put_latency.record(CycleClock::elapsed_ticks(
+                        start, CycleClock::stop_ticks()));
+                    continue;
+                }
+                value_t value;
+                results->num_gets++;
+                if (cache->get(key, &value)) {
+                    results->num_hits++;
+                    sink += value.words[0];
+                } else {
+                    // Fill from the backing store.
+                    cache->put(key, make_value(key));
+                }
+                results->get_latency.record(CycleClock::elapsed_ticks(
+                    start, CycleClock::stop_ticks()));
+            }
+            (void)sink;
+        }
+
+        template <typename Adapter>
+        void run_workload(const workload_t &workload, const ZipfTable &zipf) {
+            Cache<Adapter> cache(cache_capacity);
+            // Start with every hot key cached.
+            for (uint64_t key = 0; key < cache_capacity; key++) {
+                cache.put(key, make_value(key));
+            }
+            std::string variant_name =
+                std::string(Adapter::name()) + ", " + workload.name;
+            std::vector<int> cpus = place_threads("bench_cache",
+                                                  variant_name, num_threads);
+            std::vector<thread_results_t> results(num_threads);
+            PerfCounters counters(perf_counters_enabled);
+            counters.start();
+            Clock workload_clock;
+            std::vector<std::thread> threads;
+            for (unsigned int i = 0; i < num_threads; i++) {
+                threads.push_back(start_thread(cpus, i, worker_thread<Adapter>,
+                                               i + 1, &cache, &zipf,
+                                               &workload, &results[i]));
+            }
+            for (auto &thread : threads) {
+                thread.join();
+            }
+            Clock::clk_latency_t latency = workload_clock.latency_from_start();
+            counters.stop();
+
+            Histogram get_latency;
+            Histogram put_latency;
+            unsigned long num_gets = 0;
+            unsigned long num_hits = 0;
+            for (const auto &thread_results : results) {
+                get_latency.merge(thread_results.get_latency);
+                put_latency.merge(thread_results.put_latency);
+                num_gets += thread_results.num_gets;
+                num_hits += thread_results.num_hits;
+            }
+            unsigned long num_ops = num_threads * bench_iterations;
+            print_throughput("bench_cache", variant_name, num_ops, latency);
+            std::stringstream print_stream;
+            print_stream << "bench_cache [" << variant_name << "]: "
+                << std::dec << num_hits << " hits in " << num_gets
+                << " lookups (" << std::setprecision(4)
+                << ((num_gets > 0) ? num_hits * 100.0 / num_gets : 0.0)
+                << "%)";
+            std::cout << print_stream.str() << std::endl;
+            print_perf_counters("bench_cache", variant_name, num_ops,
+                                counters);
+            print_histogram("bench_cache", variant_name, "lookup",
+                            get_latency);
+            print_histogram("bench_cache", variant_name, "update",
+                            put_latency);
+        }
+
+        template <typename Adapter>
+        void run_lock(const ZipfTable &zipf) {
+            for (const auto &workload : workloads) {
+                run_workload<Adapter>(workload, zipf);
+            }
+        }
+    }
+    BenchCache::BenchCache(Clock &tester_clock) :
+        Test("bench_cache", tester_clock)
+    { }
+    int BenchCache::run_test_body() {
+        using namespace bench_cache;
+        ZipfTable zipf(cache_capacity, zipf_theta);
+        run_lock<rwlock_adapter>(zipf);
+        run_lock<compact_rwlock_adapter>(zipf);
+        run_lock<pthread_reader_pref_adapter>(zipf);
+        run_lock<pthread_writer_pref_adapter>(zipf);
+        run_lock<shared_mutex_adapter>(zipf);
+        return 0;
+    }
+}
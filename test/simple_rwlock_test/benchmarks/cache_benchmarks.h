@@ -0,0 +1,21 @@
+#ifndef SRWLT_BENCH_CACHE_H
+#define SRWLT_BENCH_CACHE_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // bench_cache: Run a read-mostly key-value cache, a hash index over a
+    // fixed number of entries evicted in approximately least recently used
+    // order, under each lock in lock_adapters.h. 4 threads look up keys
+    // drawn from a Zipfian distribution, fill the cache on a miss, and
+    // update some entries, in several mixes of hit ratio and update rate.
+    // Print throughput, the hit ratio reached and the latency of lookups
+    // and updates.
+    class BenchCache : public Test {
+    public:
+        BenchCache(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_BENCH_CACHE_H
@@ -0,0 +1,119 @@
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <simple_rwlock.h>
+#include <simple_rwlock_combining.h>
+#include <simple_rwlock_test/clock.h>
+#include <simple_rwlock_test/perf_counters.h>
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/benchmarks/bench_common.h>
+#include <simple_rwlock_test/benchmarks/combining_benchmarks.h>
+
+namespace simple_rwlock_test {
+    using namespace simple_rwlock;
+    using namespace bench_common;
+
+    namespace bench_combining_many_writers {
+        const unsigned int num_writers = 16;
+        const unsigned int num_readers = 2;
+        const unsigned long writes_per_writer = bench_iterations / 4;
+
+        // Keep reading until the writers are done, so that
+        // every write has to wait for readers to drain.
+        void read_thread(combining_rwlock_t *rwlock,   // Shared
+                         unsigned long *data,          // Shared
+                         std::atomic<bool> *done)      // Shared
+        {
+            unsigned long sink = 0;
+            while (!done->load()) {
+                combining_rwlock_lock_rd(rwlock);
+                sink += *data;
+                combining_rwlock_unlock_rd(rwlock);
+            }
+            (void)sink;
+        }
+
+        void direct_write_thread(combining_rwlock_t *rwlock,   // Shared
+                                 unsigned long *data)          // Shared
+        {
+            for (unsigned long i = 0; i < writes_per_writer; i++) {
+                rwlock_lock_wr(&rwlock->rwlock);
+                *data = *data + 1;
+                rwlock_unlock_wr(&rwlock->rwlock);
+            }
+        }
+
+        void post_write_thread(combining_rwlock_t *rwlock,     // Shared
+                               unsigned long *data)            // Shared
+        {
+            for (unsigned long i = 0; i < writes_per_writer; i++) {
+                combining_rwlock_write(rwlock, [data]() {
+                    *data = *data + 1;
+                });
+            }
+        }
+
+        void run_variant(std::string variant_name,
+                         void (*write_thread)(combining_rwlock_t *,
+                                              unsigned long *))
+        {
+            combining_rwlock_t rwlock;
+            unsigned long data = 0;
+            std::atomic<bool> done(false);
+            combining_rwlock_init(&rwlock);
+            // Readers take the first CPUs and writers the rest.
+            std::vector<int> cpus = place_threads(
+                "bench_combining_many_writers", variant_name,
+                num_readers + num_writers);
+            // Count the readers too, since they are part of the cost.
+            PerfCounters counters(perf_counters_enabled);
+            counters.start();
+            std::vector<std::thread> readers;
+            for (unsigned int i = 0; i < num_readers; i++) {
+                readers.push_back(start_thread(cpus, i, read_thread, &rwlock,
+                                               &data, &done));
+            }
+            Clock variant_clock;
+            std::vector<std::thread> writers;
+            for (unsigned int i = 0; i < num_writers; i++) {
+                writers.push_back(start_thread(cpus, num_readers + i,
+                                               write_thread, &rwlock, &data));
+            }
+            for (auto &writer : writers) {
+                writer.join();
+            }
+            Clock::clk_latency_t latency = variant_clock.latency_from_start();
+            done = true;
+            for (auto &reader : readers) {
+                reader.join();
+            }
+            counters.stop();
+            unsigned long num_batches = rwlock.num_batches;
+            unsigned long num_combined_writes = rwlock.num_combined_writes;
+            combining_rwlock_uninit(&rwlock);
+            print_throughput("bench_combining_many_writers", variant_name,
+                             num_writers * writes_per_writer, latency);
+            print_perf_counters("bench_combining_many_writers", variant_name,
+                                num_writers * writes_per_writer, counters);
+            if (num_batches > 0) {
+                std::cout << "bench_combining_many_writers ["
+                    << variant_name << "]: " << num_batches
+                    << " batches, " << (num_combined_writes * 1.0 /
+                                        num_batches)
+                    << " writes per batch" << std::endl;
+            }
+        }
+    }
+    BenchCombiningManyWriters::BenchCombiningManyWriters(
+        Clock &tester_clock) :
+        Test("bench_combining_many_writers", tester_clock)
+    { }
+    int BenchCombiningManyWriters::run_test_body() {
+        using namespace bench_combining_many_writers;
+        run_variant("rwlock_lock_wr", direct_write_thread);
+        run_variant("combining_rwlock_write", post_write_thread);
+        return 0;
+    }
+}
@@ -0,0 +1,18 @@
+#ifndef SRWLT_BENCH_COMBINING_H
+#define SRWLT_BENCH_COMBINING_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // bench_combining_many_writers: Have 16 writer threads make tiny
+    // updates while 2 reader threads keep reading. Compare the throughput
+    // of writing with rwlock_lock_wr to the throughput of posting the same
+    // writes with combining_rwlock_write.
+    class BenchCombiningManyWriters : public Test {
+    public:
+        BenchCombiningManyWriters(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_BENCH_COMBINING_H
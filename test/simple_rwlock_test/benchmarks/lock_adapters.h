@@ -0,0 +1,161 @@
+#ifndef SRWLT_BENCH_LOCK_ADAPTERS_H
+#define SRWLT_BENCH_LOCK_ADAPTERS_H
+
+#include <shared_mutex>
+
+#include <pthread.h>
+
+#include <simple_rwlock.h>
+#include <simple_rwlock_combining.h>
+#include <simple_rwlock_compact.h>
+#include <simple_rwlock_elided.h>
+#include <simple_rwlock_numa.h>
+
+// Adapters that give read-write locks from different libraries the same
+// interface, so that one benchmark or test template can run identical
+// workloads against each of them. Every adapter has:
+//
+//     static const char *name();
+//     void init();
+//     void uninit();
+//     void lock_rd();
+//     void unlock_rd();
+//     void lock_wr();
+//     void unlock_wr();
+//
+// Adapters are used as template arguments rather than through virtual
+// functions, so that calls through them cost the same as direct calls.
+namespace simple_rwlock_test {
+    namespace lock_adapters {
+        struct rwlock_adapter {
+            simple_rwlock::rwlock_t rwlock;
+
+            static const char *name() { return "rwlock_t"; }
+            void init() { simple_rwlock::rwlock_init(&rwlock); }
+            void uninit() { simple_rwlock::rwlock_uninit(&rwlock); }
+            void lock_rd() { simple_rwlock::rwlock_lock_rd(&rwlock); }
+            void unlock_rd() { simple_rwlock::rwlock_unlock_rd(&rwlock); }
+            void lock_wr() { simple_rwlock::rwlock_lock_wr(&rwlock); }
+            void unlock_wr() { simple_rwlock::rwlock_unlock_wr(&rwlock); }
+        };
+
+        struct compact_rwlock_adapter {
+            simple_rwlock::compact_rwlock_t rwlock;
+
+            static const char *name() { return "compact_rwlock_t"; }
+            void init() { simple_rwlock::compact_rwlock_init(&rwlock); }
+            void uninit() { simple_rwlock::compact_rwlock_uninit(&rwlock); }
+            void lock_rd() { simple_rwlock::compact_rwlock_lock_rd(&rwlock); }
+            void unlock_rd() {
+                simple_rwlock::compact_rwlock_unlock_rd(&rwlock);
+            }
+            void lock_wr() { simple_rwlock::compact_rwlock_lock_wr(&rwlock); }
+            void unlock_wr() {
+                simple_rwlock::compact_rwlock_unlock_wr(&rwlock);
+            }
+        };
+
+        struct numa_rwlock_adapter {
+            simple_rwlock::numa_rwlock_t rwlock;
+
+            static const char *name() { return "numa_rwlock_t"; }
+            void init() { simple_rwlock::numa_rwlock_init(&rwlock); }
+            void uninit() { simple_rwlock::numa_rwlock_uninit(&rwlock); }
+            void lock_rd() { simple_rwlock::numa_rwlock_lock_rd(&rwlock); }
+            void unlock_rd() {
+                simple_rwlock::numa_rwlock_unlock_rd(&rwlock);
+            }
+            void lock_wr() { simple_rwlock::numa_rwlock_lock_wr(&rwlock); }
+            void unlock_wr() {
+                simple_rwlock::numa_rwlock_unlock_wr(&rwlock);
+            }
+        };
+
+        struct elided_rwlock_adapter {
+            simple_rwlock::elided_rwlock_t rwlock;
+
+            static const char *name() { return "elided_rwlock_t"; }
+            void init() { simple_rwlock::elided_rwlock_init(&rwlock); }
+            void uninit() { simple_rwlock::elided_rwlock_uninit(&rwlock); }
+            void lock_rd() { simple_rwlock::elided_rwlock_lock_rd(&rwlock); }
+            void unlock_rd() {
+                simple_rwlock::elided_rwlock_unlock_rd(&rwlock);
+            }
+            void lock_wr() { simple_rwlock::elided_rwlock_lock_wr(&rwlock); }
+            void unlock_wr() {
+                simple_rwlock::elided_rwlock_unlock_wr(&rwlock);
+            }
+        };
+
+        // Writers take write access directly; posted writes go through
+        // combining_rwlock_write on the rwlock member.
+        struct combining_rwlock_adapter {
+            simple_rwlock::combining_rwlock_t rwlock;
+
+            static const char *name() { return "combining_rwlock_t"; }
+            void init() { simple_rwlock::combining_rwlock_init(&rwlock); }
+            void uninit() {
+                simple_rwlock::combining_rwlock_uninit(&rwlock);
+            }
+            void lock_rd() {
+                simple_rwlock::combining_rwlock_lock_rd(&rwlock);
+            }
+            void unlock_rd() {
+                simple_rwlock::combining_rwlock_unlock_rd(&rwlock);
+            }
+            void lock_wr() {
+                simple_rwlock::combining_rwlock_lock_wr(&rwlock);
+            }
+            void unlock_wr() {
+                simple_rwlock::combining_rwlock_unlock_wr(&rwlock);
+            }
+        };
+
+        // pthread_rwlock_t with a glibc kind attribute. Readers are
+        // preferred by default; writer preference needs the
+        // non-recursive kind, since a reader may otherwise recursively
+        // acquire read access past a waiting writer.
+        template <int kind>
+        struct pthread_rwlock_adapter {
+            pthread_rwlock_t rwlock;
+
+            static const char *name() {
+                return (kind == PTHREAD_RWLOCK_PREFER_READER_NP)
+                    ? "pthread_rwlock_t (reader pref)"
+                    : "pthread_rwlock_t (writer pref)";
+            }
+            void init() {
+                pthread_rwlockattr_t attr;
+                pthread_rwlockattr_init(&attr);
+                pthread_rwlockattr_setkind_np(&attr, kind);
+                pthread_rwlock_init(&rwlock, &attr);
+                pthread_rwlockattr_destroy(&attr);
+            }
+            void uninit() { pthread_rwlock_destroy(&rwlock); }
+            void lock_rd() { pthread_rwlock_rdlock(&rwlock); }
+            void unlock_rd() { pthread_rwlock_unlock(&rwlock); }
+            void lock_wr() { pthread_rwlock_wrlock(&rwlock); }
+            void unlock_wr() { pthread_rwlock_unlock(&rwlock); }
+        };
+
+        typedef pthread_rwlock_adapter<PTHREAD_RWLOCK_PREFER_READER_NP>
+            pthread_reader_pref_adapter;
+        typedef pthread_rwlock_adapter<
+            PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP>
+            pthread_writer_pref_adapter;
+
+        struct shared_mutex_adapter {
+            std::shared_mutex mutex;
+
+            static const char *name() { return "std::shared_mutex"; }
+            void init() { }
+            void uninit() { }
+            void lock_rd() { mutex.lock_shared(); }
+            void unlock_rd() { mutex.unlock_shared(); }
+            void lock_wr() { mutex.lock(); }
+            void unlock_wr() { mutex.unlock(); }
+        };
+    }
+}
+
+#endif // SRWLT_BENCH_LOCK_ADAPTERS_H
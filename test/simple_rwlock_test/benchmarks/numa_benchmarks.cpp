@@ -0,0 +1,119 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <simple_rwlock.h>
+#include <simple_rwlock_numa.h>
+#include <simple_rwlock_test/clock.h>
+#include <simple_rwlock_test/perf_counters.h>
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/topology.h>
+#include <simple_rwlock_test/benchmarks/bench_common.h>
+#include <simple_rwlock_test/benchmarks/numa_benchmarks.h>
+
+namespace simple_rwlock_test {
+    using namespace simple_rwlock;
+    using namespace bench_common;
+
+    namespace bench_numa_cross_node {
+        const unsigned int threads_per_node = 4;
+        const unsigned long writes_every = 16;
+
+        // Lock operations for each variant being compared.
+        struct plain_lock {
+            typedef rwlock_t lock_t;
+            static void init(lock_t *l) { rwlock_init(l); }
+            static void uninit(lock_t *l) { rwlock_uninit(l); }
+            static void lock_rd(lock_t *l) { rwlock_lock_rd(l); }
+            static void unlock_rd(lock_t *l) { rwlock_unlock_rd(l); }
+            static void lock_wr(lock_t *l) { rwlock_lock_wr(l); }
+            static void unlock_wr(lock_t *l) { rwlock_unlock_wr(l); }
+        };
+
+        struct numa_lock {
+            typedef numa_rwlock_t lock_t;
+            static void init(lock_t *l) { numa_rwlock_init(l); }
+            static void uninit(lock_t *l) { numa_rwlock_uninit(l); }
+            static void lock_rd(lock_t *l) { numa_rwlock_lock_rd(l); }
+            static void unlock_rd(lock_t *l) { numa_rwlock_unlock_rd(l); }
+            static void lock_wr(lock_t *l) { numa_rwlock_lock_wr(l); }
+            static void unlock_wr(lock_t *l) { numa_rwlock_unlock_wr(l); }
+        };
+
+        template <typename Lock>
+        void worker_thread(typename Lock::lock_t *rwlock, // Shared
+                           unsigned long *data)           // Shared
+        {
+            unsigned long sink = 0;
+            for (unsigned long i = 0; i < bench_iterations; i++) {
+                if (i % writes_every == 0) {
+                    Lock::lock_wr(rwlock);
+                    *data = *data + 1;
+                    Lock::unlock_wr(rwlock);
+                } else {
+                    Lock::lock_rd(rwlock);
+                    sink += *data;
+                    Lock::unlock_rd(rwlock);
+                }
+            }
+            (void)sink;
+        }
+
+        template <typename Lock>
+        void run_variant(std::string variant_name) {
+            unsigned int num_nodes = numa_num_nodes();
+            std::vector<std::vector<int> > cpus_by_node;
+            for (unsigned int node = 0; node < num_nodes; node++) {
+                cpus_by_node.push_back(
+                    Topology::system().node_cpus(node));
+            }
+            unsigned int num_threads = threads_per_node * num_nodes;
+            // Alternate nodes so that consecutive threads never share one.
+            // Threads on a node with no CPUs listed are left unpinned.
+            std::vector<int> cpus;
+            bool all_pinned = true;
+            for (unsigned int i = 0; i < num_threads; i++) {
+                const std::vector<int> &node_cpus = cpus_by_node[i % num_nodes];
+                all_pinned &= !node_cpus.empty();
+                cpus.push_back(node_cpus.empty()
+                    ? -1 : node_cpus[(i / num_nodes) % node_cpus.size()]);
+            }
+            if (!all_pinned) {
+                cpus.clear();
+            }
+            record_placement("bench_numa_cross_node", variant_name,
+                             all_pinned ? "alternate-nodes" : "unpinned",
+                             cpus);
+            typename Lock::lock_t rwlock;
+            unsigned long data = 0;
+            Lock::init(&rwlock);
+            PerfCounters counters(perf_counters_enabled);
+            counters.start();
+            Clock variant_clock;
+            std::vector<std::thread> threads;
+            for (unsigned int i = 0; i < num_threads; i++) {
+                threads.push_back(start_thread(cpus, i, worker_thread<Lock>,
+                                               &rwlock, &data));
+            }
+            for (auto &thread : threads) {
+                thread.join();
+            }
+            Clock::clk_latency_t latency = variant_clock.latency_from_start();
+            counters.stop();
+            Lock::uninit(&rwlock);
+            print_throughput("bench_numa_cross_node", variant_name,
+                             num_threads * bench_iterations, latency);
+            print_perf_counters("bench_numa_cross_node", variant_name,
+                                num_threads * bench_iterations, counters);
+        }
+    }
+    BenchNumaCrossNode::BenchNumaCrossNode(Clock &tester_clock) :
+        Test("bench_numa_cross_node", tester_clock)
+    { }
+    int BenchNumaCrossNode::run_test_body() {
+        using namespace bench_numa_cross_node;
+        run_variant<plain_lock>("rwlock_t");
+        run_variant<numa_lock>("numa_rwlock_t");
+        return 0;
+    }
+}
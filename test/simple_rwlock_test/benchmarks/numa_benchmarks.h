@@ -0,0 +1,18 @@
+#ifndef SRWLT_BENCH_NUMA_H
+#define SRWLT_BENCH_NUMA_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // bench_numa_cross_node: Pin 4 threads per NUMA node, spreading them
+    // round-robin across the nodes, and have each thread perform a mix of
+    // 15 reads to every write. Compare the throughput of rwlock_t with
+    // the throughput of numa_rwlock_t.
+    class BenchNumaCrossNode : public Test {
+    public:
+        BenchNumaCrossNode(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_BENCH_NUMA_H
@@ -0,0 +1,120 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <simple_rwlock.h>
+#include <simple_rwlock_test/clock.h>
+#include <simple_rwlock_test/cycle_clock.h>
+#include <simple_rwlock_test/histogram.h>
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/benchmarks/bench_common.h>
+#include <simple_rwlock_test/benchmarks/op_latency_benchmarks.h>
+
+namespace simple_rwlock_test {
+    using namespace simple_rwlock;
+    using namespace bench_common;
+
+    namespace bench_lock_op_latency {
+        const unsigned long writes_every = 16;
+
+        // Timings of each kind of call made by one thread.
+        struct thread_stats_t {
+            CycleClock::op_stats_t lock_rd;
+            CycleClock::op_stats_t unlock_rd;
+            CycleClock::op_stats_t lock_wr;
+            CycleClock::op_stats_t unlock_wr;
+            lock_op_histograms_t histograms;
+        };
+
+        void worker_thread(rwlock_t *rwlock,          // Shared
+                           unsigned long *data,       // Shared
+                           thread_stats_t *stats)     // Not shared
+        {
+            unsigned long sink = 0;
+            for (unsigned long i = 0; i < bench_iterations; i++) {
+                CycleClock::clk_ticks_t start;
+                CycleClock::clk_ticks_t acquired;
+                if (i % writes_every == 0) {
+                    start = CycleClock::start_ticks();
+                    rwlock_lock_wr(rwlock);
+                    acquired = CycleClock::stop_ticks();
+                    stats->lock_wr.record(CycleClock::elapsed_ticks(
+                        start, acquired));
+                    stats->histograms.wait_wr.record(
+                        CycleClock::elapsed_ticks(start, acquired));
+                    *data = *data + 1;
+                    start = CycleClock::start_ticks();
+                    stats->histograms.hold_wr.record(
+                        CycleClock::elapsed_ticks(acquired, start));
+                    rwlock_unlock_wr(rwlock);
+                    stats->unlock_wr.record(CycleClock::elapsed_ticks(
+                        start, CycleClock::stop_ticks()));
+                } else {
+                    start = CycleClock::start_ticks();
+                    rwlock_lock_rd(rwlock);
+                    acquired = CycleClock::stop_ticks();
+                    stats->lock_rd.record(CycleClock::elapsed_ticks(
+                        start, acquired));
+                    stats->histograms.wait_rd.record(
+                        CycleClock::elapsed_ticks(start, acquired));
+                    sink += *data;
+                    start = CycleClock::start_ticks();
+                    stats->histograms.hold_rd.record(
+                        CycleClock::elapsed_ticks(acquired, start));
+                    rwlock_unlock_rd(rwlock);
+                    stats->unlock_rd.record(CycleClock::elapsed_ticks(
+                        start, CycleClock::stop_ticks()));
+                }
+            }
+            (void)sink;
+        }
+
+        void run_variant(unsigned int num_threads) {
+            rwlock_t rwlock;
+            unsigned long data = 0;
+            rwlock_init(&rwlock);
+            std::vector<thread_stats_t> stats(num_threads);
+            std::string variant_name = std::to_string(num_threads) +
+                ((num_threads == 1) ? " thread" : " threads");
+            std::vector<int> cpus = place_threads("bench_lock_op_latency",
+                                                  variant_name, num_threads);
+            std::vector<std::thread> threads;
+            for (unsigned int i = 0; i < num_threads; i++) {
+                threads.push_back(start_thread(cpus, i, worker_thread,
+                                               &rwlock, &data, &stats[i]));
+            }
+            for (auto &thread : threads) {
+                thread.join();
+            }
+            rwlock_uninit(&rwlock);
+            thread_stats_t total;
+            for (const auto &thread_stats : stats) {
+                total.lock_rd.merge(thread_stats.lock_rd);
+                total.unlock_rd.merge(thread_stats.unlock_rd);
+                total.lock_wr.merge(thread_stats.lock_wr);
+                total.unlock_wr.merge(thread_stats.unlock_wr);
+                total.histograms.merge(thread_stats.histograms);
+            }
+            print_op_stats("bench_lock_op_latency", variant_name,
+                           "rwlock_lock_rd", total.lock_rd);
+            print_op_stats("bench_lock_op_latency", variant_name,
+                           "rwlock_unlock_rd", total.unlock_rd);
+            print_op_stats("bench_lock_op_latency", variant_name,
+                           "rwlock_lock_wr", total.lock_wr);
+            print_op_stats("bench_lock_op_latency", variant_name,
+                           "rwlock_unlock_wr", total.unlock_wr);
+            print_lock_op_histograms("bench_lock_op_latency", variant_name,
+                                     total.histograms);
+        }
+    }
+    BenchLockOpLatency::BenchLockOpLatency(Clock &tester_clock) :
+        Test("bench_lock_op_latency", tester_clock)
+    { }
+    int BenchLockOpLatency::run_test_body() {
+        using namespace bench_lock_op_latency;
+        CycleClock::calibrate();
+        run_variant(1);
+        run_variant(4);
+        return 0;
+    }
+}
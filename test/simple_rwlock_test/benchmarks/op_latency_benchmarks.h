@@ -0,0 +1,19 @@
+#ifndef SRWLT_BENCH_OP_LATENCY_H
+#define SRWLT_BENCH_OP_LATENCY_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // bench_lock_op_latency: Time every rwlock_t call with CycleClock in a
+    // mix of 15 reads to every write, first on one thread with no
+    // contention and then on 4 threads, and report the mean and minimum
+    // time of each kind of call, and the percentiles of the time spent
+    // waiting for and holding read and write access.
+    class BenchLockOpLatency : public Test {
+    public:
+        BenchLockOpLatency(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_BENCH_OP_LATENCY_H
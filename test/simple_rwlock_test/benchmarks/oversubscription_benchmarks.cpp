@@ -0,0 +1,146 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <simple_rwlock_basic.h>
+#include <simple_rwlock_basic_impl.h>
+#include <simple_rwlock_preemption.h>
+#include <simple_rwlock_test/clock.h>
+#include <simple_rwlock_test/cycle_clock.h>
+#include <simple_rwlock_test/histogram.h>
+#include <simple_rwlock_test/perf_counters.h>
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/topology.h>
+#include <simple_rwlock_test/benchmarks/bench_common.h>
+#include <simple_rwlock_test/benchmarks/oversubscription_benchmarks.h>
+
+namespace simple_rwlock_test {
+    using namespace simple_rwlock;
+    using namespace bench_common;
+
+    namespace bench_oversubscription {
+        const unsigned int threads_per_cpu = 4;
+        const unsigned long writes_every = 16;
+        // Counters read or written by every critical section, so that a
+        // holder spends long enough inside to be preempted there.
+        const unsigned int num_counters = 64;
+
+        typedef basic_rwlock<writer_bias_policy, park_wait_policy,
+                             no_stats_policy, pointer_layout_policy>
+            park_t;
+        typedef basic_rwlock<writer_bias_policy, spin_then_park_wait_policy<>,
+                             no_stats_policy, pointer_layout_policy>
+            spin_then_park_t;
+        typedef basic_rwlock<writer_bias_policy,
+                             preemption_tolerant_wait_policy<50000, false>,
+                             no_stats_policy, pointer_layout_policy>
+            preemption_tolerant_t;
+        typedef basic_rwlock<writer_bias_policy,
+                             preemption_tolerant_wait_policy<50000, true>,
+                             no_stats_policy, pointer_layout_policy>
+            preemption_tolerant_holder_t;
+
+        template <typename lock_t>
+        void worker_thread(lock_t *rwlock,                      // Shared
+                           unsigned long *counters,             // Shared
+                           unsigned long num_iterations,        // Not shared
+                           lock_op_histograms_t *histograms)    // Not shared
+        {
+            unsigned long sink = 0;
+            for (unsigned long i = 0; i < num_iterations; i++) {
+                CycleClock::clk_ticks_t start = CycleClock::start_ticks();
+                if (i % writes_every == 0) {
+                    rwlock->lock_wr();
+                    CycleClock::clk_ticks_t acquired =
+                        CycleClock::stop_ticks();
+                    for (unsigned int j = 0; j < num_counters; j++) {
+                        counters[j]++;
+                    }
+                    rwlock->unlock_wr();
+                    CycleClock::clk_ticks_t released =
+                        CycleClock::stop_ticks();
+                    histograms->wait_wr.record(
+                        CycleClock::elapsed_ticks(start, acquired));
+                    histograms->hold_wr.record(
+                        CycleClock::elapsed_ticks(acquired, released));
+                } else {
+                    rwlock->lock_rd();
+                    CycleClock::clk_ticks_t acquired =
+                        CycleClock::stop_ticks();
+                    for (unsigned int j = 0; j < num_counters; j++) {
+                        sink += counters[j];
+                    }
+                    rwlock->unlock_rd();
+                    CycleClock::clk_ticks_t released =
+                        CycleClock::stop_ticks();
+                    histograms->wait_rd.record(
+                        CycleClock::elapsed_ticks(start, acquired));
+                    histograms->hold_rd.record(
+                        CycleClock::elapsed_ticks(acquired, released));
+                }
+            }
+            (void)sink;
+        }
+
+        template <typename lock_t>
+        void run_variant(std::string variant_name, unsigned int num_threads) {
+            lock_t rwlock;
+            unsigned long counters[num_counters] = { };
+            rwlock.init();
+            // Keep the total amount of work the same on any machine.
+            unsigned long num_iterations =
+                threads_per_cpu * bench_iterations / num_threads;
+            if (num_iterations == 0) {
+                num_iterations = 1;
+            }
+            variant_name += ", " + std::to_string(num_threads) + " threads";
+            std::vector<int> cpus = place_threads("bench_oversubscription",
+                                                  variant_name, num_threads);
+            std::vector<lock_op_histograms_t> histograms(num_threads);
+            PerfCounters perf_counters(perf_counters_enabled);
+            perf_counters.start();
+            Clock variant_clock;
+            std::vector<std::thread> threads;
+            for (unsigned int i = 0; i < num_threads; i++) {
+                threads.push_back(start_thread(cpus, i, worker_thread<lock_t>,
+                                               &rwlock, counters,
+                                               num_iterations,
+                                               &histograms[i]));
+            }
+            for (auto &thread : threads) {
+                thread.join();
+            }
+            Clock::clk_latency_t latency = variant_clock.latency_from_start();
+            perf_counters.stop();
+            rwlock.uninit();
+
+            lock_op_histograms_t merged;
+            for (const auto &thread_histograms : histograms) {
+                merged.merge(thread_histograms);
+            }
+            unsigned long num_ops = num_threads * num_iterations;
+            print_throughput("bench_oversubscription", variant_name, num_ops,
+                             latency);
+            print_perf_counters("bench_oversubscription", variant_name,
+                                num_ops, perf_counters);
+            print_lock_op_histograms("bench_oversubscription", variant_name,
+                                     merged);
+        }
+    }
+    BenchOversubscription::BenchOversubscription(Clock &tester_clock) :
+        Test("bench_oversubscription", tester_clock)
+    { }
+    int BenchOversubscription::run_test_body() {
+        using namespace bench_oversubscription;
+        unsigned int num_threads =
+            threads_per_cpu * Topology::system().cpus().size();
+        run_variant<park_t>("park_wait_policy", num_threads);
+        run_variant<spin_then_park_t>("spin_then_park_wait_policy",
+                                      num_threads);
+        run_variant<preemption_tolerant_t>(
+            "preemption_tolerant_wait_policy", num_threads);
+        run_variant<preemption_tolerant_holder_t>(
+            "preemption_tolerant_wait_policy, holder check", num_threads);
+        return 0;
+    }
+}
@@ -0,0 +1,20 @@
+#ifndef SRWLT_BENCH_OVERSUBSCRIPTION_H
+#define SRWLT_BENCH_OVERSUBSCRIPTION_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // bench_oversubscription: Run 4 threads per CPU doing 15 reads to every
+    // write, each with a critical section long enough to be preempted in,
+    // against basic_rwlock configurations that park right away, spin
+    // before parking, and use preemption_tolerant_wait_policy with and
+    // without checking whether the holder is running. Print throughput and
+    // the distributions of wait and hold times.
+    class BenchOversubscription : public Test {
+    public:
+        BenchOversubscription(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_BENCH_OVERSUBSCRIPTION_H
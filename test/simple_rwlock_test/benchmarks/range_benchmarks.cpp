@@ -0,0 +1,143 @@
+#include <cstdint>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <simple_rwlock.h>
+#include <simple_rwlock_range.h>
+#include <simple_rwlock_test/clock.h>
+#include <simple_rwlock_test/perf_counters.h>
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/benchmarks/bench_common.h>
+#include <simple_rwlock_test/benchmarks/range_benchmarks.h>
+
+namespace simple_rwlock_test {
+    using namespace simple_rwlock;
+    using namespace bench_common;
+
+    namespace bench_range_random {
+        const unsigned int num_threads = 4;
+        const uint64_t buffer_length = 1 << 16;
+        const uint64_t max_range_length = 64;
+
+        // The whole buffer under one rwlock_t, whatever the range.
+        struct single_lock_t {
+            rwlock_t rwlock;
+
+            static const char *name() { return "rwlock_t"; }
+            void init() { rwlock_init(&rwlock); }
+            void uninit() { rwlock_uninit(&rwlock); }
+            void lock_rd(range_rwlock_range_t *, uint64_t, uint64_t) {
+                rwlock_lock_rd(&rwlock);
+            }
+            void unlock_rd(range_rwlock_range_t *) {
+                rwlock_unlock_rd(&rwlock);
+            }
+            void lock_wr(range_rwlock_range_t *, uint64_t, uint64_t) {
+                rwlock_lock_wr(&rwlock);
+            }
+            void unlock_wr(range_rwlock_range_t *) {
+                rwlock_unlock_wr(&rwlock);
+            }
+        };
+
+        struct range_lock_t {
+            range_rwlock_t rwlock;
+
+            static const char *name() { return "range_rwlock_t"; }
+            void init() { range_rwlock_init(&rwlock); }
+            void uninit() { range_rwlock_uninit(&rwlock); }
+            void lock_rd(range_rwlock_range_t *range, uint64_t offset,
+                         uint64_t length)
+            {
+                range_rwlock_lock_rd(&rwlock, range, offset, length);
+            }
+            void unlock_rd(range_rwlock_range_t *range) {
+                range_rwlock_unlock_rd(&rwlock, range);
+            }
+            void lock_wr(range_rwlock_range_t *range, uint64_t offset,
+                         uint64_t length)
+            {
+                range_rwlock_lock_wr(&rwlock, range, offset, length);
+            }
+            void unlock_wr(range_rwlock_range_t *range) {
+                range_rwlock_unlock_wr(&rwlock, range);
+            }
+        };
+
+        template <typename lock_t>
+        void worker_thread(unsigned int thread_num,     // Not shared
+                           lock_t *lock,                // Shared
+                           unsigned long *buffer,       // Shared
+                           unsigned long writes_every)  // Not shared
+        {
+            std::minstd_rand random(thread_num);
+            std::uniform_int_distribution<uint64_t> lengths(
+                1, max_range_length);
+            std::uniform_int_distribution<uint64_t> offsets(
+                0, buffer_length - max_range_length);
+            range_rwlock_range_t range;
+            unsigned long sink = 0;
+            for (unsigned long i = 0; i < bench_iterations; i++) {
+                uint64_t offset = offsets(random);
+                uint64_t length = lengths(random);
+                if (i % writes_every == 0) {
+                    lock->lock_wr(&range, offset, length);
+                    for (uint64_t j = offset; j < offset + length; j++) {
+                        buffer[j]++;
+                    }
+                    lock->unlock_wr(&range);
+                } else {
+                    lock->lock_rd(&range, offset, length);
+                    for (uint64_t j = offset; j < offset + length; j++) {
+                        sink += buffer[j];
+                    }
+                    lock->unlock_rd(&range);
+                }
+            }
+            (void)sink;
+        }
+
+        template <typename lock_t>
+        void run_variant(unsigned long writes_every) {
+            lock_t lock;
+            std::vector<unsigned long> buffer(buffer_length, 0);
+            lock.init();
+            std::string variant_name = std::string(lock_t::name()) + ", 1:" +
+                std::to_string(writes_every - 1) + " writes to reads";
+            std::vector<int> cpus = place_threads("bench_range_random",
+                                                  variant_name, num_threads);
+            PerfCounters counters(perf_counters_enabled);
+            counters.start();
+            Clock variant_clock;
+            std::vector<std::thread> threads;
+            for (unsigned int i = 0; i < num_threads; i++) {
+                threads.push_back(start_thread(cpus, i, worker_thread<lock_t>,
+                                               i + 1, &lock, buffer.data(),
+                                               writes_every));
+            }
+            for (auto &thread : threads) {
+                thread.join();
+            }
+            Clock::clk_latency_t latency = variant_clock.latency_from_start();
+            counters.stop();
+            lock.uninit();
+            print_throughput("bench_range_random", variant_name,
+                             num_threads * bench_iterations, latency);
+            print_perf_counters("bench_range_random", variant_name,
+                                num_threads * bench_iterations, counters);
+        }
+    }
+    BenchRangeRandom::BenchRangeRandom(Clock &tester_clock) :
+        Test("bench_range_random", tester_clock)
+    { }
+    int BenchRangeRandom::run_test_body() {
+        using namespace bench_range_random;
+        run_variant<single_lock_t>(4);
+        run_variant<range_lock_t>(4);
+        run_variant<single_lock_t>(16);
+        run_variant<range_lock_t>(16);
+        return 0;
+    }
+}
@@ -0,0 +1,18 @@
+#ifndef SRWLT_BENCH_RANGE_H
+#define SRWLT_BENCH_RANGE_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // bench_range_random: Have 4 threads read and write random ranges of
+    // up to 64 elements of a 64K-element buffer, with 1 write to every 3
+    // reads and then 1 to every 15, guarding the buffer with one rwlock_t
+    // and then with a range_rwlock_t.
+    class BenchRangeRandom : public Test {
+    public:
+        BenchRangeRandom(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_BENCH_RANGE_H
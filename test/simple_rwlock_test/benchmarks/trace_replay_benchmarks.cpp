@@ -0,0 +1,331 @@
+#include <barrier>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include <simple_rwlock.h>
+#include <simple_rwlock_trace.h>
+#include <simple_rwlock_test/cycle_clock.h>
+#include <simple_rwlock_test/histogram.h>
+#include <simple_rwlock_test/perf_counters.h>
+#include <simple_rwlock_test/sync.h>
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/benchmarks/bench_common.h>
+#include <simple_rwlock_test/benchmarks/lock_adapters.h>
+#include <simple_rwlock_test/benchmarks/trace_replay_benchmarks.h>
+
+namespace simple_rwlock_test {
+    using namespace simple_rwlock;
+    using namespace bench_common;
+    using namespace lock_adapters;
+
+    namespace bench_trace_replay {
+        typedef std::chrono::steady_clock::time_point time_point_t;
+
+        // Shape of the synthetic trace: each thread alternates between
+        // bursts of short read sections and idle gaps, and every
+        // write_burst_every-th burst is a few longer write sections.
+        const unsigned int synthetic_threads = 4;
+        const unsigned int synthetic_locks = 2;
+        const unsigned int read_burst_length = 10;
+        const unsigned int write_burst_length = 5;
+        const unsigned int write_burst_every = 4;
+        const std::chrono::nanoseconds read_hold(1000);
+        const std::chrono::nanoseconds write_hold(2000);
+        const std::chrono::nanoseconds burst_gap(20000);
+
+        // Stand in for the work done while holding a lock.
+        void busy_for(std::chrono::nanoseconds duration) {
+            time_point_t deadline = std::chrono::steady_clock::now() +
+                duration;
+            while (std::chrono::steady_clock::now() < deadline) { }
+        }
+
+        // Wait until deadline, letting other threads run in the meantime.
+        void yield_until(time_point_t deadline) {
+            while (std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+        }
+
+        void synthetic_thread(rwlock_t *rwlocks,             // Shared
+                              unsigned int thread_index,     // Not shared
+                              std::barrier<> *start_barrier) // Shared
+        {
+            unsigned long num_sections = bench_iterations / synthetic_threads;
+            unsigned long section = 0;
+            start_barrier->arrive_and_wait();
+            for (unsigned int burst = 0; section < num_sections; burst++) {
+                rwlock_t *rwlock =
+                    &rwlocks[(thread_index + burst) % synthetic_locks];
+                bool write_burst = (burst % write_burst_every ==
+                                    write_burst_every - 1);
+                unsigned int burst_length = write_burst
+                    ? write_burst_length : read_burst_length;
+                for (unsigned int i = 0;
+                     i < burst_length && section < num_sections;
+                     i++, section++) {
+                    if (write_burst) {
+                        rwlock_lock_wr(rwlock);
+                        busy_for(write_hold);
+                        rwlock_unlock_wr(rwlock);
+                    } else {
+                        rwlock_lock_rd(rwlock);
+                        busy_for(read_hold);
+                        rwlock_unlock_rd(rwlock);
+                    }
+                }
+                yield_until(std::chrono::steady_clock::now() + burst_gap);
+            }
+        }
+
+        // Record the synthetic workload on rwlock_t and write it to path.
+        bool record_synthetic_trace(const std::string &path) {
+            rwlock_t rwlocks[synthetic_locks];
+            for (unsigned int i = 0; i < synthetic_locks; i++) {
+                rwlock_init(&rwlocks[i]);
+            }
+            std::barrier<> start_barrier(synthetic_threads);
+            rwlock_trace_start();
+            std::vector<std::thread> threads;
+            for (unsigned int i = 0; i < synthetic_threads; i++) {
+                threads.push_back(std::thread(synthetic_thread, rwlocks, i,
+                                              &start_barrier));
+            }
+            for (auto &thread : threads) {
+                thread.join();
+            }
+            bool written = rwlock_trace_stop(path);
+            for (unsigned int i = 0; i < synthetic_locks; i++) {
+                rwlock_uninit(&rwlocks[i]);
+            }
+            return written;
+        }
+
+        // A trace split up by thread, in the order each thread made its
+        // lock calls.
+        struct trace_t {
+            std::vector<std::vector<rwlock_trace_record_t>> threads;
+            unsigned int num_locks;
+            // Nanoseconds from the start of the trace until the last
+            // section was released.
+            uint64_t duration_ns;
+        };
+
+        trace_t split_trace(const std::vector<rwlock_trace_record_t> &records) {
+            trace_t trace;
+            trace.num_locks = 0;
+            trace.duration_ns = 0;
+            for (const auto &record : records) {
+                if (record.thread_id >= trace.threads.size()) {
+                    trace.threads.resize(record.thread_id + 1);
+                }
+                trace.threads[record.thread_id].push_back(record);
+                if (record.lock_id >= trace.num_locks) {
+                    trace.num_locks = record.lock_id + 1;
+                }
+                uint64_t end_ns = record.call_ns + record.wait_ns +
+                    record.hold_ns;
+                if (end_ns > trace.duration_ns) {
+                    trace.duration_ns = end_ns;
+                }
+            }
+            return trace;
+        }
+
+        // Time taken to acquire each kind of access by one thread.
+        struct thread_histograms_t {
+            Histogram wait_rd;
+            Histogram wait_wr;
+        };
+
+        struct result_t {
+            std::string lock_name;
+            double makespan_ms;
+            double read_p50_ns;
+            double read_p99_ns;
+            double write_p50_ns;
+            double write_p99_ns;
+        };
+
+        template <typename Adapter>
+        void replay_thread(
+            Adapter *locks,                                     // Shared
+            const std::vector<rwlock_trace_record_t> *records,  // Shared
+            std::barrier<> *start_barrier,                      // Shared
+            time_point_t *replay_start,                         // Shared
+            thread_histograms_t *histograms)                    // Not shared
+        {
+            // The main thread sets replay_start between the two barriers.
+            start_barrier->arrive_and_wait();
+            start_barrier->arrive_and_wait();
+            for (const auto &record : *records) {
+                Adapter *lock = &locks[record.lock_id];
+                yield_until(*replay_start +
+                            std::chrono::nanoseconds(record.call_ns));
+                std::chrono::nanoseconds hold(record.hold_ns);
+                CycleClock::clk_ticks_t start = CycleClock::start_ticks();
+                if (record.kind == rwlock_trace_kind_write) {
+                    lock->lock_wr();
+                    histograms->wait_wr.record(CycleClock::elapsed_ticks(
+                        start, CycleClock::stop_ticks()));
+                    busy_for(hold);
+                    lock->unlock_wr();
+                } else {
+                    lock->lock_rd();
+                    histograms->wait_rd.record(CycleClock::elapsed_ticks(
+                        start, CycleClock::stop_ticks()));
+                    busy_for(hold);
+                    lock->unlock_rd();
+                }
+            }
+        }
+
+        double percentile_ns(const Histogram &histogram, double percentile) {
+            if (histogram.count() == 0) {
+                return -1.0;
+            }
+            return CycleClock::ticks_to_nanoseconds(
+                histogram.value_at_percentile(percentile));
+        }
+
+        template <typename Adapter>
+        result_t replay(const trace_t &trace) {
+            std::unique_ptr<Adapter[]> locks(new Adapter[trace.num_locks]);
+            for (unsigned int i = 0; i < trace.num_locks; i++) {
+                locks[i].init();
+            }
+            unsigned int num_threads = trace.threads.size();
+            std::string variant_name = Adapter::name();
+            std::vector<int> cpus = place_threads("bench_trace_replay",
+                                                  variant_name, num_threads);
+            std::vector<thread_histograms_t> histograms(num_threads);
+            std::barrier<> start_barrier(num_threads + 1);
+            time_point_t replay_start;
+            PerfCounters counters(perf_counters_enabled);
+            counters.start();
+            std::vector<std::thread> threads;
+            for (unsigned int i = 0; i < num_threads; i++) {
+                threads.push_back(start_thread(cpus, i, replay_thread<Adapter>,
+                                               locks.get(), &trace.threads[i],
+                                               &start_barrier, &replay_start,
+                                               &histograms[i]));
+            }
+            start_barrier.arrive_and_wait();
+            replay_start = std::chrono::steady_clock::now();
+            start_barrier.arrive_and_wait();
+            for (auto &thread : threads) {
+                thread.join();
+            }
+            time_point_t replay_end = std::chrono::steady_clock::now();
+            counters.stop();
+            for (unsigned int i = 0; i < trace.num_locks; i++) {
+                locks[i].uninit();
+            }
+
+            Histogram wait_rd;
+            Histogram wait_wr;
+            for (const auto &thread_histograms : histograms) {
+                wait_rd.merge(thread_histograms.wait_rd);
+                wait_wr.merge(thread_histograms.wait_wr);
+            }
+            print_perf_counters("bench_trace_replay", variant_name,
+                                wait_rd.count() + wait_wr.count(), counters);
+            export_histogram("bench_trace_replay", variant_name,
+                             "read wait", wait_rd);
+            export_histogram("bench_trace_replay", variant_name,
+                             "write wait", wait_wr);
+
+            result_t result;
+            result.lock_name = variant_name;
+            result.makespan_ms =
+                std::chrono::duration<double, std::milli>(
+                    replay_end - replay_start).count();
+            result.read_p50_ns = percentile_ns(wait_rd, 50.0);
+            result.read_p99_ns = percentile_ns(wait_rd, 99.0);
+            result.write_p50_ns = percentile_ns(wait_wr, 50.0);
+            result.write_p99_ns = percentile_ns(wait_wr, 99.0);
+            return result;
+        }
+
+        // Print one row per lock. Negative values are printed as "-".
+        void print_results(const trace_t &trace,
+                           const std::vector<result_t> &results)
+        {
+            const int name_width = 32;
+            const int column_width = 14;
+            std::stringstream print_stream;
+            print_stream << std::endl << "bench_trace_replay: "
+                << trace.threads.size() << " threads, " << trace.num_locks
+                << " locks, recorded duration "
+                << std::setprecision(4) << trace.duration_ns / 1000000.0
+                << " ms" << std::endl << std::setw(name_width) << std::left
+                << "lock" << std::right
+                << std::setw(column_width) << "makespan ms"
+                << std::setw(column_width) << "read p50 ns"
+                << std::setw(column_width) << "read p99 ns"
+                << std::setw(column_width) << "write p50 ns"
+                << std::setw(column_width) << "write p99 ns" << std::endl;
+            for (const auto &result : results) {
+                print_stream << std::setw(name_width) << std::left
+                    << result.lock_name << std::right;
+                for (double value : { result.makespan_ms, result.read_p50_ns,
+                                      result.read_p99_ns, result.write_p50_ns,
+                                      result.write_p99_ns }) {
+                    print_stream << std::setw(column_width);
+                    if (value < 0.0) {
+                        print_stream << "-";
+                    } else {
+                        print_stream << std::setprecision(4) << value;
+                    }
+                }
+                print_stream << std::endl;
+            }
+            std::cout << print_stream.str();
+        }
+    }
+    BenchTraceReplay::BenchTraceReplay(Clock &tester_clock) :
+        Test("bench_trace_replay", tester_clock)
+    { }
+    int BenchTraceReplay::run_test_body() {
+        using namespace bench_trace_replay;
+        std::string path = replay_trace_path;
+        bool synthetic = path.empty();
+        if (synthetic) {
+            path = "/tmp/srwlt_trace_replay." + std::to_string(getpid());
+            if (!record_synthetic_trace(path)) {
+                return 1;
+            }
+        }
+        std::vector<rwlock_trace_record_t> records;
+        bool read = rwlock_trace_read(path, &records);
+        if (synthetic) {
+            remove(path.c_str());
+        }
+        if (!read) {
+            std::cout << "bench_trace_replay: could not read trace "
+                << path << std::endl;
+            return 1;
+        }
+        trace_t trace = split_trace(records);
+        if (trace.threads.empty()) {
+            return 0;
+        }
+        std::vector<result_t> results;
+        results.push_back(replay<rwlock_adapter>(trace));
+        results.push_back(replay<compact_rwlock_adapter>(trace));
+        results.push_back(replay<pthread_reader_pref_adapter>(trace));
+        results.push_back(replay<pthread_writer_pref_adapter>(trace));
+        results.push_back(replay<shared_mutex_adapter>(trace));
+        print_results(trace, results);
+        return 0;
+    }
+}
@@ -0,0 +1,25 @@
+#ifndef SRWLT_BENCH_TRACE_REPLAY_H
+#define SRWLT_BENCH_TRACE_REPLAY_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // bench_trace_replay: Replay a trace written by rwlock_trace_stop
+    // against rwlock_t, compact_rwlock_t, pthread_rwlock_t and
+    // std::shared_mutex, with one thread per traced thread and one lock per
+    // traced lock. Each section is started at its recorded time and held
+    // for its recorded hold time, so the locks see the same bursts and idle
+    // periods as the traced program. Print how long each replay took next
+    // to the recorded duration, and the time taken to acquire read and
+    // write access.
+    //
+    // The trace is given with the -T option. Without one, a synthetic
+    // bursty trace is recorded from rwlock_t first and replayed instead.
+    class BenchTraceReplay : public Test {
+    public:
+        BenchTraceReplay(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_BENCH_TRACE_REPLAY_H
@@ -0,0 +1,181 @@
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <simple_rwlock.h>
+#include <simple_rwlock_versioned.h>
+#include <simple_rwlock_test/clock.h>
+#include <simple_rwlock_test/perf_counters.h>
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/benchmarks/bench_common.h>
+#include <simple_rwlock_test/benchmarks/versioned_benchmarks.h>
+
+namespace simple_rwlock_test {
+    using namespace simple_rwlock;
+    using namespace bench_common;
+
+    namespace bench_versioned_reads {
+        const unsigned int num_readers = 4;
+        const unsigned long writes_every_us = 100;
+
+        struct config_t {
+            unsigned long values[32];
+        };
+
+        // The struct guarded by rwlock_t in the copying variant.
+        struct guarded_config_t {
+            rwlock_t rwlock;
+            config_t config;
+        };
+
+        void copy_read_thread(guarded_config_t *guarded,       // Shared
+                              Clock::clk_latency_t *latency)   // Not shared
+        {
+            unsigned long sink = 0;
+            Clock reader_clock;
+            for (unsigned long i = 0; i < bench_iterations; i++) {
+                rwlock_lock_rd(&guarded->rwlock);
+                config_t copy = guarded->config;
+                rwlock_unlock_rd(&guarded->rwlock);
+                sink += copy.values[i % 32];
+            }
+            *latency = reader_clock.latency_from_start();
+            (void)sink;
+        }
+
+        void copy_write_thread(guarded_config_t *guarded,      // Shared
+                               std::atomic<bool> *done)        // Shared
+        {
+            unsigned long generation = 0;
+            while (!done->load()) {
+                config_t next;
+                generation++;
+                for (unsigned int i = 0; i < 32; i++) {
+                    next.values[i] = generation;
+                }
+                rwlock_lock_wr(&guarded->rwlock);
+                guarded->config = next;
+                rwlock_unlock_wr(&guarded->rwlock);
+                std::this_thread::sleep_for(
+                    std::chrono::microseconds(writes_every_us));
+            }
+        }
+
+        void snapshot_read_thread(versioned<config_t> *value,     // Shared
+                                  Clock::clk_latency_t *latency)  // Not shared
+        {
+            unsigned long sink = 0;
+            Clock reader_clock;
+            for (unsigned long i = 0; i < bench_iterations; i++) {
+                versioned<config_t>::snapshot_t snapshot = value->snapshot();
+                sink += snapshot->values[i % 32];
+            }
+            *latency = reader_clock.latency_from_start();
+            (void)sink;
+        }
+
+        void snapshot_write_thread(versioned<config_t> *value,    // Shared
+                                   std::atomic<bool> *done)       // Shared
+        {
+            unsigned long generation = 0;
+            while (!done->load()) {
+                config_t next;
+                generation++;
+                for (unsigned int i = 0; i < 32; i++) {
+                    next.values[i] = generation;
+                }
+                value->publish(next);
+                std::this_thread::sleep_for(
+                    std::chrono::microseconds(writes_every_us));
+            }
+        }
+
+        // Report the throughput of all readers together, and the
+        // average time one read took as seen by each reader.
+        void report(std::string variant_name,
+                    Clock::clk_latency_t total_latency,
+                    const Clock::clk_latency_t *reader_latencies,
+                    const PerfCounters &counters)
+        {
+            print_throughput("bench_versioned_reads", variant_name,
+                             num_readers * bench_iterations, total_latency);
+            print_perf_counters("bench_versioned_reads", variant_name,
+                                num_readers * bench_iterations, counters);
+            Clock::clk_latency_t sum = 0;
+            for (unsigned int i = 0; i < num_readers; i++) {
+                sum += reader_latencies[i];
+            }
+            std::cout << "bench_versioned_reads [" << variant_name
+                << "]: average of " << (sum * 1000.0 /
+                                       (num_readers * bench_iterations))
+                << " nanoseconds per read" << std::endl;
+        }
+    }
+    BenchVersionedReads::BenchVersionedReads(Clock &tester_clock) :
+        Test("bench_versioned_reads", tester_clock)
+    { }
+    int BenchVersionedReads::run_test_body() {
+        using namespace bench_versioned_reads;
+        Clock::clk_latency_t reader_latencies[num_readers];
+
+        { // Variant: copy the struct while holding read access.
+            guarded_config_t guarded;
+            guarded.config = config_t();
+            rwlock_init(&guarded.rwlock);
+            std::atomic<bool> done(false);
+            // The writer takes the last CPU.
+            std::vector<int> cpus = place_threads(
+                "bench_versioned_reads", "rwlock_t copy", num_readers + 1);
+            PerfCounters counters(perf_counters_enabled);
+            counters.start();
+            std::thread writer = start_thread(cpus, num_readers,
+                                              copy_write_thread, &guarded,
+                                              &done);
+            Clock variant_clock;
+            std::vector<std::thread> readers;
+            for (unsigned int i = 0; i < num_readers; i++) {
+                readers.push_back(start_thread(cpus, i, copy_read_thread,
+                                               &guarded, &reader_latencies[i]));
+            }
+            for (auto &reader : readers) {
+                reader.join();
+            }
+            Clock::clk_latency_t latency = variant_clock.latency_from_start();
+            done = true;
+            writer.join();
+            counters.stop();
+            rwlock_uninit(&guarded.rwlock);
+            report("rwlock_t copy", latency, reader_latencies, counters);
+        }
+
+        { // Variant: take a snapshot of a versioned value.
+            versioned<config_t> value((config_t()));
+            std::atomic<bool> done(false);
+            // The writer takes the last CPU.
+            std::vector<int> cpus = place_threads(
+                "bench_versioned_reads", "versioned snapshot", num_readers + 1);
+            PerfCounters counters(perf_counters_enabled);
+            counters.start();
+            std::thread writer = start_thread(cpus, num_readers,
+                                              snapshot_write_thread, &value,
+                                              &done);
+            Clock variant_clock;
+            std::vector<std::thread> readers;
+            for (unsigned int i = 0; i < num_readers; i++) {
+                readers.push_back(start_thread(cpus, i, snapshot_read_thread,
+                                               &value, &reader_latencies[i]));
+            }
+            for (auto &reader : readers) {
+                reader.join();
+            }
+            Clock::clk_latency_t latency = variant_clock.latency_from_start();
+            done = true;
+            writer.join();
+            counters.stop();
+            report("versioned snapshot", latency, reader_latencies, counters);
+        }
+        return 0;
+    }
+}
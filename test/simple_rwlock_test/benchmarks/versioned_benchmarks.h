@@ -0,0 +1,18 @@
+#ifndef SRWLT_BENCH_VERSIONED_H
+#define SRWLT_BENCH_VERSIONED_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // bench_versioned_reads: Have 4 reader threads repeatedly read a
+    // 256 byte struct while one writer thread occasionally replaces it.
+    // Compare the read latency of copying the struct under rwlock_t with
+    // the read latency of taking a snapshot of a versioned value.
+    class BenchVersionedReads : public Test {
+    public:
+        BenchVersionedReads(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_BENCH_VERSIONED_H
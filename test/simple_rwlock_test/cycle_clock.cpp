@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <mutex>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+#include <simple_rwlock_test/cycle_clock.h>
+
+namespace simple_rwlock_test {
+    namespace {
+        // How long to compare the TSC against steady_clock for.
+        const std::chrono::milliseconds calibration_period(20);
+        // How many empty start/stop pairs to take the cheapest of.
+        const unsigned int overhead_samples = 10000;
+
+        std::once_flag calibrate_once;
+
+#ifdef SRWLT_CYCLE_CLOCK_HAVE_TSC
+        // The TSC can only be turned into time if it ticks at a constant
+        // rate in every power state (invariant TSC), and stop_ticks needs
+        // rdtscp.
+        bool cpu_has_usable_tsc() {
+            unsigned int eax, ebx, ecx, edx;
+            if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) == 0 ||
+                eax < 0x80000007) {
+                return false;
+            }
+            __get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx);
+            bool has_rdtscp = (edx & (1u << 27)) != 0;
+            __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+            bool has_invariant_tsc = (edx & (1u << 8)) != 0;
+            return has_rdtscp && has_invariant_tsc;
+        }
+#endif
+    }
+
+    CycleClock::op_stats::op_stats() :
+        num_ops(0),
+        total_ticks(0),
+        min_ticks(std::numeric_limits<clk_ticks_t>::max()),
+        max_ticks(0)
+    { }
+
+    void CycleClock::op_stats::merge(const op_stats &other) {
+        num_ops += other.num_ops;
+        total_ticks += other.total_ticks;
+        min_ticks = std::min(min_ticks, other.min_ticks);
+        max_ticks = std::max(max_ticks, other.max_ticks);
+    }
+
+    double CycleClock::op_stats::mean_nanoseconds() const {
+        if (num_ops == 0) {
+            return 0.0;
+        }
+        return ticks_to_nanoseconds(total_ticks) / num_ops;
+    }
+
+    void CycleClock::calibrate() {
+        std::call_once(calibrate_once, []() {
+#ifdef SRWLT_CYCLE_CLOCK_HAVE_TSC
+            uses_tsc_ = cpu_has_usable_tsc();
+#endif
+            if (uses_tsc_) {
+                // Count TSC cycles across a steady_clock interval.
+                auto steady_begin = std::chrono::steady_clock::now();
+                clk_ticks_t tsc_begin = start_ticks();
+                auto steady_end = steady_begin;
+                while (steady_end - steady_begin < calibration_period) {
+                    steady_end = std::chrono::steady_clock::now();
+                }
+                clk_ticks_t tsc_end = stop_ticks();
+                double period_ns =
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        steady_end - steady_begin).count();
+                ticks_per_ns_ = (tsc_end - tsc_begin) / period_ns;
+            } else {
+                ticks_per_ns_ = 1.0;
+            }
+
+            // The cheapest empty timing is the cost of the readings
+            // themselves, without interrupts or cache misses.
+            overhead_ticks_ = 0;
+            clk_ticks_t min_ticks = std::numeric_limits<clk_ticks_t>::max();
+            for (unsigned int i = 0; i < overhead_samples; i++) {
+                clk_ticks_t start = start_ticks();
+                clk_ticks_t stop = stop_ticks();
+                min_ticks = std::min(min_ticks, stop - start);
+            }
+            overhead_ticks_ = min_ticks;
+        });
+    }
+
+    std::string CycleClock::backend_name() {
+        return uses_tsc_ ? "tsc" : "steady_clock";
+    }
+}
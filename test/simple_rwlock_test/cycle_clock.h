@@ -0,0 +1,109 @@
+#ifndef SRWLT_CYCLE_CLOCK_H
+#define SRWLT_CYCLE_CLOCK_H
+
+#include <chrono>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define SRWLT_CYCLE_CLOCK_HAVE_TSC 1
+#endif
+
+namespace simple_rwlock_test {
+    // Clock for timing single lock operations, which take far less than the
+    // microsecond resolution of Clock. Ticks are TSC cycles when the CPU has
+    // an invariant TSC and rdtscp, and steady_clock nanoseconds otherwise.
+    //
+    // Time an operation by taking start_ticks() before it and stop_ticks()
+    // after it, then passing both to elapsed_ticks(), which subtracts the
+    // cost of taking the two readings. Call calibrate() once before timing
+    // anything; it works out the tick rate and that cost.
+    class CycleClock {
+    public:
+        typedef unsigned long long clk_ticks_t;
+
+        // Summary of the ticks taken by many timings of one kind of
+        // operation. Not shared between threads.
+        typedef struct op_stats {
+            unsigned long num_ops;
+            clk_ticks_t total_ticks;
+            clk_ticks_t min_ticks;
+            clk_ticks_t max_ticks;
+
+            op_stats();
+            void record(clk_ticks_t ticks) {
+                num_ops++;
+                total_ticks += ticks;
+                if (ticks < min_ticks) {
+                    min_ticks = ticks;
+                }
+                if (ticks > max_ticks) {
+                    max_ticks = ticks;
+                }
+            }
+            void merge(const op_stats &other);
+            double mean_nanoseconds() const;
+        } op_stats_t;
+
+        // Pick the backend and measure the tick rate and the overhead of
+        // a start/stop pair. Only the first call does anything.
+        static void calibrate();
+
+        // Whether ticks are TSC cycles rather than nanoseconds.
+        static bool uses_tsc() { return uses_tsc_; }
+        static std::string backend_name();
+        static double ticks_per_nanosecond() { return ticks_per_ns_; }
+        static clk_ticks_t overhead_ticks() { return overhead_ticks_; }
+
+        // Read the clock before the timed operation. Later instructions
+        // are not started before the reading is taken.
+        static inline clk_ticks_t start_ticks() {
+#ifdef SRWLT_CYCLE_CLOCK_HAVE_TSC
+            if (uses_tsc_) {
+                _mm_lfence();
+                return __rdtsc();
+            }
+#endif
+            return steady_ticks();
+        }
+
+        // Read the clock after the timed operation. The reading waits for
+        // earlier instructions to finish.
+        static inline clk_ticks_t stop_ticks() {
+#ifdef SRWLT_CYCLE_CLOCK_HAVE_TSC
+            if (uses_tsc_) {
+                unsigned int aux;
+                clk_ticks_t ticks = __rdtscp(&aux);
+                _mm_lfence();
+                return ticks;
+            }
+#endif
+            return steady_ticks();
+        }
+
+        // Return the ticks between two readings, less the overhead of
+        // taking them. Never negative.
+        static inline clk_ticks_t elapsed_ticks(clk_ticks_t start,
+                                                clk_ticks_t stop)
+        {
+            clk_ticks_t ticks = stop - start;
+            return (ticks > overhead_ticks_) ? ticks - overhead_ticks_ : 0;
+        }
+
+        static double ticks_to_nanoseconds(clk_ticks_t ticks) {
+            return ticks / ticks_per_ns_;
+        }
+
+    private:
+        static inline clk_ticks_t steady_ticks() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        static inline bool uses_tsc_ = false;
+        static inline double ticks_per_ns_ = 1.0;
+        static inline clk_ticks_t overhead_ticks_ = 0;
+    };
+}
+
+#endif // SRWLT_CYCLE_CLOCK_H
@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <limits>
+#include <ostream>
+#include <string>
+
+#include <simple_rwlock_test/cycle_clock.h>
+#include <simple_rwlock_test/histogram.h>
+
+namespace simple_rwlock_test {
+    namespace {
+        const double printed_percentiles[] = { 50.0, 90.0, 99.0, 99.9 };
+        const char *printed_percentile_names[] = {
+            "p50", "p90", "p99", "p99.9"
+        };
+    }
+
+    Histogram::Histogram() {
+        reset();
+    }
+
+    void Histogram::reset() {
+        for (unsigned int i = 0; i < num_buckets; i++) {
+            store_relaxed(counts_[i], 0);
+        }
+        store_relaxed(total_count_, 0);
+        store_relaxed(total_value_, 0);
+        store_relaxed(min_value_, std::numeric_limits<value_t>::max());
+        store_relaxed(max_value_, 0);
+    }
+
+    void Histogram::merge(const Histogram &other) {
+        for (unsigned int i = 0; i < num_buckets; i++) {
+            unsigned long long other_count = load_relaxed(other.counts_[i]);
+            if (other_count > 0) {
+                store_relaxed(counts_[i],
+                              load_relaxed(counts_[i]) + other_count);
+            }
+        }
+        store_relaxed(total_count_, load_relaxed(total_count_) +
+                      load_relaxed(other.total_count_));
+        store_relaxed(total_value_, load_relaxed(total_value_) +
+                      load_relaxed(other.total_value_));
+        store_relaxed(min_value_, std::min(load_relaxed(min_value_),
+                                           load_relaxed(other.min_value_)));
+        store_relaxed(max_value_, std::max(load_relaxed(max_value_),
+                                           load_relaxed(other.max_value_)));
+    }
+
+    Histogram::value_t Histogram::min() const {
+        return (count() == 0) ? 0 : load_relaxed(min_value_);
+    }
+
+    double Histogram::mean() const {
+        unsigned long num_values = count();
+        if (num_values == 0) {
+            return 0.0;
+        }
+        return load_relaxed(total_value_) * 1.0 / num_values;
+    }
+
+    Histogram::value_t Histogram::value_at_percentile(
+        double percentile) const
+    {
+        unsigned long num_values = count();
+        if (num_values == 0) {
+            return 0;
+        }
+        // Rank of the value wanted, counting from 1.
+        unsigned long rank = (unsigned long)(
+            percentile / 100.0 * num_values + 0.5);
+        rank = std::max(1ul, std::min(rank, num_values));
+        unsigned long seen = 0;
+        for (unsigned int i = 0; i < num_buckets; i++) {
+            seen += load_relaxed(counts_[i]);
+            if (seen >= rank) {
+                return std::min(bucket_highest_value(i), max());
+            }
+        }
+        return max();
+    }
+
+    Histogram::value_t Histogram::bucket_lowest_value(unsigned int index) {
+        if (index < sub_bucket_count) {
+            return index;
+        }
+        unsigned int shift = index / sub_bucket_count - 1;
+        value_t sub_bucket = index % sub_bucket_count;
+        return (sub_bucket_count + sub_bucket) << shift;
+    }
+
+    Histogram::value_t Histogram::bucket_highest_value(unsigned int index) {
+        if (index < sub_bucket_count) {
+            return index;
+        }
+        unsigned int shift = index / sub_bucket_count - 1;
+        return bucket_lowest_value(index) + (((value_t)1 << shift) - 1);
+    }
+
+    void Histogram::print_percentiles(std::ostream &out) const {
+        out << "count " << std::dec << count();
+        for (unsigned int i = 0; i < 4; i++) {
+            out << ", " << printed_percentile_names[i] << " "
+                << CycleClock::ticks_to_nanoseconds(
+                       value_at_percentile(printed_percentiles[i]));
+        }
+        out << ", max " << CycleClock::ticks_to_nanoseconds(max())
+            << " (nanoseconds)";
+    }
+
+    void Histogram::write_json(std::ostream &out,
+                               const std::string &fields) const
+    {
+        out << "{" << std::dec;
+        if (!fields.empty()) {
+            out << fields << ", ";
+        }
+        out << "\"unit\": \"ns\", \"ticks_per_ns\": "
+            << CycleClock::ticks_per_nanosecond()
+            << ", \"count\": " << count()
+            << ", \"min\": " << CycleClock::ticks_to_nanoseconds(min())
+            << ", \"mean\": " << mean() / CycleClock::ticks_per_nanosecond();
+        for (unsigned int i = 0; i < 4; i++) {
+            out << ", \"" << printed_percentile_names[i] << "\": "
+                << CycleClock::ticks_to_nanoseconds(
+                       value_at_percentile(printed_percentiles[i]));
+        }
+        out << ", \"max\": " << CycleClock::ticks_to_nanoseconds(max())
+            << ", \"buckets\": [";
+        bool first = true;
+        for (unsigned int i = 0; i < num_buckets; i++) {
+            unsigned long long bucket_count = load_relaxed(counts_[i]);
+            if (bucket_count > 0) {
+                out << (first ? "" : ", ") << "["
+                    << bucket_lowest_value(i) << ", " << bucket_count << "]";
+                first = false;
+            }
+        }
+        out << "]}";
+    }
+
+    void lock_op_histograms::merge(const lock_op_histograms &other) {
+        wait_rd.merge(other.wait_rd);
+        hold_rd.merge(other.hold_rd);
+        wait_wr.merge(other.wait_wr);
+        hold_wr.merge(other.hold_wr);
+    }
+}
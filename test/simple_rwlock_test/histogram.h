@@ -0,0 +1,112 @@
+#ifndef SRWLT_HISTOGRAM_H
+#define SRWLT_HISTOGRAM_H
+
+#include <atomic>
+#include <ostream>
+#include <string>
+
+#include <simple_rwlock_test/cycle_clock.h>
+
+namespace simple_rwlock_test {
+    // Log-linear histogram of CycleClock ticks, in the style of
+    // HdrHistogram. Values below 2^sub_bucket_bits get a bucket each; above
+    // that, each power of two is split into 2^sub_bucket_bits buckets, so
+    // every value is kept to within about 3% across the whole 64-bit range.
+    //
+    // A histogram has one writer: each thread records into its own, without
+    // locks or read-modify-write instructions, and the histograms are
+    // merged afterwards. Counts are relaxed atomics, so another thread may
+    // merge or read a histogram while it is being recorded into.
+    class Histogram {
+    public:
+        typedef CycleClock::clk_ticks_t value_t;
+
+        static const unsigned int sub_bucket_bits = 5;
+        static const unsigned int sub_bucket_count = 1u << sub_bucket_bits;
+        static const unsigned int num_buckets =
+            (65 - sub_bucket_bits) * sub_bucket_count;
+
+        Histogram();
+        Histogram(const Histogram &) = delete;
+        Histogram &operator=(const Histogram &) = delete;
+
+        void record(value_t value) {
+            unsigned int index = bucket_index(value);
+            store_relaxed(counts_[index], load_relaxed(counts_[index]) + 1);
+            store_relaxed(total_count_, load_relaxed(total_count_) + 1);
+            store_relaxed(total_value_, load_relaxed(total_value_) + value);
+            if (value < load_relaxed(min_value_)) {
+                store_relaxed(min_value_, value);
+            }
+            if (value > load_relaxed(max_value_)) {
+                store_relaxed(max_value_, value);
+            }
+        }
+
+        // Add the counts of other into this histogram. Only the
+        // writer of this histogram may call this.
+        void merge(const Histogram &other);
+        void reset();
+
+        unsigned long count() const { return load_relaxed(total_count_); }
+        value_t min() const;
+        value_t max() const { return load_relaxed(max_value_); }
+        double mean() const;
+
+        // Return the highest value that is in the same bucket as the value
+        // below which percentile percent of the recorded values fall.
+        value_t value_at_percentile(double percentile) const;
+
+        // Print count, p50, p90, p99, p99.9 and max in nanoseconds.
+        void print_percentiles(std::ostream &out) const;
+
+        // Write one JSON object, without a trailing newline, holding the
+        // summary in nanoseconds and every non-empty bucket as
+        // [lowest tick value, count]. fields is inserted before them as
+        // already-formatted "key": value pairs, and may be empty.
+        void write_json(std::ostream &out, const std::string &fields) const;
+
+        static unsigned int bucket_index(value_t value) {
+            if (value < sub_bucket_count) {
+                return value;
+            }
+            unsigned int magnitude = 63 - __builtin_clzll(value);
+            unsigned int shift = magnitude - sub_bucket_bits;
+            return (shift + 1) * sub_bucket_count +
+                (value >> shift) - sub_bucket_count;
+        }
+        static value_t bucket_lowest_value(unsigned int index);
+        static value_t bucket_highest_value(unsigned int index);
+
+    private:
+        typedef std::atomic<unsigned long long> counter_t;
+
+        static unsigned long long load_relaxed(const counter_t &counter) {
+            return counter.load(std::memory_order_relaxed);
+        }
+        static void store_relaxed(counter_t &counter,
+                                  unsigned long long value)
+        {
+            counter.store(value, std::memory_order_relaxed);
+        }
+
+        counter_t counts_[num_buckets];
+        counter_t total_count_;
+        counter_t total_value_;
+        counter_t min_value_;
+        counter_t max_value_;
+    };
+
+    // Acquire-wait and hold times of each kind of lock operation,
+    // recorded by one thread.
+    typedef struct lock_op_histograms {
+        Histogram wait_rd;
+        Histogram hold_rd;
+        Histogram wait_wr;
+        Histogram hold_wr;
+
+        void merge(const lock_op_histograms &other);
+    } lock_op_histograms_t;
+}
+
+#endif // SRWLT_HISTOGRAM_H
@@ -0,0 +1,144 @@
+#include <string>
+
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <simple_rwlock_test/perf_counters.h>
+
+namespace simple_rwlock_test {
+    namespace {
+        struct event_config_t {
+            const char *name;
+            unsigned int type;
+            unsigned long long config;
+        };
+
+        const event_config_t event_configs[PerfCounters::num_events] = {
+            { "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+            { "instructions", PERF_TYPE_HARDWARE,
+              PERF_COUNT_HW_INSTRUCTIONS },
+            { "cache-misses", PERF_TYPE_HARDWARE,
+              PERF_COUNT_HW_CACHE_MISSES },
+            { "LLC-misses", PERF_TYPE_HW_CACHE,
+              PERF_COUNT_HW_CACHE_LL |
+              (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+              (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+            { "context-switches", PERF_TYPE_SOFTWARE,
+              PERF_COUNT_SW_CONTEXT_SWITCHES },
+            { "cpu-migrations", PERF_TYPE_SOFTWARE,
+              PERF_COUNT_SW_CPU_MIGRATIONS },
+        };
+
+        // Value, time enabled and time running, as
+        // laid out by the read_format used below.
+        struct read_value_t {
+            unsigned long long value;
+            unsigned long long time_enabled;
+            unsigned long long time_running;
+        };
+
+        int open_event(const event_config_t &config, bool exclude_kernel) {
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = config.type;
+            attr.config = config.config;
+            attr.disabled = 1;
+            // Count threads created after the event is opened.
+            attr.inherit = 1;
+            attr.exclude_kernel = exclude_kernel ? 1 : 0;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                PERF_FORMAT_TOTAL_TIME_RUNNING;
+            return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        }
+
+        // Count kernel time if allowed, since context switches and
+        // migrations only happen there. Unprivileged users may only count
+        // user space when perf_event_paranoid is 2, a common default.
+        int open_event(const event_config_t &config) {
+            int fd = open_event(config, false);
+            if (fd < 0 && (errno == EACCES || errno == EPERM)) {
+                fd = open_event(config, true);
+            }
+            return fd;
+        }
+    }
+
+    PerfCounters::PerfCounters(bool enabled) :
+        enabled_(enabled)
+    {
+        int first_errno = 0;
+        for (int i = 0; i < num_events; i++) {
+            fds_[i] = enabled ? open_event(event_configs[i]) : -1;
+            values_[i] = 0.0;
+            if (fds_[i] < 0 && first_errno == 0) {
+                first_errno = errno;
+            }
+        }
+        if (enabled && !any_available()) {
+            reason_ = std::string("perf_event_open failed: ") +
+                strerror(first_errno);
+            if (first_errno == EACCES || first_errno == EPERM) {
+                reason_ += " (see /proc/sys/kernel/perf_event_paranoid)";
+            }
+        }
+    }
+
+    PerfCounters::~PerfCounters() {
+        for (int i = 0; i < num_events; i++) {
+            if (fds_[i] >= 0) {
+                close(fds_[i]);
+            }
+        }
+    }
+
+    bool PerfCounters::any_available() const {
+        for (int i = 0; i < num_events; i++) {
+            if (fds_[i] >= 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void PerfCounters::start() {
+        for (int i = 0; i < num_events; i++) {
+            if (fds_[i] >= 0) {
+                ioctl(fds_[i], PERF_EVENT_IOC_RESET, 0);
+                ioctl(fds_[i], PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+    }
+
+    void PerfCounters::stop() {
+        for (int i = 0; i < num_events; i++) {
+            if (fds_[i] < 0) {
+                continue;
+            }
+            ioctl(fds_[i], PERF_EVENT_IOC_DISABLE, 0);
+            read_value_t reading;
+            if (read(fds_[i], &reading, sizeof(reading)) !=
+                sizeof(reading)) {
+                values_[i] = 0.0;
+                continue;
+            }
+            if (reading.time_running == 0) {
+                values_[i] = 0.0;
+            } else if (reading.time_running < reading.time_enabled) {
+                values_[i] = reading.value * 1.0 * reading.time_enabled /
+                    reading.time_running;
+            } else {
+                values_[i] = reading.value;
+            }
+        }
+    }
+
+    const char *PerfCounters::event_name(event_t event) {
+        return event_configs[event].name;
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef SRWLT_PERF_COUNTERS_H
+#define SRWLT_PERF_COUNTERS_H
+
+#include <string>
+
+namespace simple_rwlock_test {
+    // Hardware and software event counters read through perf_event_open,
+    // counting the calling thread and every thread it starts after start().
+    //
+    // Each event is opened on its own, so an event the CPU, kernel or
+    // perf_event_paranoid setting does not allow is reported as
+    // unavailable without affecting the others. If perf_event_open is
+    // not allowed at all, every event is unavailable and nothing fails.
+    class PerfCounters {
+    public:
+        enum event_t {
+            cycles = 0,
+            instructions,
+            cache_misses,
+            llc_misses,
+            context_switches,
+            cpu_migrations,
+            num_events
+        };
+
+        // Counters are only opened if enabled is true.
+        explicit PerfCounters(bool enabled);
+        ~PerfCounters();
+        PerfCounters(const PerfCounters &) = delete;
+        PerfCounters &operator=(const PerfCounters &) = delete;
+
+        // Reset and start counting. Threads must be started after this
+        // to be counted.
+        void start();
+        // Stop counting and read the counts.
+        void stop();
+
+        bool enabled() const { return enabled_; }
+        bool available(event_t event) const { return fds_[event] >= 0; }
+        bool any_available() const;
+        // Count of the event between start() and stop(), scaled up if the
+        // kernel had to share the hardware counter with other events.
+        double value(event_t event) const { return values_[event]; }
+
+        static const char *event_name(event_t event);
+        // Why no event could be opened, or empty if some could.
+        const std::string &unavailable_reason() const { return reason_; }
+
+    private:
+        bool enabled_;
+        int fds_[num_events];
+        double values_[num_events];
+        std::string reason_;
+    };
+}
+
+#endif // SRWLT_PERF_COUNTERS_H
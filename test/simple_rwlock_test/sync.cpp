@@ -0,0 +1,26 @@
+#include <condition_variable>
+#include <mutex>
+
+#include <simple_rwlock_test/sync.h>
+
+namespace simple_rwlock_test {
+    StepSequencer::StepSequencer() :
+        step_(0)
+    { }
+
+    void StepSequencer::wait_for(unsigned int step) {
+        std::unique_lock<std::mutex> guard(mutex_);
+        advanced_.wait(guard, [this, step]() { return step_ >= step; });
+    }
+
+    void StepSequencer::advance() {
+        std::lock_guard<std::mutex> guard(mutex_);
+        step_++;
+        advanced_.notify_all();
+    }
+
+    unsigned int StepSequencer::current_step() {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return step_;
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef SRWLT_SYNC_H
+#define SRWLT_SYNC_H
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Synchronization for forcing test threads through an exact interleaving
+// instead of sleeping and hoping the scheduler cooperates, beyond what
+// std::latch and std::barrier already provide. None of these time out;
+// the tester kills a test that hangs.
+namespace simple_rwlock_test {
+    // Numbered script shared by several threads. A thread calls
+    // wait_for(n) before its part of step n and advance() after it, so
+    // steps happen strictly in order no matter how threads are scheduled.
+    class StepSequencer {
+    public:
+        StepSequencer();
+        StepSequencer(const StepSequencer &) = delete;
+        StepSequencer &operator=(const StepSequencer &) = delete;
+
+        void wait_for(unsigned int step);
+        void advance();
+        unsigned int current_step();
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable advanced_;
+        unsigned int step_;
+    };
+
+    // Yield until predicate() is true. For waiting on state that has no
+    // way to notify, such as another thread having started to wait
+    // inside a lock call.
+    template <typename Predicate>
+    void spin_until(Predicate predicate) {
+        while (!predicate()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+#endif // SRWLT_SYNC_H
@@ -1,16 +1,60 @@
 #include <algorithm>
+#include <chrono>
 #include <iomanip>
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
 #include <vector>
 
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
 #include <simple_rwlock_test/clock.h>
+#include <simple_rwlock_test/cycle_clock.h>
 #include <simple_rwlock_test/test.h>
 #include <simple_rwlock_test/tests/single_thread_tests.h>
 #include <simple_rwlock_test/tests/two_thread_tests.h>
 #include <simple_rwlock_test/tests/multi_thread_tests.h>
+#include <simple_rwlock_test/tests/numa_tests.h>
+#include <simple_rwlock_test/tests/elided_tests.h>
+#include <simple_rwlock_test/tests/async_tests.h>
+#include <simple_rwlock_test/tests/combining_tests.h>
+#include <simple_rwlock_test/tests/versioned_tests.h>
+#include <simple_rwlock_test/tests/cycle_clock_tests.h>
+#include <simple_rwlock_test/tests/histogram_tests.h>
+#include <simple_rwlock_test/tests/trace_tests.h>
+#include <simple_rwlock_test/tests/topology_tests.h>
+#include <simple_rwlock_test/tests/compact_tests.h>
+#include <simple_rwlock_test/tests/cond_tests.h>
+#include <simple_rwlock_test/tests/yield_tests.h>
+#include <simple_rwlock_test/tests/pi_tests.h>
+#include <simple_rwlock_test/tests/range_tests.h>
+#include <simple_rwlock_test/tests/intention_tests.h>
+#include <simple_rwlock_test/tests/adaptive_tests.h>
+#include <simple_rwlock_test/tests/profile_tests.h>
+#include <simple_rwlock_test/benchmarks/bench_common.h>
+#include <simple_rwlock_test/benchmarks/numa_benchmarks.h>
+#include <simple_rwlock_test/benchmarks/combining_benchmarks.h>
+#include <simple_rwlock_test/benchmarks/versioned_benchmarks.h>
+#include <simple_rwlock_test/benchmarks/basic_rwlock_benchmarks.h>
+#include <simple_rwlock_test/benchmarks/op_latency_benchmarks.h>
+#include <simple_rwlock_test/benchmarks/baseline_benchmarks.h>
+#include <simple_rwlock_test/benchmarks/trace_replay_benchmarks.h>
+#include <simple_rwlock_test/benchmarks/oversubscription_benchmarks.h>
+#include <simple_rwlock_test/benchmarks/range_benchmarks.h>
+#include <simple_rwlock_test/benchmarks/cache_benchmarks.h>
 #include <simple_rwlock_test/tester.h>
 
 namespace simple_rwlock_test {
+    const unsigned int default_timeout_seconds = 120;
+
     Tester::Tester() :
         tester_clock_(Clock()),
         tests_(std::vector<Test *>())
@@ -29,6 +73,45 @@ namespace simple_rwlock_test {
         tests_.push_back(new TestTwoThreadReadWaitForOtherRead(tester_clock_));
         tests_.push_back(new TestTwoThreadReadWaitForOtherWrite(tester_clock_));
         tests_.push_back(new TestManyReadersOneWriter(tester_clock_));
+        tests_.push_back(new TestNumaReadersWriters(tester_clock_));
+        tests_.push_back(new TestNumaHandoff(tester_clock_));
+        tests_.push_back(new TestElidedReadersWriters(tester_clock_));
+        tests_.push_back(new TestElidedOutOfOrder(tester_clock_));
+        tests_.push_back(new TestAsyncWriterBias(tester_clock_));
+        tests_.push_back(new TestAsyncInterleaved(tester_clock_));
+        tests_.push_back(new TestCombiningReadersWriters(tester_clock_));
+        tests_.push_back(new TestVersionedSnapshotLifetime(tester_clock_));
+        tests_.push_back(new TestVersionedReadersWriters(tester_clock_));
+        tests_.push_back(new TestCycleClockCalibration(tester_clock_));
+        tests_.push_back(new TestHistogramPercentiles(tester_clock_));
+        tests_.push_back(new TestTraceRoundTrip(tester_clock_));
+        tests_.push_back(new TestTraceManyLocks(tester_clock_));
+        tests_.push_back(new TestTraceLongWait(tester_clock_));
+        tests_.push_back(new TestTraceReadCorrupt(tester_clock_));
+        tests_.push_back(new TestTopologyPlacement(tester_clock_));
+        tests_.push_back(new TestCompactReadersWriters(tester_clock_));
+        tests_.push_back(new TestCondBroadcast(tester_clock_));
+        tests_.push_back(new TestCondSignalTimed(tester_clock_));
+        tests_.push_back(new TestYield(tester_clock_));
+        tests_.push_back(new TestPiBoundedInversion(tester_clock_));
+        tests_.push_back(new TestPiAfterFork(tester_clock_));
+        tests_.push_back(new TestRangeOverlaps(tester_clock_));
+        tests_.push_back(new TestRangeBounds(tester_clock_));
+        tests_.push_back(new TestIntentionHierarchy(tester_clock_));
+        tests_.push_back(new TestAdaptiveSwitching(tester_clock_));
+        tests_.push_back(new TestProfileCallSites(tester_clock_));
+
+        benchmarks_.push_back(new BenchNumaCrossNode(tester_clock_));
+        benchmarks_.push_back(new BenchCombiningManyWriters(tester_clock_));
+        benchmarks_.push_back(new BenchVersionedReads(tester_clock_));
+        benchmarks_.push_back(
+            new BenchBasicRwlockConfigurations(tester_clock_));
+        benchmarks_.push_back(new BenchLockOpLatency(tester_clock_));
+        benchmarks_.push_back(new BenchBaselineComparison(tester_clock_));
+        benchmarks_.push_back(new BenchTraceReplay(tester_clock_));
+        benchmarks_.push_back(new BenchOversubscription(tester_clock_));
+        benchmarks_.push_back(new BenchRangeRandom(tester_clock_));
+        benchmarks_.push_back(new BenchCache(tester_clock_));
     }
 
     Tester::~Tester() {
@@ -39,46 +122,308 @@ namespace simple_rwlock_test {
         for (auto test : tests_) {
             delete test;
         }
+        for (auto benchmark : benchmarks_) {
+            delete benchmark;
+        }
     }
 
-    int Tester::run_tests() {
-        std::vector<std::string> failure_messages;
-        std::vector<test_result_t> test_results;
-        size_t max_name_length = 0;
+    bool Tester::parse_options(int argc, char *argv[],
+                               tester_options_t &options)
+    {
+        options.num_jobs = std::max(1u, std::thread::hardware_concurrency());
+        options.timeout_seconds = default_timeout_seconds;
+        options.list_only = false;
+        options.results_path.clear();
+        options.perf_counters = false;
+        options.replay_trace_path.clear();
+        options.placement = Topology::placement_unpinned;
+        options.filters.clear();
+        int opt;
+        while ((opt = getopt(argc, argv, "j:t:o:pT:P:lh")) != -1) {
+            switch (opt) {
+            case 'j':
+                options.num_jobs = std::max(1, atoi(optarg));
+                break;
+            case 't':
+                options.timeout_seconds = std::max(0, atoi(optarg));
+                break;
+            case 'o':
+                options.results_path = optarg;
+                break;
+            case 'p':
+                options.perf_counters = true;
+                break;
+            case 'T':
+                options.replay_trace_path = optarg;
+                break;
+            case 'P':
+                if (!Topology::parse_placement(optarg, &options.placement)) {
+                    std::cerr << "Unknown placement " << optarg
+                        << "; expected one of";
+                    for (int i = 0; i < Topology::num_placements; i++) {
+                        std::cerr << " " << Topology::placement_name(
+                            (Topology::placement_t)i);
+                    }
+                    std::cerr << std::endl;
+                    return false;
+                }
+                break;
+            case 'l':
+                options.list_only = true;
+                break;
+            default:
+                std::cerr << "Usage: " << argv[0]
+                    << " [-j jobs] [-t timeout_seconds] [-o results_file]"
+                    << " [-p] [-T trace_file] [-P placement] [-l]"
+                    << " [filter ...]"
+                    << std::endl
+                    << "  -j  number of tests to run at the same time"
+                    << " (default: number of CPUs)" << std::endl
+                    << "  -t  kill and fail a test after this many seconds"
+                    << " (default: " << default_timeout_seconds
+                    << ", 0 for no limit)" << std::endl
+                    << "  -o  append benchmark results to this file as"
+                    << " JSON lines" << std::endl
+                    << "  -p  count cycles, instructions, cache misses,"
+                    << " context switches and CPU migrations per operation"
+                    << " in benchmarks" << std::endl
+                    << "  -T  replay this lock trace in bench_trace_replay"
+                    << std::endl
+                    << "  -P  pin benchmark threads: unpinned (default),"
+                    << " compact, scatter, smt-siblings or one-per-core"
+                    << std::endl
+                    << "  -l  list the selected tests without running them"
+                    << std::endl
+                    << "  filter  run only tests whose names contain it"
+                    << std::endl;
+                return false;
+            }
+        }
+        for (int i = optind; i < argc; i++) {
+            options.filters.push_back(argv[i]);
+        }
+        return true;
+    }
+
+    bool Tester::is_selected(const Test *test,
+                             const tester_options_t &options) const
+    {
+        if (options.filters.empty()) {
+            return true;
+        }
+        std::string name = test->get_name();
+        for (const auto &filter : options.filters) {
+            if (name.find(filter) != std::string::npos) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Run the test in a child process, so that a test which hangs can be
+    // killed, and a test which crashes or fails an assertion is reported
+    // instead of taking the tester down with it.
+    bool Tester::start_test(Test *test, const tester_options_t &options,
+                            running_test_t &running)
+    {
+        int latency_pipe[2];
+        FILE *output_file = tmpfile();
+        if (output_file == NULL || pipe(latency_pipe) != 0) {
+            if (output_file != NULL) {
+                fclose(output_file);
+            }
+            return false;
+        }
+        // Anything still buffered would otherwise be printed by both
+        // processes.
+        std::cout.flush();
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid < 0) {
+            fclose(output_file);
+            close(latency_pipe[0]);
+            close(latency_pipe[1]);
+            return false;
+        }
+        if (pid == 0) {
+            close(latency_pipe[0]);
+            dup2(fileno(output_file), STDOUT_FILENO);
+            dup2(fileno(output_file), STDERR_FILENO);
+            Clock::clk_latency_t latency = 0;
+            int result = test->run_test(latency);
+            std::cout.flush();
+            fflush(stdout);
+            if (write(latency_pipe[1], &latency, sizeof(latency)) !=
+                sizeof(latency)) {
+                result = 1;
+            }
+            _exit(result ? 1 : 0);
+        }
+        close(latency_pipe[1]);
+        running.test = test;
+        running.pid = pid;
+        running.output_file = output_file;
+        running.latency_fd = latency_pipe[0];
+        running.deadline = (options.timeout_seconds == 0) ? 0 :
+            tester_clock_.latency_from_start() +
+            options.timeout_seconds * 1000000L;
+        return true;
+    }
+
+    void Tester::finish_test(running_test_t &running, int status,
+                             bool timed_out, const tester_options_t &options)
+    {
+        // Print the test's output in one piece, so the output
+        // of tests that ran at the same time is not interleaved.
+        std::cout << std::endl;
+        rewind(running.output_file);
+        char buffer[4096];
+        size_t num_read;
+        while ((num_read = fread(buffer, 1, sizeof(buffer),
+                                 running.output_file)) > 0) {
+            std::cout.write(buffer, num_read);
+        }
+        fclose(running.output_file);
+
+        Clock::clk_latency_t latency = 0;
+        bool have_latency = read(running.latency_fd, &latency,
+                                 sizeof(latency)) == sizeof(latency);
+        close(running.latency_fd);
+
+        std::string name = running.test->get_name();
+        std::stringstream message;
+        message << name;
+        if (timed_out) {
+            message << " (timed out after " << options.timeout_seconds
+                << " seconds)";
+        } else if (WIFSIGNALED(status)) {
+            message << " (killed by signal " << WTERMSIG(status) << ": "
+                << strsignal(WTERMSIG(status)) << ")";
+        } else if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 ||
+                   !have_latency) {
+            message << " (failed)";
+        } else {
+            test_result_t result;
+            result.test_name = name;
+            result.test_time = latency;
+            test_results_.push_back(result);
+            return;
+        }
+        std::cout << "Test " << message.str() << std::endl;
+        failure_messages_.push_back(message.str());
+    }
+
+    void Tester::run_pool(const std::vector<Test *> &tests,
+                          unsigned int num_jobs,
+                          const tester_options_t &options)
+    {
+        std::vector<running_test_t> running_tests;
+        size_t next_test = 0;
+        while (next_test < tests.size() || !running_tests.empty()) {
+            while (next_test < tests.size() &&
+                   running_tests.size() < num_jobs) {
+                Test *test = tests[next_test++];
+                running_test_t running;
+                if (start_test(test, options, running)) {
+                    running_tests.push_back(running);
+                } else {
+                    std::cout << std::endl << "Could not start test "
+                        << std::quoted(test->get_name()) << ": "
+                        << strerror(errno) << std::endl;
+                    failure_messages_.push_back(test->get_name() +
+                                                " (could not start)");
+                }
+            }
+            bool any_finished = false;
+            for (size_t i = 0; i < running_tests.size(); ) {
+                running_test_t &running = running_tests[i];
+                int status = 0;
+                bool timed_out = false;
+                pid_t waited = waitpid(running.pid, &status, WNOHANG);
+                if (waited == 0 && running.deadline != 0 &&
+                    tester_clock_.latency_from_start() > running.deadline) {
+                    kill(running.pid, SIGKILL);
+                    waitpid(running.pid, &status, 0);
+                    timed_out = true;
+                } else if (waited == 0) {
+                    i++;
+                    continue;
+                }
+                finish_test(running, status, timed_out, options);
+                running_tests.erase(running_tests.begin() + i);
+                any_finished = true;
+            }
+            if (!any_finished && !running_tests.empty()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+        }
+    }
+
+    int Tester::run_tests(const tester_options_t &options) {
+        std::vector<Test *> selected_tests;
+        std::vector<Test *> selected_benchmarks;
         for (auto test : tests_) {
-            std::cout << std::endl;
-            Clock::clk_latency_t latency;
-            std::string name = test->get_name();
-            if (test->run_test(latency)) {
-                failure_messages.push_back(name);
-            } else {
-                max_name_length = std::max(max_name_length, name.length());
-                test_result_t result;
-                result.test_name = name;
-                result.test_time = latency;
-                test_results.push_back(result);
+            if (is_selected(test, options)) {
+                selected_tests.push_back(test);
             }
         }
+        for (auto benchmark : benchmarks_) {
+            if (is_selected(benchmark, options)) {
+                selected_benchmarks.push_back(benchmark);
+            }
+        }
+        if (options.list_only) {
+            for (auto test : selected_tests) {
+                std::cout << test->get_name() << std::endl;
+            }
+            for (auto benchmark : selected_benchmarks) {
+                std::cout << benchmark->get_name() << std::endl;
+            }
+            return 0;
+        }
+        if (selected_tests.empty() && selected_benchmarks.empty()) {
+            std::cout << "No tests match the given filters" << std::endl;
+            return 1;
+        }
+
+        // Calibrate once here, so that every child process
+        // inherits the result instead of calibrating itself.
+        CycleClock::calibrate();
+        bench_common::results_path = options.results_path;
+        bench_common::perf_counters_enabled = options.perf_counters;
+        bench_common::replay_trace_path = options.replay_trace_path;
+        bench_common::placement = options.placement;
+        failure_messages_.clear();
+        test_results_.clear();
+        run_pool(selected_tests, options.num_jobs, options);
+        // Benchmarks would measure each other if run at the same time.
+        run_pool(selected_benchmarks, 1, options);
+
         std::cout << std::endl;
-        size_t num_failed = failure_messages.size();
+        size_t num_failed = failure_messages_.size();
         if (num_failed > 0) {
             std::cout << num_failed << " failed "
                 << ((num_failed == 1) ? "test" : "tests") << ":" << std::endl;
-            for (const auto &message : failure_messages) {
+            for (const auto &message : failure_messages_) {
                 std::cout << "\t" << message << std::endl;
             }
             std::cout << std::endl;
         } else {
             std::cout << "All tests passed" << std::endl << std::endl;
         }
+        size_t max_name_length = 0;
+        for (const auto &result : test_results_) {
+            max_name_length = std::max(max_name_length,
+                                       result.test_name.length());
+        }
         std::cout << "Summary of passing tests and run times:" << std::endl;
-        for (const auto &result : test_results) {
+        for (const auto &result : test_results_) {
             std::cout << std::setw(max_name_length)
                 << std::setfill(' ') << result.test_name << ": ";
             std::cout << Clock::latency_to_string(result.test_time)
                 << std::endl;
         }
         std::cout << std::endl;
-        return 0;
+        return (num_failed > 0) ? 1 : 0;
     }
 }
@@ -4,15 +4,52 @@
 #include <string>
 #include <vector>
 
+#include <sys/types.h>
+
+#include <stdio.h>
+
 #include <simple_rwlock_test/clock.h>
 #include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/topology.h>
 
 namespace simple_rwlock_test {
+    // Options taken from the command line of the test binary.
+    typedef struct tester_options {
+        // Number of tests to run at the same time. Benchmarks
+        // always run one at a time, after all other tests.
+        unsigned int num_jobs;
+        // Number of seconds a test may run before it is killed
+        // and reported as failed. Zero means no limit.
+        unsigned int timeout_seconds;
+        // Only print the names of the selected tests.
+        bool list_only;
+        // File that benchmarks append machine-readable results
+        // to, or empty for none.
+        std::string results_path;
+        // Count hardware and software events in benchmarks.
+        bool perf_counters;
+        // Trace for bench_trace_replay to replay, or empty to
+        // record and replay a synthetic one.
+        std::string replay_trace_path;
+        // Where benchmark threads are pinned.
+        Topology::placement_t placement;
+        // Run only tests whose names contain one of these
+        // strings. All tests run if there are none.
+        std::vector<std::string> filters;
+    } tester_options_t;
+
     class Tester {
     public:
         Tester();
         ~Tester();
-        int run_tests();
+
+        // Fill options from argc and argv. Return false and print
+        // usage if the arguments are not understood.
+        static bool parse_options(int argc, char *argv[],
+                                  tester_options_t &options);
+
+        // Return 0 if every selected test passed, and 1 otherwise.
+        int run_tests(const tester_options_t &options);
 
     private:
         typedef struct test_result {
@@ -20,8 +57,30 @@ namespace simple_rwlock_test {
             Clock::clk_latency_t test_time;
         } test_result_t;
 
+        // A test running in a child process. The child's output
+        // goes to output_file and its latency to latency_fd.
+        typedef struct running_test {
+            Test *test;
+            pid_t pid;
+            FILE *output_file;
+            int latency_fd;
+            Clock::clk_latency_t deadline;
+        } running_test_t;
+
+        bool is_selected(const Test *test,
+                         const tester_options_t &options) const;
+        bool start_test(Test *test, const tester_options_t &options,
+                        running_test_t &running);
+        void finish_test(running_test_t &running, int status, bool timed_out,
+                         const tester_options_t &options);
+        void run_pool(const std::vector<Test *> &tests, unsigned int num_jobs,
+                      const tester_options_t &options);
+
         Clock tester_clock_;
         std::vector<Test *> tests_;
+        std::vector<Test *> benchmarks_;
+        std::vector<std::string> failure_messages_;
+        std::vector<test_result_t> test_results_;
     };
 }
 
@@ -0,0 +1,140 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <simple_rwlock_adaptive.h>
+#include <simple_rwlock_test/sync.h>
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/tests/test_common.h>
+#include <simple_rwlock_test/tests/adaptive_tests.h>
+
+namespace simple_rwlock_test {
+    using namespace simple_rwlock;
+    using namespace test_common;
+
+    // A small window, so that the test switches modes within a few
+    // hundred lock operations.
+    namespace test_adaptive_switching {
+        const unsigned long window = 64;
+        const unsigned long max_windows = 8;
+        const unsigned int num_readers = 2;
+
+        typedef struct shared_state_t {
+            adaptive_rwlock_t rwlock;
+            unsigned long first;
+            unsigned long second;
+            std::atomic<bool> writes_done;
+        } shared_state_t;
+
+        adaptive_rwlock_mode_t mode(adaptive_rwlock_t *rwlock) {
+            adaptive_rwlock_stats_t stats;
+            adaptive_rwlock_get_stats(rwlock, &stats);
+            return stats.mode;
+        }
+
+        // Confirm the pair of counters is equal on every read, until the
+        // writer is done.
+        void read_thread(shared_state_t *state,     // Shared
+                         bool *read_pass)           // Not shared
+        {
+            TEST_DLOG_THREAD_LAUNCH("read thread");
+            while (!state->writes_done) {
+                adaptive_rwlock_lock_rd(&state->rwlock);
+                unsigned long first = state->first;
+                std::this_thread::yield();
+                *read_pass &= (first == state->second);
+                adaptive_rwlock_unlock_rd(&state->rwlock);
+            }
+        }
+
+        // Update the pair, giving readers the chance to look in between
+        // the two counters, until the writes switch the lock back to the
+        // central mode.
+        void write_thread(shared_state_t *state,        // Shared
+                          unsigned long *num_writes)    // Not shared
+        {
+            TEST_DLOG_THREAD_LAUNCH("write thread");
+            do {
+                adaptive_rwlock_lock_wr(&state->rwlock);
+                state->first++;
+                std::this_thread::yield();
+                state->second++;
+                adaptive_rwlock_unlock_wr(&state->rwlock);
+                (*num_writes)++;
+                std::this_thread::yield();
+            } while (mode(&state->rwlock) != adaptive_rwlock_mode_central &&
+                     *num_writes < max_windows * window);
+            state->writes_done = true;
+        }
+
+        bool run_with_window_zero() {
+            adaptive_rwlock_t rwlock;
+            adaptive_rwlock_init(&rwlock);
+            rwlock.window = 0;
+            for (unsigned int i = 0; i < 4; i++) {
+                adaptive_rwlock_lock_rd(&rwlock);
+                adaptive_rwlock_unlock_rd(&rwlock);
+                adaptive_rwlock_lock_wr(&rwlock);
+                adaptive_rwlock_unlock_wr(&rwlock);
+            }
+            adaptive_rwlock_stats_t stats;
+            adaptive_rwlock_get_stats(&rwlock, &stats);
+            adaptive_rwlock_uninit(&rwlock);
+            return (stats.num_reads == 4) && (stats.num_writes == 4);
+        }
+    }
+    TestAdaptiveSwitching::TestAdaptiveSwitching(Clock &tester_clock) :
+        Test("adaptive_switching", tester_clock)
+    { }
+    int TestAdaptiveSwitching::run_test_body() {
+        using namespace test_adaptive_switching;
+        shared_state_t state;
+        adaptive_rwlock_init(&state.rwlock);
+        state.rwlock.window = window;
+        state.first = 0;
+        state.second = 0;
+        state.writes_done = false;
+
+        // Every read of the reader threads overlaps this one, so the
+        // window is all shared reads. The reader that ends the window
+        // waits as a writer for this read to be released before
+        // switching, and the writer thread queues up behind it.
+        adaptive_rwlock_lock_rd(&state.rwlock);
+        bool read_pass[num_readers] = { true, true };
+        std::vector<std::thread> readers;
+        for (unsigned int i = 0; i < num_readers; i++) {
+            readers.push_back(std::thread(read_thread, &state,
+                                          &read_pass[i]));
+        }
+        spin_until([&state]() {
+            return state.rwlock.num_active_writers.load() != 0;
+        });
+        unsigned long num_writes = 0;
+        std::thread writer(write_thread, &state, &num_writes);
+        spin_until([&state]() {
+            return state.rwlock.num_active_writers.load() == 2;
+        });
+        bool pass = (mode(&state.rwlock) == adaptive_rwlock_mode_central);
+        adaptive_rwlock_unlock_rd(&state.rwlock);
+        writer.join();
+        for (auto &reader : readers) {
+            reader.join();
+        }
+        for (unsigned int i = 0; i < num_readers; i++) {
+            pass &= read_pass[i];
+        }
+
+        adaptive_rwlock_stats_t stats;
+        adaptive_rwlock_get_stats(&state.rwlock, &stats);
+        pass &= (stats.mode == adaptive_rwlock_mode_central);
+        pass &= (stats.num_switches_to_distributed >= 1);
+        pass &= (stats.num_switches_to_central >= 1);
+        pass &= (stats.num_writes == num_writes);
+        pass &= (state.first == num_writes) && (state.second == num_writes);
+        pass &= (stats.num_shared_reads >= window - 1);
+        adaptive_rwlock_uninit(&state.rwlock);
+
+        pass &= run_with_window_zero();
+        return (pass ? 0 : 1);
+    }
+}
@@ -0,0 +1,23 @@
+#ifndef SRWLT_TEST_ADAPTIVE_H
+#define SRWLT_TEST_ADAPTIVE_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // test_adaptive_switching: Have 2 reader threads read a pair of
+    // counters on an adaptive_rwlock_t while a read held by the main
+    // thread makes every read of the first window overlap, so that the
+    // lock switches to the distributed mode. Have a writer thread wait
+    // for write access across that switch, and then keep updating the
+    // pair until its writes switch the lock back to the central mode.
+    // Confirm no reader ever sees the pair half updated, both switches
+    // happened, and the stats count every write. Then confirm a window
+    // of 0 does not stop the lock from working.
+    class TestAdaptiveSwitching : public Test {
+    public:
+        TestAdaptiveSwitching(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_TEST_ADAPTIVE_H
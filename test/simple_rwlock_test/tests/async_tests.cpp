@@ -0,0 +1,187 @@
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include <simple_rwlock_async.h>
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/tests/test_common.h>
+#include <simple_rwlock_test/tests/async_tests.h>
+
+namespace simple_rwlock_test {
+    using namespace simple_rwlock;
+    using namespace test_common;
+
+    // Pieces shared by the coroutine tests: a single-threaded
+    // event loop and a coroutine type that starts eagerly.
+    namespace test_async_common {
+        class EventLoop : public async_rwlock_executor_t {
+        public:
+            void post(std::coroutine_handle<> handle) {
+                ready_.push_back(handle);
+            }
+
+            // Resume queued coroutines until none are left.
+            void run() {
+                while (!ready_.empty()) {
+                    std::coroutine_handle<> handle = ready_.front();
+                    ready_.pop_front();
+                    handle.resume();
+                }
+            }
+
+        private:
+            std::deque<std::coroutine_handle<> > ready_;
+        };
+
+        // Awaitable that sends the coroutine to the back of the loop.
+        struct reschedule {
+            EventLoop &loop;
+            bool await_ready() { return false; }
+            void await_suspend(std::coroutine_handle<> handle) {
+                loop.post(handle);
+            }
+            void await_resume() { }
+        };
+
+        // Coroutine that runs until its first suspension when called
+        // and frees its own frame when it finishes.
+        struct task {
+            struct promise_type {
+                task get_return_object() { return task(); }
+                std::suspend_never initial_suspend() { return {}; }
+                std::suspend_never final_suspend() noexcept { return {}; }
+                void return_void() { }
+                void unhandled_exception() { std::terminate(); }
+            };
+        };
+    }
+
+    // Hold write access outside of any coroutine, queue coroutines
+    // behind it and record the order in which they are resumed.
+    namespace test_async_writer_bias {
+        using namespace test_async_common;
+
+        // Hold read access across one turn of the event loop so that
+        // readers granted access together overlap with each other.
+        task read_coroutine(EventLoop *loop,                    // Shared
+                            async_rwlock_t *rwlock,             // Shared
+                            std::string name,                   // Not shared
+                            std::vector<std::string> *events,   // Shared
+                            unsigned int *num_reading,          // Shared
+                            unsigned int *max_reading)          // Shared
+        {
+            co_await rwlock->read();
+            events->push_back(name + " read");
+            *num_reading = *num_reading + 1;
+            if (*num_reading > *max_reading) {
+                *max_reading = *num_reading;
+            }
+            co_await reschedule { *loop };
+            *num_reading = *num_reading - 1;
+            rwlock->unlock_rd();
+        }
+
+        task write_coroutine(async_rwlock_t *rwlock,            // Shared
+                             std::string name,                  // Not shared
+                             std::vector<std::string> *events)  // Shared
+        {
+            co_await rwlock->write();
+            events->push_back(name + " write");
+            rwlock->unlock_wr();
+        }
+    }
+    TestAsyncWriterBias::TestAsyncWriterBias(Clock &tester_clock) :
+        Test("async_writer_bias", tester_clock)
+    { }
+    int TestAsyncWriterBias::run_test_body() {
+        using namespace test_async_writer_bias;
+        EventLoop loop;
+        async_rwlock_t rwlock(loop);
+        std::vector<std::string> events;
+        unsigned int num_reading = 0;
+        unsigned int max_reading = 0;
+        bool pass = rwlock.try_lock_wr();
+        read_coroutine(&loop, &rwlock, "reader1", &events,
+                       &num_reading, &max_reading);
+        write_coroutine(&rwlock, "writer", &events);
+        read_coroutine(&loop, &rwlock, "reader2", &events,
+                       &num_reading, &max_reading);
+        // Nothing may run until write access is released.
+        loop.run();
+        pass &= events.empty();
+        rwlock.unlock_wr();
+        loop.run();
+        std::vector<std::string> expected = {
+            "writer write", "reader1 read", "reader2 read"
+        };
+        pass &= (events == expected);
+        pass &= (max_reading == 2);
+        // Everything has been released again.
+        pass &= rwlock.try_lock_wr();
+        rwlock.unlock_wr();
+        return (pass ? 0 : 1);
+    }
+
+    // Have 8 readers and 4 writers loop on the same event loop. Each
+    // section yields to the loop while holding access, so every other
+    // coroutine gets a chance to try the lock at that point.
+    namespace test_async_interleaved {
+        using namespace test_async_common;
+
+        const unsigned int num_iterations = 20;
+
+        task read_coroutine(EventLoop *loop,                    // Shared
+                            async_rwlock_t *rwlock,             // Shared
+                            unsigned long *first,               // Shared
+                            unsigned long *second,              // Shared
+                            bool *pass)                         // Shared
+        {
+            for (unsigned int i = 0; i < num_iterations; i++) {
+                co_await rwlock->read();
+                unsigned long first_value = *first;
+                co_await reschedule { *loop };
+                *pass &= (first_value == *second);
+                rwlock->unlock_rd();
+            }
+        }
+
+        task write_coroutine(EventLoop *loop,                   // Shared
+                             async_rwlock_t *rwlock,            // Shared
+                             unsigned long *first,              // Shared
+                             unsigned long *second)             // Shared
+        {
+            for (unsigned int i = 0; i < num_iterations; i++) {
+                co_await rwlock->write();
+                *first = *first + 1;
+                co_await reschedule { *loop };
+                *second = *second + 1;
+                rwlock->unlock_wr();
+            }
+        }
+    }
+    TestAsyncInterleaved::TestAsyncInterleaved(Clock &tester_clock) :
+        Test("async_interleaved", tester_clock)
+    { }
+    int TestAsyncInterleaved::run_test_body() {
+        using namespace test_async_interleaved;
+        const unsigned int num_readers = 8;
+        const unsigned int num_writers = 4;
+        EventLoop loop;
+        async_rwlock_t rwlock(loop);
+        unsigned long first = 0;
+        unsigned long second = 0;
+        bool pass = true;
+        for (unsigned int i = 0; i < num_readers; i++) {
+            read_coroutine(&loop, &rwlock, &first, &second, &pass);
+            if (i < num_writers) {
+                write_coroutine(&loop, &rwlock, &first, &second);
+            }
+        }
+        loop.run();
+        pass &= (first == num_writers * num_iterations);
+        pass &= (second == num_writers * num_iterations);
+        return (pass ? 0 : 1);
+    }
+}
@@ -0,0 +1,27 @@
+#ifndef SRWLT_TEST_ASYNC_H
+#define SRWLT_TEST_ASYNC_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // test_async_writer_bias: While write access is held, suspend a reader
+    // coroutine, then a writer coroutine, then another reader coroutine on
+    // an async_rwlock_t. Confirm that releasing write access resumes the
+    // writer first and then both readers together.
+    class TestAsyncWriterBias : public Test {
+    public:
+        TestAsyncWriterBias(Clock &tester_clock);
+        int run_test_body();
+    };
+
+    // test_async_interleaved: Run many reader and writer coroutines on one
+    // event loop, each yielding back to the loop while holding access, and
+    // confirm readers never see a partial write.
+    class TestAsyncInterleaved : public Test {
+    public:
+        TestAsyncInterleaved(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_TEST_ASYNC_H
@@ -0,0 +1,54 @@
+#include <atomic>
+
+#include <simple_rwlock_combining.h>
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/benchmarks/lock_adapters.h>
+#include <simple_rwlock_test/tests/test_common.h>
+#include <simple_rwlock_test/tests/combining_tests.h>
+
+namespace simple_rwlock_test {
+    using namespace simple_rwlock;
+    using namespace test_common;
+
+    TestCombiningReadersWriters::TestCombiningReadersWriters(
+        Clock &tester_clock) :
+        Test("combining_readers_writers", tester_clock)
+    { }
+    int TestCombiningReadersWriters::run_test_body() {
+        using lock_adapters::combining_rwlock_adapter;
+        const unsigned int num_writers = 4;
+        const unsigned int num_readers = 2;
+        const unsigned int num_iterations = 50;
+        combining_rwlock_adapter lock;
+        lock.init();
+
+        // Write through combining_rwlock_lock_wr.
+        bool pass = run_partial_write_test(&lock, 1, 1, num_readers,
+                                           num_iterations);
+        pass &= (lock.rwlock.num_combined_writes == 0);
+
+        // Post every write, so that a combiner runs batches of them. Each
+        // posted write must have run by the time its post returns.
+        std::atomic<bool> post_pass(true);
+        auto post_write = [&post_pass](combining_rwlock_adapter *lock,
+                                       unsigned long *first,
+                                       unsigned long *second) {
+            bool ran = false;
+            combining_rwlock_write(&lock->rwlock, [first, second, &ran]() {
+                *first = *first + 1;
+                *second = *second + 1;
+                ran = true;
+            });
+            if (!ran) {
+                post_pass = false;
+            }
+        };
+        pass &= run_partial_write_test(&lock, 1, num_writers, num_readers,
+                                       num_iterations, true, post_write);
+        pass &= post_pass.load();
+        pass &= (lock.rwlock.num_combined_writes ==
+                 num_writers * num_iterations);
+        lock.uninit();
+        return (pass ? 0 : 1);
+    }
+}
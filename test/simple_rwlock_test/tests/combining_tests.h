@@ -0,0 +1,20 @@
+#ifndef SRWLT_TEST_COMBINING_H
+#define SRWLT_TEST_COMBINING_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // test_combining_readers_writers: Run the partial write test from
+    // test_common with 2 reader threads on a combining_rwlock_t, first
+    // with 1 writer thread writing through combining_rwlock_lock_wr and
+    // then with 4 writer threads posting every write. Confirm that every
+    // posted write was combined and had run by the time its post
+    // returned.
+    class TestCombiningReadersWriters : public Test {
+    public:
+        TestCombiningReadersWriters(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_TEST_COMBINING_H
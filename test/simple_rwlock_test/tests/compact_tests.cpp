@@ -0,0 +1,37 @@
+#include <simple_rwlock_compact.h>
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/benchmarks/lock_adapters.h>
+#include <simple_rwlock_test/tests/test_common.h>
+#include <simple_rwlock_test/tests/compact_tests.h>
+
+namespace simple_rwlock_test {
+    using namespace simple_rwlock;
+    using namespace test_common;
+
+    TestCompactReadersWriters::TestCompactReadersWriters(
+        Clock &tester_clock) :
+        Test("compact_readers_writers", tester_clock)
+    { }
+    int TestCompactReadersWriters::run_test_body() {
+        using lock_adapters::compact_rwlock_adapter;
+        const unsigned int num_threads = 4;
+        const unsigned int num_iterations = 50;
+        const unsigned int num_locks = 8;
+        // The locks are adjacent, so several of them share a cache line
+        // and threads parked on different locks may share a parking lot
+        // bucket.
+        compact_rwlock_adapter locks[num_locks];
+        for (unsigned int i = 0; i < num_locks; i++) {
+            locks[i].init();
+        }
+        bool pass = run_partial_write_test(locks, num_locks, num_threads,
+                                           num_threads, num_iterations);
+        pass &= (sizeof(compact_rwlock_t) == 4);
+        pass &= (sizeof(locks) == num_locks * sizeof(compact_rwlock_t));
+        for (unsigned int i = 0; i < num_locks; i++) {
+            locks[i].uninit();
+            pass &= (locks[i].rwlock.state.load() == 0);
+        }
+        return (pass ? 0 : 1);
+    }
+}
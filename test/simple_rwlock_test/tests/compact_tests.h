@@ -0,0 +1,18 @@
+#ifndef SRWLT_TEST_COMPACT_H
+#define SRWLT_TEST_COMPACT_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // test_compact_readers_writers: Run the partial write test from
+    // test_common with 4 reader threads and 4 writer threads on an array
+    // of 8 adjacent compact_rwlock_t, so that several locks share a cache
+    // line. Also confirm the lock is one 32-bit word.
+    class TestCompactReadersWriters : public Test {
+    public:
+        TestCompactReadersWriters(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_TEST_COMPACT_H
@@ -0,0 +1,226 @@
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <simple_rwlock.h>
+#include <simple_rwlock_cond.h>
+#include <simple_rwlock_test/sync.h>
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/tests/test_common.h>
+#include <simple_rwlock_test/tests/cond_tests.h>
+
+namespace simple_rwlock_test {
+    using namespace simple_rwlock;
+    using namespace test_common;
+
+    // State shared by the waiting threads of both tests. Waiters count
+    // themselves in num_waiting while they still hold access, so once the
+    // count is reached and the main thread has write access, every waiter
+    // is known to be queued on the condition variable.
+    typedef struct cond_state_t {
+        rwlock_t rwlock;
+        rwlock_cond_t cond;
+        bool ready;
+        unsigned long tokens;
+        unsigned long consumed;
+        std::atomic<unsigned int> num_waiting;
+    } cond_state_t;
+
+    namespace {
+        void init_state(cond_state_t *state) {
+            rwlock_init(&state->rwlock);
+            rwlock_cond_init(&state->cond);
+            state->ready = false;
+            state->tokens = 0;
+            state->consumed = 0;
+            state->num_waiting = 0;
+        }
+
+        // Return whether every waiter has left both queues.
+        bool uninit_state(cond_state_t *state) {
+            bool empty = (state->cond.waiting_head == nullptr) &&
+                (state->cond.requeued_head == nullptr);
+            rwlock_cond_uninit(&state->cond);
+            rwlock_uninit(&state->rwlock);
+            return empty;
+        }
+
+        // Wait until num_threads threads are queued, then take write
+        // access.
+        void lock_wr_once_waiting(cond_state_t *state,
+                                  unsigned int num_threads)
+        {
+            spin_until([state, num_threads]() {
+                return state->num_waiting.load() == num_threads;
+            });
+            rwlock_lock_wr(&state->rwlock);
+        }
+    }
+
+    namespace test_cond_broadcast {
+        const unsigned int num_threads = 3;
+
+        void read_thread(unsigned int thread_num,   // Not shared
+                         cond_state_t *state,       // Shared
+                         bool *saw_ready)           // Not shared
+        {
+            std::stringstream thread_name_stream;
+            thread_name_stream << "read thread #" << thread_num;
+            TEST_DLOG_THREAD_LAUNCH(thread_name_stream.str());
+            rwlock_lock_rd(&state->rwlock);
+            state->num_waiting++;
+            while (!state->ready) {
+                rwlock_cond_wait_rd(&state->cond, &state->rwlock);
+            }
+            *saw_ready = state->ready;
+            rwlock_unlock_rd(&state->rwlock);
+        }
+
+        void write_thread(unsigned int thread_num,  // Not shared
+                          cond_state_t *state)      // Shared
+        {
+            std::stringstream thread_name_stream;
+            thread_name_stream << "write thread #" << thread_num;
+            TEST_DLOG_THREAD_LAUNCH(thread_name_stream.str());
+            rwlock_lock_wr(&state->rwlock);
+            state->num_waiting++;
+            while (!state->ready) {
+                rwlock_cond_wait_wr(&state->cond, &state->rwlock);
+            }
+            state->consumed++;
+            rwlock_unlock_wr(&state->rwlock);
+        }
+    }
+    TestCondBroadcast::TestCondBroadcast(Clock &tester_clock) :
+        Test("cond_broadcast", tester_clock)
+    { }
+    int TestCondBroadcast::run_test_body() {
+        using namespace test_cond_broadcast;
+        cond_state_t state;
+        bool saw_ready[num_threads] = { false, false, false };
+        init_state(&state);
+        std::vector<std::thread> threads;
+        for (unsigned int i = 0; i < num_threads; i++) {
+            threads.push_back(std::thread(read_thread, i + 1, &state,
+                                          &saw_ready[i]));
+            threads.push_back(std::thread(write_thread, i + 1, &state));
+        }
+        lock_wr_once_waiting(&state, 2 * num_threads);
+        state.ready = true;
+        rwlock_cond_broadcast(&state.cond);
+        rwlock_unlock_wr(&state.rwlock);
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        bool pass = (state.consumed == num_threads);
+        for (unsigned int i = 0; i < num_threads; i++) {
+            pass &= saw_ready[i];
+        }
+        pass &= uninit_state(&state);
+        return (pass ? 0 : 1);
+    }
+
+    namespace test_cond_signal_timed {
+        const unsigned int num_consumers = 3;
+        const std::chrono::milliseconds short_timeout(5);
+        const std::chrono::seconds long_timeout(60);
+
+        // Consume one token, waiting for a signal while there are none.
+        void consume_thread(unsigned int thread_num,    // Not shared
+                            cond_state_t *state)        // Shared
+        {
+            std::stringstream thread_name_stream;
+            thread_name_stream << "consume thread #" << thread_num;
+            TEST_DLOG_THREAD_LAUNCH(thread_name_stream.str());
+            rwlock_lock_wr(&state->rwlock);
+            state->num_waiting++;
+            while (state->tokens == 0) {
+                rwlock_cond_wait_wr(&state->cond, &state->rwlock);
+            }
+            state->tokens--;
+            state->consumed++;
+            rwlock_unlock_wr(&state->rwlock);
+        }
+
+        // Wait for the flag with a timed wait that should not time out.
+        void timed_read_thread(cond_state_t *state,    // Shared
+                               bool *signalled)        // Not shared
+        {
+            TEST_DLOG_THREAD_LAUNCH("timed read thread");
+            rwlock_lock_rd(&state->rwlock);
+            state->num_waiting++;
+            *signalled = true;
+            while (!state->ready) {
+                *signalled &= rwlock_cond_timedwait_rd(
+                    &state->cond, &state->rwlock, long_timeout);
+            }
+            rwlock_unlock_rd(&state->rwlock);
+        }
+
+        // Return whether a timed wait with nobody to signal it timed out
+        // no earlier than short_timeout.
+        bool times_out(cond_state_t *state, bool writer) {
+            auto start = std::chrono::steady_clock::now();
+            bool signalled;
+            if (writer) {
+                rwlock_lock_wr(&state->rwlock);
+                signalled = rwlock_cond_timedwait_wr(
+                    &state->cond, &state->rwlock, short_timeout);
+                rwlock_unlock_wr(&state->rwlock);
+            } else {
+                rwlock_lock_rd(&state->rwlock);
+                signalled = rwlock_cond_timedwait_rd(
+                    &state->cond, &state->rwlock, short_timeout);
+                rwlock_unlock_rd(&state->rwlock);
+            }
+            return !signalled &&
+                (std::chrono::steady_clock::now() - start >= short_timeout);
+        }
+    }
+    TestCondSignalTimed::TestCondSignalTimed(Clock &tester_clock) :
+        Test("cond_signal_timed", tester_clock)
+    { }
+    int TestCondSignalTimed::run_test_body() {
+        using namespace test_cond_signal_timed;
+        cond_state_t state;
+        init_state(&state);
+        bool pass = times_out(&state, false);
+        pass &= times_out(&state, true);
+
+        bool signalled = false;
+        std::thread timed_reader(timed_read_thread, &state, &signalled);
+        lock_wr_once_waiting(&state, 1);
+        state.ready = true;
+        rwlock_cond_signal(&state.cond);
+        rwlock_unlock_wr(&state.rwlock);
+        timed_reader.join();
+        pass &= signalled;
+
+        state.num_waiting = 0;
+        std::vector<std::thread> consumers;
+        for (unsigned int i = 0; i < num_consumers; i++) {
+            consumers.push_back(std::thread(consume_thread, i + 1, &state));
+        }
+        for (unsigned int i = 0; i < num_consumers; i++) {
+            // Only the first token is added with every consumer waiting;
+            // later ones may find consumers still on their way back in.
+            if (i == 0) {
+                lock_wr_once_waiting(&state, num_consumers);
+            } else {
+                rwlock_lock_wr(&state.rwlock);
+            }
+            state.tokens++;
+            rwlock_cond_signal(&state.cond);
+            rwlock_unlock_wr(&state.rwlock);
+        }
+        for (auto &consumer : consumers) {
+            consumer.join();
+        }
+        pass &= (state.consumed == num_consumers) && (state.tokens == 0);
+        pass &= uninit_state(&state);
+        return (pass ? 0 : 1);
+    }
+}
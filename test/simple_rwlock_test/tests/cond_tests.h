@@ -0,0 +1,28 @@
+#ifndef SRWLT_TEST_COND_H
+#define SRWLT_TEST_COND_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // test_cond_broadcast: Have 3 reader threads and 3 writer threads wait
+    // on an rwlock_cond_t for a flag. Set the flag with write access and
+    // broadcast, and confirm every thread wakes with the right kind of
+    // access and that no waiter is left queued.
+    class TestCondBroadcast : public Test {
+    public:
+        TestCondBroadcast(Clock &tester_clock);
+        int run_test_body();
+    };
+
+    // test_cond_signal_timed: Confirm timed waits with no signal time out
+    // and return with access, that a signalled timed wait reports it was
+    // signalled, and that each signal lets exactly one of 3 waiting
+    // writer threads consume one token.
+    class TestCondSignalTimed : public Test {
+    public:
+        TestCondSignalTimed(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_TEST_COND_H
@@ -0,0 +1,46 @@
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include <simple_rwlock_test/cycle_clock.h>
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/tests/cycle_clock_tests.h>
+
+namespace simple_rwlock_test {
+    TestCycleClockCalibration::TestCycleClockCalibration(
+        Clock &tester_clock) :
+        Test("cycle_clock_calibration", tester_clock)
+    { }
+    int TestCycleClockCalibration::run_test_body() {
+        CycleClock::calibrate();
+        std::cout << "CycleClock backend " << CycleClock::backend_name()
+            << std::dec << ", " << CycleClock::ticks_per_nanosecond()
+            << " ticks per nanosecond, " << CycleClock::overhead_ticks()
+            << " ticks of overhead" << std::endl;
+        bool pass = (CycleClock::ticks_per_nanosecond() > 0.0);
+
+        CycleClock::clk_ticks_t start = CycleClock::start_ticks();
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        CycleClock::clk_ticks_t stop = CycleClock::stop_ticks();
+        double sleep_ns = CycleClock::ticks_to_nanoseconds(
+            CycleClock::elapsed_ticks(start, stop));
+        std::cout << "2 millisecond sleep took " << sleep_ns
+            << " nanoseconds" << std::endl;
+        // Sleeps never end early, but may end late on a busy machine.
+        pass &= (sleep_ns >= 1900000.0 && sleep_ns < 200000000.0);
+
+        // With the overhead taken out, the cheapest of many
+        // empty timings should be no more than a few ticks.
+        CycleClock::op_stats_t empty_stats;
+        for (unsigned int i = 0; i < 1000; i++) {
+            start = CycleClock::start_ticks();
+            stop = CycleClock::stop_ticks();
+            empty_stats.record(CycleClock::elapsed_ticks(start, stop));
+        }
+        std::cout << "Cheapest empty timing took " << empty_stats.min_ticks
+            << " ticks" << std::endl;
+        pass &= (CycleClock::ticks_to_nanoseconds(empty_stats.min_ticks) <
+                 100.0);
+        return (pass ? 0 : 1);
+    }
+}
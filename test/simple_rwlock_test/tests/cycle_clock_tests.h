@@ -0,0 +1,17 @@
+#ifndef SRWLT_TEST_CYCLE_CLOCK_H
+#define SRWLT_TEST_CYCLE_CLOCK_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // test_cycle_clock_calibration: Time a 2 millisecond sleep and a short
+    // loop with CycleClock, and confirm the sleep comes out at roughly 2
+    // milliseconds and an empty timing comes out near zero.
+    class TestCycleClockCalibration : public Test {
+    public:
+        TestCycleClockCalibration(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_TEST_CYCLE_CLOCK_H
@@ -0,0 +1,107 @@
+#include <iostream>
+
+#include <simple_rwlock_elided.h>
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/benchmarks/lock_adapters.h>
+#include <simple_rwlock_test/tests/test_common.h>
+#include <simple_rwlock_test/tests/elided_tests.h>
+
+namespace simple_rwlock_test {
+    using namespace simple_rwlock;
+    using namespace test_common;
+
+    TestElidedReadersWriters::TestElidedReadersWriters(Clock &tester_clock) :
+        Test("elided_readers_writers", tester_clock)
+    { }
+    int TestElidedReadersWriters::run_test_body() {
+        using lock_adapters::elided_rwlock_adapter;
+        const unsigned int num_readers = 4;
+        const unsigned int num_writers = 2;
+        const unsigned int num_iterations = 50;
+        elided_rwlock_adapter lock;
+        lock.init();
+        // Readers do not yield, so that their sections can run as
+        // transactions.
+        bool pass = run_partial_write_test(&lock, 1, num_writers,
+                                           num_readers, num_iterations,
+                                           false);
+
+        elided_rwlock_stats_t stats;
+        elided_rwlock_get_stats(&lock.rwlock, &stats);
+        lock.uninit();
+        std::cout << std::dec << "Elision "
+            << (elided_rwlock_elision_supported()
+                ? "supported" : "not supported")
+            << ": " << stats.num_attempts << " attempts, "
+            << stats.num_commits << " commits, "
+            << stats.num_aborts_writer << " writer aborts, "
+            << stats.num_aborts_conflict << " conflict aborts, "
+            << stats.num_aborts_capacity << " capacity aborts, "
+            << stats.num_aborts_other << " other aborts, "
+            << stats.num_fallback_reads << " fallback reads" << std::endl;
+
+        // Commits are only published in batches, so the most that can be
+        // checked is that no read went unaccounted for.
+        pass &= (stats.num_fallback_reads <= num_readers * num_iterations);
+        if (!elided_rwlock_elision_supported()) {
+            // Without hardware support every read must take the fallback.
+            pass &= !stats.elision_enabled;
+            pass &= (stats.num_attempts == 0);
+            pass &= (stats.num_fallback_reads == num_readers * num_iterations);
+        }
+        return (pass ? 0 : 1);
+    }
+
+    // Each pair of locks is read in both combinations of elided and
+    // fallback access, since a thread running inside a transaction for
+    // one lock may hold the other through rwlock_t.
+    namespace test_elided_out_of_order {
+        // Read both locks, release them in the given order, and return
+        // whether neither rwlock_t is left with an active reader.
+        bool read_both(elided_rwlock_t *a, elided_rwlock_t *b,
+                       bool release_a_first)
+        {
+            elided_rwlock_lock_rd(a);
+            elided_rwlock_lock_rd(b);
+            if (release_a_first) {
+                elided_rwlock_unlock_rd(a);
+                elided_rwlock_unlock_rd(b);
+            } else {
+                elided_rwlock_unlock_rd(b);
+                elided_rwlock_unlock_rd(a);
+            }
+            return (a->rwlock.num_active_readers == 0) &&
+                   (b->rwlock.num_active_readers == 0);
+        }
+    }
+    TestElidedOutOfOrder::TestElidedOutOfOrder(Clock &tester_clock) :
+        Test("elided_out_of_order", tester_clock)
+    { }
+    int TestElidedOutOfOrder::run_test_body() {
+        using namespace test_elided_out_of_order;
+        elided_rwlock_t first;
+        elided_rwlock_t second;
+        elided_rwlock_init(&first);
+        elided_rwlock_init(&second);
+        bool pass = true;
+        for (unsigned int elided = 0; elided < 4; elided++) {
+            elided_rwlock_set_elision(&first, (elided & 1) != 0);
+            elided_rwlock_set_elision(&second, (elided & 2) != 0);
+            pass &= read_both(&first, &second, true);
+            pass &= read_both(&first, &second, false);
+            pass &= read_both(&second, &first, true);
+        }
+        // Once every read access is known to be released, a writer must
+        // be able to lock each of them.
+        if (pass) {
+            for (elided_rwlock_t *rwlock : { &first, &second }) {
+                elided_rwlock_lock_wr(rwlock);
+                pass &= (rwlock->rwlock.num_active_readers == 0);
+                elided_rwlock_unlock_wr(rwlock);
+            }
+        }
+        elided_rwlock_uninit(&first);
+        elided_rwlock_uninit(&second);
+        return (pass ? 0 : 1);
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef SRWLT_TEST_ELIDED_H
+#define SRWLT_TEST_ELIDED_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // test_elided_readers_writers: Run the partial write test from
+    // test_common with 4 reader threads and 2 writer threads on an
+    // elided_rwlock_t, with readers that do not yield so that their reads
+    // can be elided. Then confirm the statistics account for every read.
+    class TestElidedReadersWriters : public Test {
+    public:
+        TestElidedReadersWriters(Clock &tester_clock);
+        int run_test_body();
+    };
+
+    // test_elided_out_of_order: Read two elided_rwlock_t, one with
+    // elision turned off, and release them in the order they were read
+    // and then in the opposite order. Confirm that every read access was
+    // released, and that a writer can then lock each of them.
+    class TestElidedOutOfOrder : public Test {
+    public:
+        TestElidedOutOfOrder(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_TEST_ELIDED_H
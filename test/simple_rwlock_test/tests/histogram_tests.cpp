@@ -0,0 +1,74 @@
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+#include <simple_rwlock_test/histogram.h>
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/tests/histogram_tests.h>
+
+namespace simple_rwlock_test {
+    namespace test_histogram_percentiles {
+        const unsigned long num_values = 100000;
+        // Each bucket spans at most 1/32 of its lowest value.
+        const double max_relative_error = 1.0 / Histogram::sub_bucket_count;
+
+        // Record every value from 1 to num_values with the given parity.
+        void record_thread(Histogram *histogram,    // Not shared
+                           unsigned long parity)    // Not shared
+        {
+            for (unsigned long i = 1; i <= num_values; i++) {
+                if (i % 2 == parity) {
+                    histogram->record(i);
+                }
+            }
+        }
+
+        bool check_percentile(const Histogram &histogram, double percentile) {
+            double expected = percentile / 100.0 * num_values;
+            double actual = histogram.value_at_percentile(percentile);
+            bool pass = std::fabs(actual - expected) <=
+                expected * max_relative_error + 1.0;
+            std::cout << "p" << percentile << " is " << std::dec << actual
+                << ", expected about " << expected
+                << (pass ? "" : " (wrong)") << std::endl;
+            return pass;
+        }
+    }
+    TestHistogramPercentiles::TestHistogramPercentiles(Clock &tester_clock) :
+        Test("histogram_percentiles", tester_clock)
+    { }
+    int TestHistogramPercentiles::run_test_body() {
+        using namespace test_histogram_percentiles;
+        bool pass = true;
+
+        // Every value must fall within the bounds of its own bucket.
+        for (Histogram::value_t value = 0; value < (1 << 20); value += 7) {
+            unsigned int index = Histogram::bucket_index(value);
+            pass &= (Histogram::bucket_lowest_value(index) <= value);
+            pass &= (Histogram::bucket_highest_value(index) >= value);
+        }
+        Histogram::value_t largest = ~(Histogram::value_t)0;
+        pass &= (Histogram::bucket_index(largest) ==
+                 Histogram::num_buckets - 1);
+
+        Histogram even_values;
+        Histogram odd_values;
+        std::thread even_thread(record_thread, &even_values, 0);
+        std::thread odd_thread(record_thread, &odd_values, 1);
+        even_thread.join();
+        odd_thread.join();
+        Histogram all_values;
+        all_values.merge(even_values);
+        all_values.merge(odd_values);
+
+        pass &= (all_values.count() == num_values);
+        pass &= (all_values.min() == 1);
+        pass &= (all_values.max() == num_values);
+        pass &= (all_values.value_at_percentile(100.0) == num_values);
+        pass &= check_percentile(all_values, 50.0);
+        pass &= check_percentile(all_values, 90.0);
+        pass &= check_percentile(all_values, 99.0);
+        pass &= check_percentile(all_values, 99.9);
+        return (pass ? 0 : 1);
+    }
+}
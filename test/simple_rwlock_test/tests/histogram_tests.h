@@ -0,0 +1,18 @@
+#ifndef SRWLT_TEST_HISTOGRAM_H
+#define SRWLT_TEST_HISTOGRAM_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // test_histogram_percentiles: Record the values 1 to 100000 into two
+    // histograms from two threads, merge them, and confirm the bucket
+    // bounds, the percentiles and the maximum are within the precision
+    // of the histogram.
+    class TestHistogramPercentiles : public Test {
+    public:
+        TestHistogramPercentiles(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_TEST_HISTOGRAM_H
@@ -0,0 +1,141 @@
+#include <mutex>
+#include <thread>
+
+#include <simple_rwlock_intention.h>
+#include <simple_rwlock_test/sync.h>
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/tests/test_common.h>
+#include <simple_rwlock_test/tests/intention_tests.h>
+
+namespace simple_rwlock_test {
+    using namespace simple_rwlock;
+    using namespace test_common;
+
+    namespace test_intention_hierarchy {
+        typedef struct tree_t {
+            intention_rwlock_t root;
+            intention_rwlock_t table;
+            intention_rwlock_t pages[2];
+            // Guarded by the table in X mode.
+            unsigned long table_version;
+            // Guarded by each page in X mode, or the table in X mode.
+            unsigned long page_values[2];
+        } tree_t;
+
+        // Number of waiting requests, counting no further than 2.
+        unsigned int num_waiting(intention_rwlock_t *rwlock) {
+            std::lock_guard<std::mutex> guard(*rwlock->mutex);
+            if (rwlock->waiting_head == nullptr) {
+                return 0;
+            }
+            return (rwlock->waiting_head == rwlock->waiting_tail) ? 1 : 2;
+        }
+
+        // Write to one page.
+        void page_write_thread(tree_t *tree,        // Shared
+                               unsigned int page)   // Not shared
+        {
+            TEST_DLOG_THREAD_LAUNCH("page write thread");
+            intention_rwlock_t *path[] = {
+                &tree->root, &tree->table, &tree->pages[page]
+            };
+            intention_rwlock_lock_path(path, 3, intention_mode_x);
+            tree->page_values[page]++;
+            intention_rwlock_unlock_path(path, 3, intention_mode_x);
+        }
+
+        // Write to the whole table.
+        void table_write_thread(tree_t *tree) {     // Shared
+            TEST_DLOG_THREAD_LAUNCH("table write thread");
+            intention_rwlock_t *path[] = { &tree->root, &tree->table };
+            intention_rwlock_lock_path(path, 2, intention_mode_x);
+            tree->table_version++;
+            tree->page_values[0] += 10;
+            tree->page_values[1] += 10;
+            intention_rwlock_unlock_path(path, 2, intention_mode_x);
+        }
+
+        // Read one page and the table version.
+        void page_read_thread(tree_t *tree,             // Shared
+                              unsigned int page,        // Not shared
+                              unsigned long *seen)      // Not shared
+        {
+            TEST_DLOG_THREAD_LAUNCH("page read thread");
+            intention_rwlock_t *path[] = {
+                &tree->root, &tree->table, &tree->pages[page]
+            };
+            intention_rwlock_lock_path(path, 3, intention_mode_s);
+            *seen = tree->page_values[page];
+            intention_rwlock_unlock_path(path, 3, intention_mode_s);
+        }
+
+        bool check_compatibility() {
+            const intention_mode_t is = intention_mode_is;
+            const intention_mode_t ix = intention_mode_ix;
+            const intention_mode_t s = intention_mode_s;
+            const intention_mode_t six = intention_mode_six;
+            const intention_mode_t x = intention_mode_x;
+            bool pass = intention_modes_compatible(is, six) &&
+                intention_modes_compatible(ix, ix) &&
+                intention_modes_compatible(s, s) &&
+                !intention_modes_compatible(ix, s) &&
+                !intention_modes_compatible(six, six) &&
+                !intention_modes_compatible(is, x);
+            for (int a = 0; a < intention_num_modes; a++) {
+                for (int b = 0; b < intention_num_modes; b++) {
+                    pass &= intention_modes_compatible(
+                        (intention_mode_t)a, (intention_mode_t)b) ==
+                        intention_modes_compatible(
+                            (intention_mode_t)b, (intention_mode_t)a);
+                }
+            }
+            pass &= (intention_parent_mode(s) == is) &&
+                (intention_parent_mode(six) == ix) &&
+                (intention_parent_mode(x) == ix);
+            return pass;
+        }
+    }
+    TestIntentionHierarchy::TestIntentionHierarchy(Clock &tester_clock) :
+        Test("intention_hierarchy", tester_clock)
+    { }
+    int TestIntentionHierarchy::run_test_body() {
+        using namespace test_intention_hierarchy;
+        tree_t tree;
+        intention_rwlock_init(&tree.root);
+        intention_rwlock_init(&tree.table);
+        intention_rwlock_init(&tree.pages[0]);
+        intention_rwlock_init(&tree.pages[1]);
+        tree.table_version = 0;
+        tree.page_values[0] = 0;
+        tree.page_values[1] = 0;
+        bool pass = check_compatibility();
+
+        intention_rwlock_t *path[] = {
+            &tree.root, &tree.table, &tree.pages[0]
+        };
+        intention_rwlock_lock_path(path, 3, intention_mode_x);
+        // A writer of the other page is not blocked.
+        std::thread other_page_writer(page_write_thread, &tree, 1);
+        other_page_writer.join();
+        pass &= (tree.page_values[1] == 1);
+
+        std::thread table_writer(table_write_thread, &tree);
+        spin_until([&tree]() { return num_waiting(&tree.table) == 1; });
+        // Waits behind the table writer although IS is compatible with
+        // the IX held on the table.
+        unsigned long seen = 0;
+        std::thread page_reader(page_read_thread, &tree, 1, &seen);
+        spin_until([&tree]() { return num_waiting(&tree.table) == 2; });
+        pass &= (tree.table_version == 0);
+        intention_rwlock_unlock_path(path, 3, intention_mode_x);
+        table_writer.join();
+        page_reader.join();
+        pass &= (tree.table_version == 1) && (seen == 11);
+
+        intention_rwlock_uninit(&tree.pages[1]);
+        intention_rwlock_uninit(&tree.pages[0]);
+        intention_rwlock_uninit(&tree.table);
+        intention_rwlock_uninit(&tree.root);
+        return (pass ? 0 : 1);
+    }
+}
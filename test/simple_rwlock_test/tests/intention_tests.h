@@ -0,0 +1,19 @@
+#ifndef SRWLT_TEST_INTENTION_H
+#define SRWLT_TEST_INTENTION_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // test_intention_hierarchy: With a tree of intention_rwlock_t of a
+    // root, a table and two pages, confirm writers of the two pages do not
+    // block each other, a writer of the whole table waits for a writer of
+    // one page, and a reader of the other page that arrives after it waits
+    // behind it and sees its write. Also check the compatibility table.
+    class TestIntentionHierarchy : public Test {
+    public:
+        TestIntentionHierarchy(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_TEST_INTENTION_H
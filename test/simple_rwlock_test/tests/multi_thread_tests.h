@@ -1,11 +1,13 @@
 #include <simple_rwlock_test/test.h>
 
 namespace simple_rwlock_test {
-    // test_many_readers_one_writer: Have 8 reader threads and
-    // one writer thread. Don't let the writer start writing
-    // until after one of the readers has started reading.
-    // Don't let any of the readers let go of the reader lock
-    // until all of the readers have reported reading at least once.
+    // test_many_readers_one_writer: Have 8 reader threads hold read access
+    // at the same time, then start a writer and wait until it is waiting
+    // for write access. Confirm the writer has not written while the
+    // readers still hold read access, and that a reader arriving after the
+    // writer only gets read access after the write (the lock is
+    // writer-biased). Then release the readers, and confirm every reader
+    // sees the written value afterwards.
     class TestManyReadersOneWriter : public Test {
     public:
         TestManyReadersOneWriter(Clock &tester_clock);
@@ -0,0 +1,100 @@
+#include <thread>
+
+#include <simple_rwlock_numa.h>
+#include <simple_rwlock_test/sync.h>
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/benchmarks/lock_adapters.h>
+#include <simple_rwlock_test/tests/test_common.h>
+#include <simple_rwlock_test/tests/numa_tests.h>
+
+namespace simple_rwlock_test {
+    using namespace simple_rwlock;
+    using namespace test_common;
+
+    TestNumaReadersWriters::TestNumaReadersWriters(Clock &tester_clock) :
+        Test("numa_readers_writers", tester_clock)
+    { }
+    int TestNumaReadersWriters::run_test_body() {
+        using lock_adapters::numa_rwlock_adapter;
+        const unsigned int num_threads = 4;
+        const unsigned int num_iterations = 50;
+        numa_rwlock_adapter lock;
+        lock.init();
+        bool pass = run_partial_write_test(&lock, 1, num_threads,
+                                           num_threads, num_iterations);
+        lock.uninit();
+        return (pass ? 0 : 1);
+    }
+
+    namespace test_numa_handoff {
+        typedef struct handoff_state_t {
+            bool owns_global_lock;
+            bool global_write_locked;
+            rwlock_count_t num_local_handoffs;
+        } handoff_state_t;
+
+        handoff_state_t get_state(numa_rwlock_t *rwlock) {
+            return { rwlock->nodes[0].owns_global_lock,
+                     rwlock->global_write_locked.load(),
+                     rwlock->nodes[0].num_local_handoffs };
+        }
+
+        // Record the state of the lock once write access is established.
+        void write_thread(numa_rwlock_t *rwlock,        // Shared
+                          handoff_state_t *state)       // Not shared
+        {
+            TEST_DLOG_THREAD_LAUNCH("write thread");
+            numa_rwlock_lock_wr(rwlock);
+            *state = get_state(rwlock);
+            numa_rwlock_unlock_wr(rwlock);
+        }
+    }
+    TestNumaHandoff::TestNumaHandoff(Clock &tester_clock) :
+        Test("numa_handoff", tester_clock)
+    { }
+    int TestNumaHandoff::run_test_body() {
+        using namespace test_numa_handoff;
+        numa_rwlock_t rwlock;
+        numa_rwlock_init(&rwlock);
+        // Put every thread on one node, wherever it actually runs. Only
+        // the first node's state is used after this.
+        unsigned int num_nodes = rwlock.num_nodes;
+        rwlock.num_nodes = 1;
+
+        // A writer waiting on the same node inherits the global write lock
+        // instead of it being released.
+        numa_rwlock_lock_wr(&rwlock);
+        handoff_state_t handed_off = { false, false, 0 };
+        std::thread writer(write_thread, &rwlock, &handed_off);
+        spin_until([&rwlock]() {
+            return rwlock.nodes[0].num_waiting_writers.load() > 0;
+        });
+        numa_rwlock_unlock_wr(&rwlock);
+        writer.join();
+        bool pass = handed_off.owns_global_lock &&
+                    handed_off.global_write_locked &&
+                    (handed_off.num_local_handoffs == 1);
+        // With nobody waiting, the last writer released it globally.
+        handoff_state_t released = get_state(&rwlock);
+        pass &= !released.owns_global_lock && !released.global_write_locked;
+
+        // Once the bound is reached, the lock is released globally even
+        // though a writer is waiting, and the next writer takes it anew.
+        rwlock.handoff_bound = 0;
+        numa_rwlock_lock_wr(&rwlock);
+        handoff_state_t taken_anew = { false, false, 1 };
+        writer = std::thread(write_thread, &rwlock, &taken_anew);
+        spin_until([&rwlock]() {
+            return rwlock.nodes[0].num_waiting_writers.load() > 0;
+        });
+        numa_rwlock_unlock_wr(&rwlock);
+        writer.join();
+        pass &= taken_anew.owns_global_lock &&
+                taken_anew.global_write_locked &&
+                (taken_anew.num_local_handoffs == 0);
+
+        rwlock.num_nodes = num_nodes;
+        numa_rwlock_uninit(&rwlock);
+        return (pass ? 0 : 1);
+    }
+}
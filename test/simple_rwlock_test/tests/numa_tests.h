@@ -0,0 +1,28 @@
+#ifndef SRWLT_TEST_NUMA_H
+#define SRWLT_TEST_NUMA_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // test_numa_readers_writers: Run the partial write test from
+    // test_common with 4 reader threads and 4 writer threads on a
+    // numa_rwlock_t.
+    class TestNumaReadersWriters : public Test {
+    public:
+        TestNumaReadersWriters(Clock &tester_clock);
+        int run_test_body();
+    };
+
+    // test_numa_handoff: With every thread mapped to one node, release
+    // write access while another writer waits, and confirm that writer
+    // inherits the global write lock and that the last writer releases
+    // it. Then set the handoff bound to 0 and confirm the waiting writer
+    // has to take the global write lock anew.
+    class TestNumaHandoff : public Test {
+    public:
+        TestNumaHandoff(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_TEST_NUMA_H
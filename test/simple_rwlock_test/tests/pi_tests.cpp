@@ -0,0 +1,221 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <system_error>
+#include <thread>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <simple_rwlock_pi.h>
+#include <simple_rwlock_test/sync.h>
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/topology.h>
+#include <simple_rwlock_test/tests/test_common.h>
+#include <simple_rwlock_test/tests/pi_tests.h>
+
+namespace simple_rwlock_test {
+    using namespace simple_rwlock;
+    using namespace test_common;
+
+    // All three threads are pinned to the same CPU, so that the spinning
+    // thread keeps the low-priority writer off the CPU unless the writer
+    // is boosted above it. The high-priority thread starts the spinning
+    // thread and sleeps until it is running, since nothing below SCHED_FIFO
+    // gets to run on that CPU after that.
+    namespace test_pi_bounded_inversion {
+        const std::chrono::milliseconds low_cpu_time(20);
+        const std::chrono::milliseconds spin_limit(1000);
+        // Waits up to this long count as bounded; a wait that includes the
+        // spinning thread's turn takes about spin_limit.
+        const std::chrono::milliseconds max_wait(500);
+        const int medium_priority = 10;
+        const int high_priority = 20;
+
+        typedef struct inversion_state_t {
+            pi_rwlock_t rwlock;
+            int cpu;
+            std::atomic<bool> low_holds;
+            std::atomic<bool> medium_running;
+            std::atomic<bool> high_done;
+            bool fifo_permitted;
+            std::chrono::nanoseconds high_wait;
+        } inversion_state_t;
+
+        bool set_fifo(int priority) {
+            sched_param param;
+            param.sched_priority = priority;
+            return pthread_setschedparam(pthread_self(), SCHED_FIFO,
+                                         &param) == 0;
+        }
+
+        std::chrono::nanoseconds thread_cpu_time() {
+            timespec now;
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+            return std::chrono::seconds(now.tv_sec) +
+                std::chrono::nanoseconds(now.tv_nsec);
+        }
+
+        void low_thread(inversion_state_t *state) {     // Shared
+            TEST_DLOG_THREAD_LAUNCH("low priority thread");
+            Topology::pin_to_cpu(state->cpu);
+            pi_rwlock_lock_wr(&state->rwlock);
+            state->low_holds = true;
+            std::chrono::nanoseconds end = thread_cpu_time() + low_cpu_time;
+            while (thread_cpu_time() < end) { }
+            pi_rwlock_unlock_wr(&state->rwlock);
+        }
+
+        void medium_thread(inversion_state_t *state) {  // Shared
+            TEST_DLOG_THREAD_LAUNCH("medium priority thread");
+            Topology::pin_to_cpu(state->cpu);
+            set_fifo(medium_priority);
+            auto end = std::chrono::steady_clock::now() + spin_limit;
+            state->medium_running = true;
+            while (!state->high_done &&
+                   std::chrono::steady_clock::now() < end) { }
+        }
+
+        void high_thread(inversion_state_t *state,      // Shared
+                         bool writer)                   // Not shared
+        {
+            TEST_DLOG_THREAD_LAUNCH("high priority thread");
+            Topology::pin_to_cpu(state->cpu);
+            state->fifo_permitted = set_fifo(high_priority);
+            std::thread medium;
+            if (state->fifo_permitted) {
+                medium = std::thread(medium_thread, state);
+                while (!state->medium_running) {
+                    std::this_thread::sleep_for(
+                        std::chrono::milliseconds(1));
+                }
+            }
+            auto start = std::chrono::steady_clock::now();
+            if (writer) {
+                pi_rwlock_lock_wr(&state->rwlock);
+                state->high_wait = std::chrono::steady_clock::now() - start;
+                pi_rwlock_unlock_wr(&state->rwlock);
+            } else {
+                pi_rwlock_lock_rd(&state->rwlock);
+                state->high_wait = std::chrono::steady_clock::now() - start;
+                pi_rwlock_unlock_rd(&state->rwlock);
+            }
+            state->high_done = true;
+            if (medium.joinable()) {
+                medium.join();
+            }
+        }
+
+        // Return whether the high-priority thread's wait was bounded, or
+        // true if SCHED_FIFO is not permitted.
+        bool run_inversion(int cpu, bool writer) {
+            inversion_state_t state;
+            pi_rwlock_init(&state.rwlock);
+            state.cpu = cpu;
+            state.low_holds = false;
+            state.medium_running = false;
+            state.high_done = false;
+            state.fifo_permitted = false;
+            state.high_wait = std::chrono::nanoseconds(0);
+
+            std::thread low(low_thread, &state);
+            spin_until([&state]() { return state.low_holds.load(); });
+            std::thread high(high_thread, &state, writer);
+            high.join();
+            low.join();
+            pi_rwlock_uninit(&state.rwlock);
+
+            bool pass = (state.rwlock.any_active_writers.load() == 0) &&
+                (state.rwlock.num_active_readers.load() == 0);
+            std::cout << std::dec << "High-priority "
+                << (writer ? "writer" : "reader") << " waited "
+                << std::chrono::duration_cast<std::chrono::microseconds>(
+                    state.high_wait).count() << " microseconds";
+            if (!state.fifo_permitted) {
+                std::cout << " (SCHED_FIFO not permitted, inversion not"
+                    << " checked)" << std::endl;
+                return pass;
+            }
+            std::cout << std::endl;
+            return pass && (state.high_wait < max_wait);
+        }
+    }
+    TestPiBoundedInversion::TestPiBoundedInversion(Clock &tester_clock) :
+        Test("pi_bounded_inversion", tester_clock)
+    { }
+    int TestPiBoundedInversion::run_test_body() {
+        using namespace test_pi_bounded_inversion;
+        int cpu = Topology::system().cpus().front().cpu;
+        bool pass = run_inversion(cpu, true);
+        pass &= run_inversion(cpu, false);
+        return (pass ? 0 : 1);
+    }
+
+    // A thread id cached before the fork would make the kernel look for
+    // the owner of the futex in the parent, so the reader could not block
+    // on it and the writer could not release it.
+    namespace test_pi_after_fork {
+        const std::chrono::milliseconds reader_wait(20);
+
+        void read_thread(pi_rwlock_t *rwlock,            // Shared
+                         std::atomic<bool> *read_done,   // Shared
+                         bool *read_pass)                // Not shared
+        {
+            try {
+                pi_rwlock_lock_rd(rwlock);
+                pi_rwlock_unlock_rd(rwlock);
+            } catch (const std::system_error &) {
+                *read_pass = false;
+            }
+            *read_done = true;
+        }
+
+        // Runs in the child.
+        bool contend_after_fork() {
+            pi_rwlock_t rwlock;
+            std::atomic<bool> read_done(false);
+            bool read_pass = true;
+            pi_rwlock_init(&rwlock);
+            pi_rwlock_lock_wr(&rwlock);
+            std::thread reader(read_thread, &rwlock, &read_done, &read_pass);
+            std::this_thread::sleep_for(reader_wait);
+            bool pass = !read_done;
+            try {
+                pi_rwlock_unlock_wr(&rwlock);
+            } catch (const std::system_error &) {
+                // The reader would never get in.
+                return false;
+            }
+            reader.join();
+            pi_rwlock_uninit(&rwlock);
+            return pass && read_pass && read_done;
+        }
+    }
+    TestPiAfterFork::TestPiAfterFork(Clock &tester_clock) :
+        Test("pi_after_fork", tester_clock)
+    { }
+    int TestPiAfterFork::run_test_body() {
+        using namespace test_pi_after_fork;
+        pi_rwlock_t rwlock;
+        pi_rwlock_init(&rwlock);
+        pi_rwlock_lock_wr(&rwlock);
+        pi_rwlock_unlock_wr(&rwlock);
+        pi_rwlock_uninit(&rwlock);
+
+        // Keep buffered output from being written by both processes.
+        std::cout.flush();
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0) {
+            _exit(contend_after_fork() ? 0 : 1);
+        }
+        int status = 0;
+        bool pass = (pid > 0) && (waitpid(pid, &status, 0) == pid) &&
+            WIFEXITED(status) && (WEXITSTATUS(status) == 0);
+        return (pass ? 0 : 1);
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef SRWLT_TEST_PI_H
+#define SRWLT_TEST_PI_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // test_pi_bounded_inversion: On one CPU, have a normal thread take
+    // write access to a pi_rwlock_t and need some CPU time before it
+    // releases it, a medium-priority SCHED_FIFO thread spin for up to a
+    // second, and a high-priority SCHED_FIFO thread then wait for access,
+    // once for write access and once for read access. Confirm each wait
+    // lasts about as long as the low-priority critical section rather than
+    // as long as the spinning thread. Without permission to use SCHED_FIFO,
+    // only confirm the lock works.
+    class TestPiBoundedInversion : public Test {
+    public:
+        TestPiBoundedInversion(Clock &tester_clock);
+        int run_test_body();
+    };
+
+    // test_pi_after_fork: Use a pi_rwlock_t so that this thread's id is
+    // cached, then fork. In the child, hold write access while a second
+    // thread blocks in the kernel for read access, and release it. Confirm
+    // the child finds the lock owned by its own thread id, so that the
+    // reader gets in and nothing reports an error.
+    class TestPiAfterFork : public Test {
+    public:
+        TestPiAfterFork(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_TEST_PI_H
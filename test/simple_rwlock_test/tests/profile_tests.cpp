@@ -0,0 +1,106 @@
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <simple_rwlock.h>
+#include <simple_rwlock_profile.h>
+#include <simple_rwlock_trace.h>
+#include <simple_rwlock_test/sync.h>
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/tests/test_common.h>
+#include <simple_rwlock_test/tests/profile_tests.h>
+
+namespace simple_rwlock_test {
+    using namespace simple_rwlock;
+    using namespace test_common;
+
+    namespace test_profile_call_sites {
+        const auto reader_wait = std::chrono::milliseconds(100);
+        const auto writer_wait = std::chrono::milliseconds(10);
+
+        // Each site records the address it returns to in its caller,
+        // which should be the second frame of the stack sampled there.
+        __attribute__((noinline))
+        void read_site(rwlock_t *rwlock, void **caller) {
+            *caller = __builtin_return_address(0);
+            rwlock_lock_rd(rwlock);
+            rwlock_unlock_rd(rwlock);
+        }
+
+        __attribute__((noinline))
+        void write_site(rwlock_t *rwlock, void **caller) {
+            *caller = __builtin_return_address(0);
+            rwlock_lock_wr(rwlock);
+            rwlock_unlock_wr(rwlock);
+        }
+
+        void read_thread(rwlock_t *rwlock,   // Shared
+                         void **caller)      // Not shared
+        {
+            TEST_DLOG_THREAD_LAUNCH("read thread");
+            read_site(rwlock, caller);
+        }
+
+        void write_thread(rwlock_t *rwlock,  // Shared
+                          void **caller)     // Not shared
+        {
+            TEST_DLOG_THREAD_LAUNCH("write thread");
+            write_site(rwlock, caller);
+        }
+
+        bool site_matches(const rwlock_profile_site_t &site, uint8_t kind,
+                          void *caller,
+                          std::chrono::nanoseconds min_wait)
+        {
+            return site.kind == kind && site.num_samples == 1 &&
+                site.total_wait_ns >= (uint64_t)min_wait.count() &&
+                site.max_wait_ns == site.total_wait_ns &&
+                site.num_frames >= 2 && site.frames[1] == caller;
+        }
+    }
+    TestProfileCallSites::TestProfileCallSites(Clock &tester_clock) :
+        Test("profile_call_sites", tester_clock)
+    { }
+    int TestProfileCallSites::run_test_body() {
+        using namespace test_profile_call_sites;
+        rwlock_t rwlock;
+        rwlock_init(&rwlock);
+        rwlock_profile_start(1);
+
+        // Uncontended calls are never sampled.
+        rwlock_lock_rd(&rwlock);
+        rwlock_unlock_rd(&rwlock);
+        rwlock_lock_wr(&rwlock);
+        rwlock_unlock_wr(&rwlock);
+
+        void *read_caller = nullptr;
+        rwlock_lock_wr(&rwlock);
+        std::thread reader(read_thread, &rwlock, &read_caller);
+        spin_until([&rwlock]() { return rwlock.readers_waiting(); });
+        std::this_thread::sleep_for(reader_wait);
+        rwlock_unlock_wr(&rwlock);
+        reader.join();
+
+        void *write_caller = nullptr;
+        rwlock_lock_rd(&rwlock);
+        std::thread writer(write_thread, &rwlock, &write_caller);
+        spin_until([&rwlock]() { return rwlock.writers_waiting(); });
+        std::this_thread::sleep_for(writer_wait);
+        rwlock_unlock_rd(&rwlock);
+        writer.join();
+        rwlock_profile_stop();
+
+        std::vector<rwlock_profile_site_t> sites;
+        rwlock_profile_top_sites(10, &sites);
+        bool pass = (sites.size() == 2);
+        if (pass) {
+            pass &= site_matches(sites[0], rwlock_trace_kind_read,
+                                 read_caller, reader_wait);
+            pass &= site_matches(sites[1], rwlock_trace_kind_write,
+                                 write_caller, writer_wait);
+        }
+        pass &= (rwlock_profile_num_dropped() == 0);
+        rwlock_uninit(&rwlock);
+        return (pass ? 0 : 1);
+    }
+}
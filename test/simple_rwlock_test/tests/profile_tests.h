@@ -0,0 +1,19 @@
+#ifndef SRWLT_TEST_PROFILE_H
+#define SRWLT_TEST_PROFILE_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // test_profile_call_sites: With the profiler sampling every contended
+    // call, make a reader wait for a writer at one call site and a writer
+    // wait for a reader, for less time, at another, alongside uncontended
+    // calls. Confirm the profile has exactly those two sites, longest
+    // total wait first, with stacks that start in the right callers.
+    class TestProfileCallSites : public Test {
+    public:
+        TestProfileCallSites(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_TEST_PROFILE_H
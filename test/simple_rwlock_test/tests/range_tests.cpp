@@ -0,0 +1,165 @@
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include <simple_rwlock_range.h>
+#include <simple_rwlock_test/sync.h>
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/tests/test_common.h>
+#include <simple_rwlock_test/tests/range_tests.h>
+
+namespace simple_rwlock_test {
+    using namespace simple_rwlock;
+    using namespace test_common;
+
+    namespace test_range_overlaps {
+        typedef struct shared_state_t {
+            range_rwlock_t rwlock;
+            unsigned long value;
+            std::atomic<bool> writer_done;
+            std::atomic<bool> reader_done;
+        } shared_state_t;
+
+        // Number of ranges locked or waiting.
+        unsigned long num_ranges(range_rwlock_t *rwlock) {
+            std::lock_guard<std::mutex> guard(*rwlock->mutex);
+            return rwlock->ranges->size();
+        }
+
+        void write_thread(shared_state_t *state,    // Shared
+                          uint64_t offset,          // Not shared
+                          uint64_t length)          // Not shared
+        {
+            TEST_DLOG_THREAD_LAUNCH("write thread");
+            range_rwlock_range_t range;
+            range_rwlock_lock_wr(&state->rwlock, &range, offset, length);
+            state->value++;
+            state->writer_done = true;
+            range_rwlock_unlock_wr(&state->rwlock, &range);
+        }
+
+        void read_thread(shared_state_t *state,     // Shared
+                         uint64_t offset,           // Not shared
+                         uint64_t length,           // Not shared
+                         unsigned long *seen)       // Not shared
+        {
+            TEST_DLOG_THREAD_LAUNCH("read thread");
+            range_rwlock_range_t range;
+            range_rwlock_lock_rd(&state->rwlock, &range, offset, length);
+            *seen = state->value;
+            state->reader_done = true;
+            range_rwlock_unlock_rd(&state->rwlock, &range);
+        }
+
+        // Lock and unlock a range that conflicts with no other range.
+        void unblocked_thread(range_rwlock_t *rwlock,    // Shared
+                             uint64_t offset,           // Not shared
+                             bool writer)               // Not shared
+        {
+            TEST_DLOG_THREAD_LAUNCH("unblocked thread");
+            range_rwlock_range_t range;
+            if (writer) {
+                range_rwlock_lock_wr(rwlock, &range, offset, 10);
+                range_rwlock_unlock_wr(rwlock, &range);
+            } else {
+                range_rwlock_lock_rd(rwlock, &range, offset, 10);
+                range_rwlock_unlock_rd(rwlock, &range);
+            }
+        }
+    }
+    TestRangeOverlaps::TestRangeOverlaps(Clock &tester_clock) :
+        Test("range_overlaps", tester_clock)
+    { }
+    int TestRangeOverlaps::run_test_body() {
+        using namespace test_range_overlaps;
+        shared_state_t state;
+        range_rwlock_init(&state.rwlock);
+        state.value = 0;
+        state.writer_done = false;
+        state.reader_done = false;
+
+        range_rwlock_range_t held;
+        range_rwlock_lock_rd(&state.rwlock, &held, 0, 100);
+        // Overlaps the held range.
+        std::thread writer(write_thread, &state, 90, 20);
+        spin_until([&state]() { return num_ranges(&state.rwlock) == 2; });
+        // Overlaps only the waiting writer.
+        unsigned long seen = 0;
+        std::thread reader(read_thread, &state, 105, 10, &seen);
+        spin_until([&state]() { return num_ranges(&state.rwlock) == 3; });
+
+        // A writer and a reader overlapping no other range, and a reader
+        // overlapping only the held read range.
+        std::thread unblocked_writer(unblocked_thread, &state.rwlock, 150,
+                                     true);
+        unblocked_writer.join();
+        std::thread unblocked_reader(unblocked_thread, &state.rwlock, 200,
+                                     false);
+        unblocked_reader.join();
+        std::thread sharing_reader(unblocked_thread, &state.rwlock, 0,
+                                   false);
+        sharing_reader.join();
+        bool pass = !state.writer_done && !state.reader_done;
+
+        range_rwlock_unlock_rd(&state.rwlock, &held);
+        writer.join();
+        reader.join();
+        pass &= (seen == 1);
+        pass &= (num_ranges(&state.rwlock) == 0);
+        range_rwlock_uninit(&state.rwlock);
+        return (pass ? 0 : 1);
+    }
+
+    namespace test_range_bounds {
+        // Return whether locking the range throws std::invalid_argument.
+        bool rejects(range_rwlock_t *rwlock, uint64_t offset,
+                     uint64_t length, bool writer)
+        {
+            range_rwlock_range_t range;
+            try {
+                if (writer) {
+                    range_rwlock_lock_wr(rwlock, &range, offset, length);
+                    range_rwlock_unlock_wr(rwlock, &range);
+                } else {
+                    range_rwlock_lock_rd(rwlock, &range, offset, length);
+                    range_rwlock_unlock_rd(rwlock, &range);
+                }
+            } catch (const std::invalid_argument &) {
+                return true;
+            }
+            return false;
+        }
+
+        uint64_t longest_length(range_rwlock_t *rwlock) {
+            std::lock_guard<std::mutex> guard(*rwlock->mutex);
+            return rwlock->lengths->empty() ? 0 : *rwlock->lengths->rbegin();
+        }
+    }
+    TestRangeBounds::TestRangeBounds(Clock &tester_clock) :
+        Test("range_bounds", tester_clock)
+    { }
+    int TestRangeBounds::run_test_body() {
+        using namespace test_range_bounds;
+        range_rwlock_t rwlock;
+        range_rwlock_init(&rwlock);
+        bool pass = rejects(&rwlock, 0, 0, false);
+        pass &= rejects(&rwlock, UINT64_MAX, 2, false);
+        pass &= rejects(&rwlock, UINT64_MAX - 10, 20, true);
+        pass &= !rejects(&rwlock, UINT64_MAX - 10, 10, true);
+        pass &= (test_range_overlaps::num_ranges(&rwlock) == 0);
+
+        range_rwlock_range_t short_range;
+        range_rwlock_range_t long_range;
+        range_rwlock_lock_rd(&rwlock, &short_range, 0, 10);
+        range_rwlock_lock_rd(&rwlock, &long_range, 1000, 1000000);
+        pass &= (longest_length(&rwlock) == 1000000);
+        range_rwlock_unlock_rd(&rwlock, &long_range);
+        pass &= (longest_length(&rwlock) == 10);
+        range_rwlock_unlock_rd(&rwlock, &short_range);
+        pass &= (longest_length(&rwlock) == 0);
+        range_rwlock_uninit(&rwlock);
+        return (pass ? 0 : 1);
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef SRWLT_TEST_RANGE_H
+#define SRWLT_TEST_RANGE_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // test_range_overlaps: With read access held to one range of a
+    // range_rwlock_t, confirm a writer of an overlapping range waits, a
+    // reader of a range that overlaps only the waiting writer's waits
+    // behind it, and a writer and a reader of ranges overlapping neither,
+    // and a reader overlapping only the held range, proceed. Then release
+    // the first range and confirm the writer and the reader behind it go
+    // in that order.
+    class TestRangeOverlaps : public Test {
+    public:
+        TestRangeOverlaps(Clock &tester_clock);
+        int run_test_body();
+    };
+
+    // test_range_bounds: Confirm a range_rwlock_t rejects a zero length
+    // and a range whose end overflows, without locking anything. Then hold
+    // a short range, lock and unlock a long one, and confirm the longest
+    // tracked length drops back to the short range's.
+    class TestRangeBounds : public Test {
+    public:
+        TestRangeBounds(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_TEST_RANGE_H
@@ -11,6 +11,11 @@
 
 #include <simple_rwlock_debug_helpers.h>
 #endif // DEBUG
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include <simple_rwlock.h>
 
 namespace simple_rwlock_test {
@@ -84,6 +89,112 @@ namespace simple_rwlock_test {
 
 #endif // DEBUG
 
+        // Increment both counters of a pair under write access, yielding
+        // in between so that a broken lock lets readers in halfway.
+        template <typename Adapter>
+        void write_pair_locked(Adapter *lock,               // Shared
+                               unsigned long *first,        // Shared
+                               unsigned long *second)       // Shared
+        {
+            lock->lock_wr();
+            *first = *first + 1;
+            std::this_thread::yield();
+            *second = *second + 1;
+            lock->unlock_wr();
+        }
+
+        // Have num_writers writer threads and num_readers reader threads
+        // share an array of num_locks initialized locks, each guarding a
+        // pair of counters, for num_iterations each. Writers call
+        // write(lock, first, second) to increment both counters of a pair,
+        // so any reader that sees the two counters differ has observed a
+        // partial write. Readers yield between the two loads unless
+        // yield_while_reading is false. Return whether no reader saw a
+        // partial write and every write landed.
+        template <typename Adapter, typename Write>
+        bool run_partial_write_test(Adapter *locks,
+                                    unsigned int num_locks,
+                                    unsigned int num_writers,
+                                    unsigned int num_readers,
+                                    unsigned int num_iterations,
+                                    bool yield_while_reading,
+                                    Write write)
+        {
+            std::vector<unsigned long> first(num_locks, 0);
+            std::vector<unsigned long> second(num_locks, 0);
+            // One char per reader, since std::vector<bool> shares bytes.
+            std::vector<char> read_pass(num_readers, true);
+            auto write_thread = [&](unsigned int thread_num) {
+                std::stringstream thread_name_stream;
+                thread_name_stream << "write thread #" << thread_num;
+                TEST_DLOG_THREAD_LAUNCH(thread_name_stream.str());
+                for (unsigned int i = 0; i < num_iterations; i++) {
+                    unsigned int pair = (thread_num + i) % num_locks;
+                    write(&locks[pair], &first[pair], &second[pair]);
+                }
+            };
+            // Nothing in the read section may do I/O, so that it can run
+            // as a transaction under elided_rwlock_t.
+            auto read_thread = [&](unsigned int thread_num) {
+                std::stringstream thread_name_stream;
+                thread_name_stream << "read thread #" << thread_num;
+                TEST_DLOG_THREAD_LAUNCH(thread_name_stream.str());
+                for (unsigned int i = 0; i < num_iterations; i++) {
+                    unsigned int pair = (thread_num + i) % num_locks;
+                    bool equal = false;
+                    { // Critical section: read from both counters.
+                        locks[pair].lock_rd();
+                        unsigned long first_value = first[pair];
+                        if (yield_while_reading) {
+                            std::this_thread::yield();
+                        }
+                        equal = (first_value == second[pair]);
+                        locks[pair].unlock_rd();
+                    }
+                    read_pass[thread_num - 1] &= equal;
+                }
+            };
+            std::vector<std::thread> threads;
+            for (unsigned int i = 0; i < num_writers || i < num_readers;
+                 i++) {
+                if (i < num_writers) {
+                    threads.push_back(std::thread(write_thread, i + 1));
+                }
+                if (i < num_readers) {
+                    threads.push_back(std::thread(read_thread, i + 1));
+                }
+            }
+            for (auto &thread : threads) {
+                thread.join();
+            }
+            bool pass = true;
+            unsigned long total = 0;
+            for (unsigned int i = 0; i < num_locks; i++) {
+                pass &= (first[i] == second[i]);
+                total += first[i];
+            }
+            pass &= (total == (unsigned long)num_writers * num_iterations);
+            for (unsigned int i = 0; i < num_readers; i++) {
+                pass &= (read_pass[i] != 0);
+            }
+            return pass;
+        }
+
+        // As above, with writers taking write access directly.
+        template <typename Adapter>
+        bool run_partial_write_test(Adapter *locks,
+                                    unsigned int num_locks,
+                                    unsigned int num_writers,
+                                    unsigned int num_readers,
+                                    unsigned int num_iterations,
+                                    bool yield_while_reading = true)
+        {
+            return run_partial_write_test(locks, num_locks, num_writers,
+                                          num_readers, num_iterations,
+                                          yield_while_reading,
+                                          write_pair_locked<Adapter>);
+        }
+
     } // End of test_common namespace
 } // End of simple_rwlock_test namespace
 
@@ -0,0 +1,92 @@
+#include <iostream>
+#include <vector>
+
+#include <sched.h>
+
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/topology.h>
+#include <simple_rwlock_test/tests/topology_tests.h>
+
+namespace simple_rwlock_test {
+    namespace test_topology_placement {
+        // Numbered the way Linux numbers SMT machines: the first sibling
+        // of every core, then the second sibling of every core.
+        //
+        //   package 0: core 0 = CPUs 0, 4   core 1 = CPUs 1, 5
+        //   package 1: core 0 = CPUs 2, 6   core 1 = CPUs 3, 7
+        Topology smt_topology() {
+            std::vector<Topology::cpu_info_t> cpus;
+            for (int cpu = 0; cpu < 8; cpu++) {
+                Topology::cpu_info_t info;
+                info.cpu = cpu;
+                info.core_id = cpu % 2;
+                info.package_id = (cpu / 2) % 2;
+                info.node = info.package_id;
+                cpus.push_back(info);
+            }
+            return Topology(cpus);
+        }
+
+        bool check_placement(const Topology &topology,
+                             Topology::placement_t placement,
+                             unsigned int num_threads,
+                             const std::vector<int> &expected)
+        {
+            std::vector<int> cpus;
+            bool pass = topology.place(placement, num_threads, &cpus) &&
+                (cpus == expected);
+            std::cout << Topology::placement_name(placement) << ":"
+                << std::dec;
+            for (int cpu : cpus) {
+                std::cout << " " << cpu;
+            }
+            std::cout << (pass ? "" : " (wrong)") << std::endl;
+            return pass;
+        }
+    }
+    TestTopologyPlacement::TestTopologyPlacement(Clock &tester_clock) :
+        Test("topology_placement", tester_clock)
+    { }
+    int TestTopologyPlacement::run_test_body() {
+        using namespace test_topology_placement;
+        bool pass = true;
+
+        Topology topology = smt_topology();
+        pass &= (topology.num_packages() == 2);
+        pass &= (topology.num_cores() == 4);
+        pass &= (topology.node_cpus(1) == std::vector<int>({ 2, 3, 6, 7 }));
+        pass &= check_placement(topology, Topology::placement_unpinned, 4,
+                                {});
+        pass &= check_placement(topology, Topology::placement_compact, 6,
+                                { 0, 4, 1, 5, 2, 6 });
+        pass &= check_placement(topology, Topology::placement_scatter, 6,
+                                { 0, 2, 1, 3, 4, 6 });
+        pass &= check_placement(topology, Topology::placement_smt_siblings,
+                                4, { 0, 4, 1, 5 });
+        pass &= check_placement(topology, Topology::placement_one_per_core,
+                                6, { 0, 1, 2, 3, 0, 1 });
+
+        // Without SMT there are no siblings to place threads on.
+        std::vector<Topology::cpu_info_t> single_cpus;
+        single_cpus.push_back({ 0, 0, 0, 0 });
+        single_cpus.push_back({ 1, 1, 0, 0 });
+        std::vector<int> cpus;
+        pass &= !Topology(single_cpus).place(
+            Topology::placement_smt_siblings, 2, &cpus);
+
+        Topology::placement_t parsed;
+        pass &= Topology::parse_placement("one-per-core", &parsed) &&
+            (parsed == Topology::placement_one_per_core);
+        pass &= !Topology::parse_placement("nowhere", &parsed);
+
+        const Topology &system = Topology::system();
+        std::cout << "system: " << system.summary() << std::endl;
+        pass &= !system.cpus().empty();
+        if (!system.cpus().empty()) {
+            int cpu = system.cpus()[0].cpu;
+            pass &= Topology::pin_to_cpu(cpu);
+            pass &= (sched_getcpu() == cpu);
+        }
+        return (pass ? 0 : 1);
+    }
+}
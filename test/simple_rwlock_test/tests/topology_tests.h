@@ -0,0 +1,18 @@
+#ifndef SRWLT_TEST_TOPOLOGY_H
+#define SRWLT_TEST_TOPOLOGY_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // test_topology_placement: Place threads with each strategy on a
+    // made-up machine of two packages of two cores with two SMT siblings
+    // each, and confirm the CPUs chosen. Then confirm the real machine has
+    // at least one CPU and the calling thread can be pinned to it.
+    class TestTopologyPlacement : public Test {
+    public:
+        TestTopologyPlacement(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_TEST_TOPOLOGY_H
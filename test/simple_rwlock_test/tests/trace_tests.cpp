@@ -0,0 +1,252 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include <simple_rwlock.h>
+#include <simple_rwlock_trace.h>
+#include <simple_rwlock_test/sync.h>
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/tests/test_common.h>
+#include <simple_rwlock_test/tests/trace_tests.h>
+
+namespace simple_rwlock_test {
+    using namespace simple_rwlock;
+    using namespace test_common;
+
+    // The steps are:
+    //   0: thread 1 reads lock a, holding it for at least hold_time.
+    //   1: thread 2 writes lock a.
+    //   2: thread 1 writes lock b, and reads lock a while holding it.
+    namespace test_trace_round_trip {
+        const std::chrono::microseconds hold_time(100);
+
+        void hold() {
+            auto start = std::chrono::steady_clock::now();
+            while (std::chrono::steady_clock::now() - start < hold_time) { }
+        }
+
+        void thread1(rwlock_t *rwlock_a,            // Shared
+                     rwlock_t *rwlock_b,            // Shared
+                     StepSequencer *sequencer)      // Shared
+        {
+            TEST_DLOG_THREAD_LAUNCH("thread 1");
+            sequencer->wait_for(0);
+            rwlock_lock_rd(rwlock_a);
+            hold();
+            rwlock_unlock_rd(rwlock_a);
+            sequencer->advance();
+
+            sequencer->wait_for(2);
+            rwlock_lock_wr(rwlock_b);
+            rwlock_lock_rd(rwlock_a);
+            rwlock_unlock_rd(rwlock_a);
+            hold();
+            rwlock_unlock_wr(rwlock_b);
+            sequencer->advance();
+        }
+
+        void thread2(rwlock_t *rwlock_a,            // Shared
+                     StepSequencer *sequencer)      // Shared
+        {
+            TEST_DLOG_THREAD_LAUNCH("thread 2");
+            sequencer->wait_for(1);
+            rwlock_lock_wr(rwlock_a);
+            rwlock_unlock_wr(rwlock_a);
+            sequencer->advance();
+        }
+
+        bool check_record(const rwlock_trace_record_t &record,
+                          uint32_t thread_id, uint32_t lock_id, uint8_t kind)
+        {
+            return (record.thread_id == thread_id) &&
+                (record.lock_id == lock_id) && (record.kind == kind);
+        }
+    }
+    TestTraceRoundTrip::TestTraceRoundTrip(Clock &tester_clock) :
+        Test("trace_round_trip", tester_clock)
+    { }
+    int TestTraceRoundTrip::run_test_body() {
+        using namespace test_trace_round_trip;
+        rwlock_t rwlock_a;
+        rwlock_t rwlock_b;
+        StepSequencer sequencer;
+        rwlock_init(&rwlock_a);
+        rwlock_init(&rwlock_b);
+
+        // Sections before the trace starts are not recorded.
+        rwlock_lock_rd(&rwlock_a);
+        rwlock_unlock_rd(&rwlock_a);
+        rwlock_trace_start();
+        std::thread first(thread1, &rwlock_a, &rwlock_b, &sequencer);
+        std::thread second(thread2, &rwlock_a, &sequencer);
+        first.join();
+        second.join();
+        std::string path = "/tmp/srwlt_trace_round_trip." +
+            std::to_string(getpid());
+        bool pass = rwlock_trace_stop(path);
+        // Nor are sections after it stops.
+        rwlock_lock_wr(&rwlock_b);
+        rwlock_unlock_wr(&rwlock_b);
+        rwlock_uninit(&rwlock_a);
+        rwlock_uninit(&rwlock_b);
+
+        std::vector<rwlock_trace_record_t> records;
+        pass &= rwlock_trace_read(path, &records);
+        remove(path.c_str());
+        pass &= (records.size() == 4);
+        if (!pass) {
+            return 1;
+        }
+        uint32_t hold_ns = std::chrono::nanoseconds(hold_time).count();
+        // Records are ordered by the time of the lock call.
+        pass &= check_record(records[0], 0, 0, rwlock_trace_kind_read);
+        pass &= (records[0].hold_ns >= hold_ns);
+        pass &= check_record(records[1], 1, 0, rwlock_trace_kind_write);
+        pass &= check_record(records[2], 0, 1, rwlock_trace_kind_write);
+        pass &= (records[2].hold_ns >= hold_ns);
+        pass &= check_record(records[3], 0, 0, rwlock_trace_kind_read);
+        pass &= (records[3].hold_ns <= records[2].hold_ns);
+        for (unsigned int i = 1; i < records.size(); i++) {
+            pass &= (records[i - 1].call_ns <= records[i].call_ns);
+        }
+        return (pass ? 0 : 1);
+    }
+
+    namespace test_trace_many_locks {
+        const uint32_t num_locks = 65536 + 16;
+    }
+
+    TestTraceManyLocks::TestTraceManyLocks(Clock &tester_clock) :
+        Test("trace_many_locks", tester_clock)
+    { }
+    int TestTraceManyLocks::run_test_body() {
+        using namespace test_trace_many_locks;
+        // Only the addresses matter, so record the sections directly
+        // rather than initializing this many locks.
+        std::vector<char> locks(num_locks);
+        rwlock_trace_start();
+        for (uint32_t i = 0; i < num_locks; i++) {
+            rwlock_trace_record_acquired(&locks[i], rwlock_trace_kind_read,
+                                         rwlock_trace_now_ns());
+            rwlock_trace_record_unlock(&locks[i]);
+        }
+        std::string path = "/tmp/srwlt_trace_many_locks." +
+            std::to_string(getpid());
+        bool pass = rwlock_trace_stop(path);
+
+        std::vector<rwlock_trace_record_t> records;
+        pass &= rwlock_trace_read(path, &records);
+        remove(path.c_str());
+        pass &= (records.size() == num_locks);
+        if (!pass) {
+            return 1;
+        }
+        // Sections that started in the same nanosecond may be in either
+        // order, so check that the ids are distinct rather than in order.
+        std::vector<bool> seen(num_locks, false);
+        for (const rwlock_trace_record_t &record : records) {
+            if (record.lock_id >= num_locks || seen[record.lock_id]) {
+                return 1;
+            }
+            seen[record.lock_id] = true;
+        }
+        return (pass ? 0 : 1);
+    }
+
+    namespace test_trace_long_wait {
+        const uint64_t wait_ns = 5000000000ull;
+    }
+
+    TestTraceLongWait::TestTraceLongWait(Clock &tester_clock) :
+        Test("trace_long_wait", tester_clock)
+    { }
+    int TestTraceLongWait::run_test_body() {
+        using namespace test_trace_long_wait;
+        char lock;
+        rwlock_trace_start();
+        rwlock_trace_record_acquired(&lock, rwlock_trace_kind_write,
+                                     rwlock_trace_now_ns() - wait_ns);
+        rwlock_trace_record_unlock(&lock);
+        std::string path = "/tmp/srwlt_trace_long_wait." +
+            std::to_string(getpid());
+        bool pass = rwlock_trace_stop(path);
+
+        std::vector<rwlock_trace_record_t> records;
+        pass &= rwlock_trace_read(path, &records);
+        remove(path.c_str());
+        pass &= (records.size() == 1);
+        if (!pass) {
+            return 1;
+        }
+        pass &= (records[0].wait_ns >= wait_ns);
+        return (pass ? 0 : 1);
+    }
+
+    namespace test_trace_read_corrupt {
+        const unsigned int num_locks = 4;
+        // Offset of the record count in the file header, after the magic,
+        // the version and the record size.
+        const std::streamoff num_records_offset = 16;
+
+        // Whether reading path fails and leaves records empty, even though
+        // they held something before.
+        bool read_fails(const std::string &path) {
+            std::vector<rwlock_trace_record_t> records(1);
+            return !rwlock_trace_read(path, &records) && records.empty();
+        }
+    }
+
+    TestTraceReadCorrupt::TestTraceReadCorrupt(Clock &tester_clock) :
+        Test("trace_read_corrupt", tester_clock)
+    { }
+    int TestTraceReadCorrupt::run_test_body() {
+        using namespace test_trace_read_corrupt;
+        char locks[num_locks];
+        rwlock_trace_start();
+        for (unsigned int i = 0; i < num_locks; i++) {
+            rwlock_trace_record_acquired(&locks[i], rwlock_trace_kind_read,
+                                         rwlock_trace_now_ns());
+            rwlock_trace_record_unlock(&locks[i]);
+        }
+        std::string path = "/tmp/srwlt_trace_read_corrupt." +
+            std::to_string(getpid());
+        bool pass = rwlock_trace_stop(path);
+        std::vector<rwlock_trace_record_t> records;
+        pass &= rwlock_trace_read(path, &records);
+        pass &= (records.size() == num_locks);
+
+        // A count far beyond the file, which would not fit in memory.
+        {
+            std::fstream file(path, std::ios::binary | std::ios::in |
+                              std::ios::out);
+            uint64_t num_records = UINT64_MAX / 2;
+            file.seekp(num_records_offset);
+            file.write((const char *)&num_records, sizeof(num_records));
+        }
+        pass &= read_fails(path);
+
+        // The right count, but the last record cut short.
+        {
+            std::fstream file(path, std::ios::binary | std::ios::in |
+                              std::ios::out);
+            uint64_t num_records = num_locks;
+            file.seekp(num_records_offset);
+            file.write((const char *)&num_records, sizeof(num_records));
+        }
+        pass &= rwlock_trace_read(path, &records);
+        std::filesystem::resize_file(
+            path, std::filesystem::file_size(path) - 1);
+        pass &= read_fails(path);
+
+        remove(path.c_str());
+        pass &= read_fails(path);
+        return (pass ? 0 : 1);
+    }
+}
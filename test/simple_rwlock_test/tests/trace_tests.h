@@ -0,0 +1,45 @@
+#ifndef SRWLT_TEST_TRACE_H
+#define SRWLT_TEST_TRACE_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // test_trace_round_trip: Record a read section, a write section from
+    // another thread, and a read section nested in a write section on a
+    // second lock. Write the trace to a file, read it back, and confirm
+    // every section is there with the right thread, lock, kind and a
+    // plausible hold time.
+    class TestTraceRoundTrip : public Test {
+    public:
+        TestTraceRoundTrip(Clock &tester_clock);
+        int run_test_body();
+    };
+
+    // test_trace_many_locks: Record one section on each of more locks than
+    // fit in 16 bits, and confirm every lock gets its own id.
+    class TestTraceManyLocks : public Test {
+    public:
+        TestTraceManyLocks(Clock &tester_clock);
+        int run_test_body();
+    };
+
+    // test_trace_long_wait: Record a section whose lock call started
+    // longer ago than fits in 32 bits of nanoseconds, and confirm the wait
+    // is read back in full.
+    class TestTraceLongWait : public Test {
+    public:
+        TestTraceLongWait(Clock &tester_clock);
+        int run_test_body();
+    };
+
+    // test_trace_read_corrupt: Read a trace whose header claims more
+    // records than the file holds, and one cut short, and confirm both
+    // fail and leave no records behind.
+    class TestTraceReadCorrupt : public Test {
+    public:
+        TestTraceReadCorrupt(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_TEST_TRACE_H
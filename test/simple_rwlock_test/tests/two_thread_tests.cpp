@@ -1,8 +1,11 @@
+#include <barrier>
 #include <mutex>
+#include <string>
 #include <thread>
 
 #include <simple_rwlock.h>
 #include <simple_rwlock_debug_helpers.h>
+#include <simple_rwlock_test/sync.h>
 #include <simple_rwlock_test/test.h>
 #include <simple_rwlock_test/tests/test_common.h>
 #include <simple_rwlock_test/tests/two_thread_tests.h>
@@ -14,12 +17,14 @@ namespace simple_rwlock_test {
     // Functions run by threads in the TestTwoThreadReadOnceEach test class.
     namespace test_two_thread_read_once_each {
         // Read once from shared data and confirm it is the correct value.
-        void rlock1(rwlock_t *rwlock,   // Shared
-                    unsigned int *data, // Shared
-                    bool *rlock1_pass)  // Not shared
+        void rlock1(rwlock_t *rwlock,      // Shared
+                    unsigned int *data,    // Shared
+                    std::barrier<> *start, // Shared
+                    bool *rlock1_pass)     // Not shared
         {
             TEST_DLOG_THREAD_LAUNCH("rlock1");
             unsigned int data_value = 0;
+            start->arrive_and_wait();
             { // Critical section: read from data.
                 rwlock_lock_rd(rwlock);
                 data_value = *data;
@@ -30,12 +35,14 @@ namespace simple_rwlock_test {
         }
 
         // Read once from shared data and confirm it is the correct value.
-        void rlock2(rwlock_t *rwlock,   // Shared
-                    unsigned int *data, // Shared
-                    bool *rlock2_pass)  // Not shared
+        void rlock2(rwlock_t *rwlock,      // Shared
+                    unsigned int *data,    // Shared
+                    std::barrier<> *start, // Shared
+                    bool *rlock2_pass)     // Not shared
         {
             TEST_DLOG_THREAD_LAUNCH("rlock2");
             unsigned int data_value = 0;
+            start->arrive_and_wait();
             { // Critical section: read from data.
                 rwlock_lock_rd(rwlock);
                 data_value = *data;
@@ -52,102 +59,49 @@ namespace simple_rwlock_test {
         using namespace test_two_thread_read_once_each;
         rwlock_t shared_rwlock;
         unsigned int data = 0xdeadbeef;
+        std::barrier<> start(2);
         bool rlock1_pass = true;
         bool rlock2_pass = true;
         rwlock_init(&shared_rwlock);
-        std::thread thread1(rlock1, &shared_rwlock, &data, &rlock1_pass);
-        std::thread thread2(rlock2, &shared_rwlock, &data, &rlock2_pass);
+        std::thread thread1(rlock1, &shared_rwlock, &data, &start,
+                            &rlock1_pass);
+        std::thread thread2(rlock2, &shared_rwlock, &data, &start,
+                            &rlock2_pass);
         thread1.join();
         thread2.join();
         rwlock_uninit(&shared_rwlock);
         return (rlock1_pass && rlock2_pass && (data == 0xdeadbeef)) ? 0 : 1;
     }
 
-    // Have two threads, each which repeatedly reads from shared data until
-    // the other thread reports having read the shared data at least once.
+    // Have two threads, each which acquires read access and then waits,
+    // still holding it, until the other thread has read access too.
     namespace test_two_thread_wait_for_other_read {
-        // Repeatedly read from shared data until rlock2
-        // reports having read the data at least once.
-        void rlock1(rwlock_t *rwlock,   // Shared
-                    unsigned int *data, // Shared
-                    bool *rlock_pass,   // Shared
-                    bool *rlock1_read,  // Shared
-                    bool *rlock2_read)  // Shared
+        // Read from shared data, wait at both_reading while holding
+        // read access, then read again before releasing it.
+        void rlock(const char *thread_name,      // Not shared
+                   rwlock_t *rwlock,             // Shared
+                   unsigned int *data,           // Shared
+                   std::barrier<> *both_reading, // Shared
+                   bool *rlock_pass)             // Not shared
         {
-            TEST_DLOG_THREAD_LAUNCH("rlock1");
+            TEST_DLOG_THREAD_LAUNCH(thread_name);
             unsigned int data_value = 0;
-            bool rlock2_read_value = false;
-            while (!rlock2_read_value) {
-                data_value = 0;
-
-                { // Critical section: read from data and rlock2_read.
-                    rwlock_lock_rd(rwlock);
-                    data_value = *data;
-                    rlock2_read_value = *rlock2_read;
-                    rwlock_unlock_rd(rwlock);
-                }
-
-                { // Critical section: write to rlock1_read and rlock_pass.
-                    rwlock_lock_wr(rwlock);
-                    *rlock1_read = true;
-                    *rlock_pass &= (data_value == 0xdeadbeef);
-                    rwlock_unlock_wr(rwlock);
-                }
-
-                TEST_DLOG_VAR_VALUE_HEX("rlock1", "data", data_value);
-                std::this_thread::yield();
-            } // End while loop
-            data_value = 0;
-
-            { // Critical section: read from data
+            { // Critical section: read from data.
                 rwlock_lock_rd(rwlock);
                 data_value = *data;
-                rwlock_unlock_rd(rwlock);
-            }
-
-            TEST_DLOG_VAR_VALUE_HEX("end of rlock1", "data", data_value);
-        }
+                TEST_DLOG_VAR_VALUE_HEX(thread_name, "data", data_value);
+                *rlock_pass &= (data_value == 0xdeadbeef);
 
-        // Repeatedly read from shared data until rlock1
-        // reports having read the data at least once.
-        void rlock2(rwlock_t *rwlock,   // Shared
-                    unsigned int *data, // Shared
-                    bool *rlock_pass,   // Shared
-                    bool *rlock1_read,  // Shared
-                    bool *rlock2_read)  // Shared
-        {
-            TEST_DLOG_THREAD_LAUNCH("rlock2");
-            unsigned int data_value = 0;
-            bool rlock1_read_value = false;
-            while (!rlock1_read_value) {
-                data_value = 0;
+                // Wait for the other thread to acquire read access.
+                both_reading->arrive_and_wait();
 
-                { // Critical section: read from data and rlock1_read.
-                    rwlock_lock_rd(rwlock);
-                    data_value = *data;
-                    rlock1_read_value = *rlock1_read;
-                    rwlock_unlock_rd(rwlock);
-                }
-
-                { // Critical section: write to rlock2_read and rlock_pass.
-                    rwlock_lock_wr(rwlock);
-                    *rlock2_read = true;
-                    *rlock_pass &= (data_value == 0xdeadbeef);
-                    rwlock_unlock_wr(rwlock);
-                }
-
-                TEST_DLOG_VAR_VALUE_HEX("rlock2", "data", data_value);
-                std::this_thread::yield();
-            } // End while loop
-            data_value = 0;
-
-            { // Critical section: read from data.
-                rwlock_lock_rd(rwlock);
                 data_value = *data;
+                *rlock_pass &= (data_value == 0xdeadbeef);
                 rwlock_unlock_rd(rwlock);
             }
-
-            TEST_DLOG_VAR_VALUE_HEX("end of rlock2", "data", data_value);
+            TEST_DLOG_VAR_VALUE_HEX(std::string("end of ") + thread_name,
+                                    "data", data_value);
+            (void)thread_name;
         }
     }
     TestTwoThreadReadWaitForOtherRead::TestTwoThreadReadWaitForOtherRead(
@@ -158,110 +112,84 @@ namespace simple_rwlock_test {
         using namespace test_two_thread_wait_for_other_read;
         rwlock_t shared_rwlock;
         unsigned int data = 0xdeadbeef;
-        bool rlock_pass = true;
-        bool rlock1_read = false;
-        bool rlock2_read = false;
+        std::barrier<> both_reading(2);
+        bool rlock1_pass = true;
+        bool rlock2_pass = true;
         rwlock_init(&shared_rwlock);
-        std::thread thread1(rlock1, &shared_rwlock, &data,
-                            &rlock_pass, &rlock1_read, &rlock2_read);
-        std::thread thread2(rlock2, &shared_rwlock, &data,
-                            &rlock_pass, &rlock1_read, &rlock2_read);
+        std::thread thread1(rlock, "rlock1", &shared_rwlock, &data,
+                            &both_reading, &rlock1_pass);
+        std::thread thread2(rlock, "rlock2", &shared_rwlock, &data,
+                            &both_reading, &rlock2_pass);
         thread1.join();
         thread2.join();
         rwlock_uninit(&shared_rwlock);
-        rlock_pass &= (data == 0xdeadbeef);
-        return (rlock_pass ? 0 : 1);
+        return (rlock1_pass && rlock2_pass && (data == 0xdeadbeef)) ? 0 : 1;
     }
 
-    // Have two threads, each which repeatedly writes to shared data until the
-    // other thread reports having written to the shared data at least once.
+    // Have two threads take turns writing to shared data and then
+    // reading it back after the other thread's write. The steps are:
+    //   0: wlock1 writes 2.
+    //   1: wlock2 reads 2 and writes 3.
+    //   2: wlock1 reads 3 and writes 4.
+    //   3: wlock2 reads 4.
     namespace test_two_thread_wait_for_other_write {
-        // Repeatedly write to shared data until wlock2
-        // reports having written the data at least once.
-        void wlock1(rwlock_t *rwlock,   // Shared
-                    int *data,          // Shared
-                    bool *wlock_pass,   // Shared
-                    bool *wlock1_wrote, // Shared
-                    bool *wlock2_wrote) // Shared
+        // Read from data and confirm it is the expected value.
+        bool read_expect(rwlock_t *rwlock,   // Shared
+                         int *data,          // Shared
+                         int expected)       // Not shared
         {
-            TEST_DLOG_THREAD_LAUNCH("wlock1");
-            unsigned int data_value = 0;
-            bool wlock2_wrote_value = false;
-
-            while (!wlock2_wrote_value) {
-                data_value = 0;
-
-                { // Critical section: read from data and wlock2_wrote.
-                    rwlock_lock_rd(rwlock);
-                    wlock2_wrote_value = *wlock2_wrote;
-                    data_value = *data;
-                    rwlock_unlock_rd(rwlock);
-                }
-
-                { // Critical section: write to data, wlock1_wrote, wlock_pass.
-                    rwlock_lock_wr(rwlock);
-                    *data = (*data > 1000) ? 1 : (*data + 1);
-                    *wlock1_wrote = true;
-                    *wlock_pass &= (data_value > 0);
-                    rwlock_unlock_wr(rwlock);
-                }
-
-                TEST_DLOG_VAR_VALUE_HEX("wlock1", "data", data_value);
-                std::this_thread::yield();
-            } // End while loop
-            data_value = 0;
-
-            { // Critical section: read from data
+            int data_value = 0;
+            { // Critical section: read from data.
                 rwlock_lock_rd(rwlock);
                 data_value = *data;
                 rwlock_unlock_rd(rwlock);
             }
-
-            TEST_DLOG_VAR_VALUE_HEX("end of wlock1", "data", data_value);
+            return (data_value == expected);
         }
 
-        // Repeatedly write to shared data until wlock1
-        // reports having written to the data at least once.
-        void wlock2(rwlock_t *rwlock,   // Shared
-                    int *data,          // Shared
-                    bool *wlock_pass,   // Shared
-                    bool *wlock1_wrote, // Shared
-                    bool *wlock2_wrote) // Shared
+        // Increment data.
+        void write_increment(rwlock_t *rwlock,   // Shared
+                             int *data)          // Shared
         {
-            TEST_DLOG_THREAD_LAUNCH("wlock2");
-            unsigned int data_value = 0;
-            bool wlock1_wrote_value = false;
-
-            while (!wlock1_wrote_value) {
-                data_value = 0;
-
-                { // Critical section: read from data and wlock1_wrote.
-                    rwlock_lock_rd(rwlock);
-                    data_value = *data;
-                    wlock1_wrote_value = *wlock1_wrote;
-                    rwlock_unlock_rd(rwlock);
-                }
-
-                { // Critical section: write to data, wlock2_wrote, wlock_pass.
-                    rwlock_lock_wr(rwlock);
-                    *data = (*data > 1000) ? 1 : (*data + 1);
-                    *wlock2_wrote = true;
-                    *wlock_pass &= (data_value > 0);
-                    rwlock_unlock_wr(rwlock);
-                }
-
-                TEST_DLOG_VAR_VALUE_HEX("wlock2", "data", data_value);
-                std::this_thread::yield();
-            } // End while loop
-            data_value = 0;
-
-            { // Critical section: read from data.
-                rwlock_lock_rd(rwlock);
-                data_value = *data;
-                rwlock_unlock_rd(rwlock);
+            { // Critical section: write to data.
+                rwlock_lock_wr(rwlock);
+                *data = *data + 1;
+                rwlock_unlock_wr(rwlock);
             }
+        }
 
-            TEST_DLOG_VAR_VALUE_HEX("end of wlock2", "data", data_value);
+        void wlock1(rwlock_t *rwlock,           // Shared
+                    int *data,                  // Shared
+                    StepSequencer *sequencer,   // Shared
+                    bool *wlock1_pass)          // Not shared
+        {
+            TEST_DLOG_THREAD_LAUNCH("wlock1");
+            sequencer->wait_for(0);
+            write_increment(rwlock, data);
+            sequencer->advance();
+
+            sequencer->wait_for(2);
+            *wlock1_pass &= read_expect(rwlock, data, 3);
+            write_increment(rwlock, data);
+            sequencer->advance();
+            TEST_DLOG_STR("wlock1", "done");
+        }
+
+        void wlock2(rwlock_t *rwlock,           // Shared
+                    int *data,                  // Shared
+                    StepSequencer *sequencer,   // Shared
+                    bool *wlock2_pass)          // Not shared
+        {
+            TEST_DLOG_THREAD_LAUNCH("wlock2");
+            sequencer->wait_for(1);
+            *wlock2_pass &= read_expect(rwlock, data, 2);
+            write_increment(rwlock, data);
+            sequencer->advance();
+
+            sequencer->wait_for(3);
+            *wlock2_pass &= read_expect(rwlock, data, 4);
+            sequencer->advance();
+            TEST_DLOG_STR("wlock2", "done");
         }
     }
     TestTwoThreadReadWaitForOtherWrite::TestTwoThreadReadWaitForOtherWrite(
@@ -272,18 +200,19 @@ namespace simple_rwlock_test {
         using namespace test_two_thread_wait_for_other_write;
         rwlock_t shared_rwlock;
         int data = 1;
-        bool wlock_pass = true;
-        bool wlock1_wrote = false;
-        bool wlock2_wrote = false;
+        StepSequencer sequencer;
+        bool wlock1_pass = true;
+        bool wlock2_pass = true;
         rwlock_init(&shared_rwlock);
-        std::thread thread1(wlock1, &shared_rwlock, &data,
-                            &wlock_pass, &wlock1_wrote, &wlock2_wrote);
-        std::thread thread2(wlock2, &shared_rwlock, &data,
-                            &wlock_pass, &wlock1_wrote, &wlock2_wrote);
+        std::thread thread1(wlock1, &shared_rwlock, &data, &sequencer,
+                            &wlock1_pass);
+        std::thread thread2(wlock2, &shared_rwlock, &data, &sequencer,
+                            &wlock2_pass);
         thread1.join();
         thread2.join();
         rwlock_uninit(&shared_rwlock);
-        wlock_pass &= (data > 1);
-        return (wlock_pass ? 0 : 1);
+        bool pass = wlock1_pass && wlock2_pass;
+        pass &= (data == 4) && (sequencer.current_step() == 4);
+        return (pass ? 0 : 1);
     }
 }
@@ -6,24 +6,26 @@
 namespace simple_rwlock_test {
     // test_two_thread_read_once_each: Have two threads, each which reads
     // from shared data once, confirms the correct value, and then ends.
+    // Both threads are released to read at the same time.
     class TestTwoThreadReadOnceEach : public Test {
     public:
         TestTwoThreadReadOnceEach(Clock &tester_clock);
         int run_test_body();
     };
 
-    // test_two_thread_wait_for_other_read: Have two threads, each
-    // which repeatedly reads from shared data until the other
-    // thread reports having read the shared data at least once.
+    // test_two_thread_wait_for_other_read: Have two threads, each which
+    // acquires read access and then waits, still holding it, until the
+    // other thread has read access too. This only finishes if both
+    // threads can hold read access at the same time.
     class TestTwoThreadReadWaitForOtherRead : public Test {
     public:
         TestTwoThreadReadWaitForOtherRead(Clock &tester_clock);
         int run_test_body();
     };
 
-    // test_two_thread_wait_for_other_write: Have two threads, each
-    // which repeatedly writes to shared data until the other
-    // thread reports having written to the shared data at least once.
+    // test_two_thread_wait_for_other_write: Have two threads take turns,
+    // in a fixed order of steps, writing to shared data and then reading
+    // it back after the other thread's write to confirm they see it.
     class TestTwoThreadReadWaitForOtherWrite : public Test {
     public:
         TestTwoThreadReadWaitForOtherWrite(Clock &tester_clock);
@@ -0,0 +1,137 @@
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <simple_rwlock_versioned.h>
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/tests/test_common.h>
+#include <simple_rwlock_test/tests/versioned_tests.h>
+
+namespace simple_rwlock_test {
+    using namespace simple_rwlock;
+    using namespace test_common;
+
+    namespace test_versioned_snapshot_lifetime {
+        // Value that counts how many of its copies have been destroyed.
+        struct counted_t {
+            counted_t(unsigned int data, unsigned int *num_destroyed) :
+                data(data),
+                num_destroyed(num_destroyed)
+            { }
+            counted_t(const counted_t &other) = default;
+            counted_t(counted_t &&other) :
+                data(other.data),
+                num_destroyed(other.num_destroyed)
+            {
+                // Only count the copies that were not moved from.
+                other.num_destroyed = nullptr;
+            }
+            ~counted_t() {
+                if (num_destroyed != nullptr) {
+                    (*num_destroyed)++;
+                }
+            }
+
+            unsigned int data;
+            unsigned int *num_destroyed;
+        };
+    }
+    TestVersionedSnapshotLifetime::TestVersionedSnapshotLifetime(
+        Clock &tester_clock) :
+        Test("versioned_snapshot_lifetime", tester_clock)
+    { }
+    int TestVersionedSnapshotLifetime::run_test_body() {
+        using namespace test_versioned_snapshot_lifetime;
+        unsigned int num_old_destroyed = 0;
+        unsigned int num_new_destroyed = 0;
+        bool pass = true;
+        {
+            versioned<counted_t> value(
+                counted_t(0xdeadbeef, &num_old_destroyed));
+            versioned<counted_t>::snapshot_t old_snapshot = value.snapshot();
+            versioned<counted_t>::snapshot_t old_copy = old_snapshot;
+            value.publish(counted_t(0xfeedcafe, &num_new_destroyed));
+            pass &= (old_snapshot->data == 0xdeadbeef);
+            pass &= (value.snapshot()->data == 0xfeedcafe);
+            pass &= (value.version() == 1);
+            // The old version is only kept alive by the snapshots.
+            pass &= (num_old_destroyed == 0);
+            old_snapshot.reset();
+            pass &= (num_old_destroyed == 0);
+            old_copy.reset();
+            pass &= (num_old_destroyed == 1);
+            pass &= (num_new_destroyed == 0);
+        }
+        // And the current version by the container.
+        pass &= (num_new_destroyed == 1);
+        return (pass ? 0 : 1);
+    }
+
+    // Every version is immutable once published, so a snapshot cannot be
+    // seen half written. What concurrent writers can get wrong is losing
+    // an update, and what readers can get wrong is going back to an older
+    // version.
+    namespace test_versioned_readers_writers {
+        const unsigned int num_iterations = 200;
+
+        // Publish one new version per iteration.
+        void write_thread(unsigned int thread_num,          // Not shared
+                          versioned<unsigned long> *value)  // Shared
+        {
+            std::stringstream thread_name_stream;
+            thread_name_stream << "write thread #" << thread_num;
+            TEST_DLOG_THREAD_LAUNCH(thread_name_stream.str());
+            for (unsigned int i = 0; i < num_iterations; i++) {
+                value->update([](unsigned long current) {
+                    return current + 1;
+                });
+            }
+        }
+
+        // Take one snapshot per iteration and confirm it is never older
+        // than the previous snapshot.
+        void read_thread(unsigned int thread_num,           // Not shared
+                         versioned<unsigned long> *value,   // Shared
+                         bool *read_pass)                   // Not shared
+        {
+            std::stringstream thread_name_stream;
+            thread_name_stream << "read thread #" << thread_num;
+            TEST_DLOG_THREAD_LAUNCH(thread_name_stream.str());
+            unsigned long previous = 0;
+            for (unsigned int i = 0; i < num_iterations; i++) {
+                versioned<unsigned long>::snapshot_t snapshot =
+                    value->snapshot();
+                *read_pass &= (*snapshot >= previous);
+                previous = *snapshot;
+                std::this_thread::yield();
+            }
+        }
+    }
+    TestVersionedReadersWriters::TestVersionedReadersWriters(
+        Clock &tester_clock) :
+        Test("versioned_readers_writers", tester_clock)
+    { }
+    int TestVersionedReadersWriters::run_test_body() {
+        using namespace test_versioned_readers_writers;
+        const unsigned int num_threads = 4;
+        versioned<unsigned long> value(0);
+        bool read_pass[num_threads] = { true, true, true, true };
+        std::vector<std::thread> threads;
+        for (unsigned int i = 0; i < num_threads; i++) {
+            threads.push_back(std::thread(write_thread, i + 1, &value));
+            threads.push_back(std::thread(read_thread, i + 1, &value,
+                                          &read_pass[i]));
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        versioned<unsigned long>::snapshot_t snapshot = value.snapshot();
+        bool pass = (*snapshot == num_threads * num_iterations) &&
+                    (value.version() == num_threads * num_iterations);
+        for (unsigned int i = 0; i < num_threads; i++) {
+            pass &= read_pass[i];
+        }
+        return (pass ? 0 : 1);
+    }
+}
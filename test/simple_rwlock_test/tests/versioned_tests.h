@@ -0,0 +1,27 @@
+#ifndef SRWLT_TEST_VERSIONED_H
+#define SRWLT_TEST_VERSIONED_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // test_versioned_snapshot_lifetime: Take a snapshot of a versioned
+    // value, publish a new value, and confirm the snapshot still sees the
+    // old value and the old value is freed once the snapshot is dropped.
+    class TestVersionedSnapshotLifetime : public Test {
+    public:
+        TestVersionedSnapshotLifetime(Clock &tester_clock);
+        int run_test_body();
+    };
+
+    // test_versioned_readers_writers: Have 4 reader threads take snapshots
+    // while 4 writer threads increment a versioned counter. Readers
+    // confirm snapshots never go back to an older value, and the final
+    // value confirms no update is lost.
+    class TestVersionedReadersWriters : public Test {
+    public:
+        TestVersionedReadersWriters(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_TEST_VERSIONED_H
@@ -0,0 +1,88 @@
+#include <mutex>
+#include <thread>
+
+#include <simple_rwlock.h>
+#include <simple_rwlock_test/sync.h>
+#include <simple_rwlock_test/test.h>
+#include <simple_rwlock_test/tests/test_common.h>
+#include <simple_rwlock_test/tests/yield_tests.h>
+
+namespace simple_rwlock_test {
+    using namespace simple_rwlock;
+    using namespace test_common;
+
+    namespace test_yield {
+        void write_thread(rwlock_t *rwlock,         // Shared
+                          unsigned long *value)     // Shared
+        {
+            TEST_DLOG_THREAD_LAUNCH("write thread");
+            rwlock_lock_wr(rwlock);
+            (*value)++;
+            rwlock_unlock_wr(rwlock);
+        }
+
+        unsigned long num_active_writers(rwlock_t *rwlock) {
+            std::lock_guard<rwlock_t::mutex_t> lock(
+                *rwlock->num_active_writers_mutex);
+            return rwlock->num_active_writers;
+        }
+
+        void read_thread(rwlock_t *rwlock,          // Shared
+                         unsigned long *value,      // Shared
+                         unsigned long *seen)       // Not shared
+        {
+            TEST_DLOG_THREAD_LAUNCH("read thread");
+            rwlock_lock_rd(rwlock);
+            *seen = *value;
+            rwlock_unlock_rd(rwlock);
+        }
+    }
+    TestYield::TestYield(Clock &tester_clock) :
+        Test("yield", tester_clock)
+    { }
+    int TestYield::run_test_body() {
+        using namespace test_yield;
+        rwlock_t rwlock;
+        unsigned long value = 0;
+        rwlock_init(&rwlock);
+
+        rwlock_lock_rd(&rwlock);
+        bool pass = !rwlock_yield_rd(&rwlock);
+        std::thread writer(write_thread, &rwlock, &value);
+        spin_until([&rwlock]() { return rwlock.writers_waiting(); });
+        pass &= rwlock_yield_rd(&rwlock);
+        pass &= (value == 1);
+        rwlock_unlock_rd(&rwlock);
+        writer.join();
+
+        unsigned long seen = 0;
+        rwlock_lock_wr(&rwlock);
+        pass &= !rwlock_yield_wr(&rwlock);
+        value = 2;
+        std::thread reader(read_thread, &rwlock, &value, &seen);
+        spin_until([&rwlock]() { return rwlock.readers_waiting(); });
+        pass &= rwlock_yield_wr(&rwlock);
+        pass &= (seen == 2);
+        value = 3;
+        rwlock_unlock_wr(&rwlock);
+        reader.join();
+        pass &= (seen == 2);
+
+        rwlock_lock_wr(&rwlock);
+        value = 4;
+        std::thread blocked_reader(read_thread, &rwlock, &value, &seen);
+        spin_until([&rwlock]() { return rwlock.readers_waiting(); });
+        std::thread queued_writer(write_thread, &rwlock, &value);
+        spin_until([&rwlock]() {
+            return num_active_writers(&rwlock) == 2;
+        });
+        pass &= rwlock_yield_wr(&rwlock);
+        rwlock_unlock_wr(&rwlock);
+        queued_writer.join();
+        blocked_reader.join();
+        pass &= (seen == 5);
+
+        rwlock_uninit(&rwlock);
+        return (pass ? 0 : 1);
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef SRWLT_TEST_YIELD_H
+#define SRWLT_TEST_YIELD_H
+
+#include <simple_rwlock_test/test.h>
+
+namespace simple_rwlock_test {
+    // test_yield: Confirm rwlock_yield_rd and rwlock_yield_wr keep access
+    // when nobody is waiting. Then hold read access while a writer thread
+    // waits, and confirm yielding lets the writer finish before read access
+    // returns; and hold write access while a reader thread waits, and
+    // confirm yielding lets the reader read before write access returns.
+    // Last, yield write access while both a reader and a second writer
+    // wait, and confirm yielding returns even though the reader cannot get
+    // in until both writers are done.
+    class TestYield : public Test {
+    public:
+        TestYield(Clock &tester_clock);
+        int run_test_body();
+    };
+}
+
+#endif // SRWLT_TEST_YIELD_H
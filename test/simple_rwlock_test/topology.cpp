@@ -0,0 +1,240 @@
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sched.h>
+
+#include <simple_rwlock_test/topology.h>
+
+namespace simple_rwlock_test {
+    namespace {
+        const char *placement_names[Topology::num_placements] = {
+            "unpinned", "compact", "scatter", "smt-siblings", "one-per-core"
+        };
+
+        // Parse a sysfs list such as "0-3,8-11", expanding ranges.
+        std::vector<int> read_cpu_list(const std::string &path) {
+            std::ifstream list_file(path);
+            std::vector<int> cpus;
+            std::string range;
+            while (std::getline(list_file, range, ',')) {
+                int first = 0;
+                int last = 0;
+                char dash = 0;
+                std::stringstream range_stream(range);
+                if (!(range_stream >> first)) {
+                    continue;
+                }
+                if (!(range_stream >> dash >> last)) {
+                    last = first;
+                }
+                for (int cpu = first; cpu <= last; cpu++) {
+                    cpus.push_back(cpu);
+                }
+            }
+            return cpus;
+        }
+
+        // Return the integer in a sysfs file, or fallback if unreadable.
+        int read_int(const std::string &path, int fallback) {
+            std::ifstream int_file(path);
+            int value;
+            return (int_file >> value) ? value : fallback;
+        }
+
+        std::vector<Topology::cpu_info_t> read_system_cpus() {
+            cpu_set_t allowed;
+            CPU_ZERO(&allowed);
+            if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+                CPU_SET(0, &allowed);
+            }
+            std::map<int, int> cpu_nodes;
+            for (int node = 0; ; node++) {
+                std::stringstream path_stream;
+                path_stream << "/sys/devices/system/node/node" << node
+                    << "/cpulist";
+                std::ifstream probe(path_stream.str());
+                if (!probe) {
+                    break;
+                }
+                for (int cpu : read_cpu_list(path_stream.str())) {
+                    cpu_nodes[cpu] = node;
+                }
+            }
+            std::vector<Topology::cpu_info_t> cpus;
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                if (!CPU_ISSET(cpu, &allowed)) {
+                    continue;
+                }
+                std::stringstream path_stream;
+                path_stream << "/sys/devices/system/cpu/cpu" << cpu
+                    << "/topology/";
+                std::string path = path_stream.str();
+                Topology::cpu_info_t info;
+                info.cpu = cpu;
+                // Unknown CPUs get a core and package of their own, which
+                // are kept apart from real ids by being negative.
+                info.core_id = read_int(path + "core_id", -1 - cpu);
+                info.package_id =
+                    read_int(path + "physical_package_id", -1 - cpu);
+                auto node = cpu_nodes.find(cpu);
+                info.node = (node == cpu_nodes.end()) ? 0 : node->second;
+                cpus.push_back(info);
+            }
+            return cpus;
+        }
+    }
+
+    Topology::Topology(const std::vector<cpu_info_t> &cpus) :
+        cpus_(cpus),
+        num_packages_(0)
+    {
+        std::sort(cpus_.begin(), cpus_.end(),
+                  [](const cpu_info_t &a, const cpu_info_t &b) {
+                      return a.cpu < b.cpu;
+                  });
+        // Core ids are only unique within a package.
+        std::map<std::pair<int, int>, std::vector<int> > core_cpus;
+        for (const auto &info : cpus_) {
+            core_cpus[std::make_pair(info.package_id, info.core_id)]
+                .push_back(info.cpu);
+        }
+        std::vector<std::pair<int, std::vector<int> > > cores;
+        for (auto &core : core_cpus) {
+            cores.push_back(std::make_pair(core.first.first, core.second));
+        }
+        // Order cores by package, then by their lowest CPU, which is the
+        // order the kernel numbers them in.
+        std::sort(cores.begin(), cores.end(),
+                  [](const std::pair<int, std::vector<int> > &a,
+                     const std::pair<int, std::vector<int> > &b) {
+                      if (a.first != b.first) {
+                          return a.first < b.first;
+                      }
+                      return a.second[0] < b.second[0];
+                  });
+        for (unsigned int i = 0; i < cores.size(); i++) {
+            if (i == 0 || cores[i].first != cores[i - 1].first) {
+                package_starts_.push_back(i);
+            }
+            cores_.push_back(cores[i].second);
+        }
+        num_packages_ = package_starts_.size();
+    }
+
+    const Topology &Topology::system() {
+        static const Topology system_topology(read_system_cpus());
+        return system_topology;
+    }
+
+    std::vector<int> Topology::node_cpus(int node) const {
+        std::vector<int> cpus;
+        for (const auto &info : cpus_) {
+            if (info.node == node) {
+                cpus.push_back(info.cpu);
+            }
+        }
+        return cpus;
+    }
+
+    std::string Topology::summary() const {
+        std::stringstream summary_stream;
+        summary_stream << std::dec << num_packages_ << " packages, "
+            << cores_.size() << " cores, " << cpus_.size() << " CPUs";
+        return summary_stream.str();
+    }
+
+    bool Topology::place(placement_t placement, unsigned int num_threads,
+                         std::vector<int> *cpus) const
+    {
+        cpus->clear();
+        std::vector<int> order;
+        switch (placement) {
+        case placement_unpinned:
+            return true;
+        case placement_compact:
+        case placement_smt_siblings:
+            for (const auto &core : cores_) {
+                if (placement == placement_compact || core.size() > 1) {
+                    order.insert(order.end(), core.begin(), core.end());
+                }
+            }
+            break;
+        case placement_one_per_core:
+            for (const auto &core : cores_) {
+                order.push_back(core[0]);
+            }
+            break;
+        case placement_scatter: {
+            // Order each package's CPUs as the first CPU of every core,
+            // then the second, and so on, then deal the packages out
+            // round-robin.
+            std::vector<std::vector<int> > package_orders;
+            for (unsigned int p = 0; p < num_packages_; p++) {
+                unsigned int end = (p + 1 < num_packages_)
+                    ? package_starts_[p + 1] : cores_.size();
+                std::vector<int> package_order;
+                for (unsigned int sibling = 0; ; sibling++) {
+                    bool any = false;
+                    for (unsigned int c = package_starts_[p]; c < end; c++) {
+                        if (sibling < cores_[c].size()) {
+                            package_order.push_back(cores_[c][sibling]);
+                            any = true;
+                        }
+                    }
+                    if (!any) {
+                        break;
+                    }
+                }
+                package_orders.push_back(package_order);
+            }
+            for (unsigned int round = 0; order.size() < cpus_.size();
+                 round++) {
+                for (const auto &package_order : package_orders) {
+                    if (round < package_order.size()) {
+                        order.push_back(package_order[round]);
+                    }
+                }
+            }
+            break;
+        }
+        default:
+            return false;
+        }
+        if (order.empty()) {
+            return false;
+        }
+        for (unsigned int i = 0; i < num_threads; i++) {
+            cpus->push_back(order[i % order.size()]);
+        }
+        return true;
+    }
+
+    const char *Topology::placement_name(placement_t placement) {
+        return (placement < num_placements)
+            ? placement_names[placement] : "unknown";
+    }
+
+    bool Topology::parse_placement(const std::string &name,
+                                   placement_t *placement)
+    {
+        for (int i = 0; i < num_placements; i++) {
+            if (name == placement_names[i]) {
+                *placement = (placement_t)i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool Topology::pin_to_cpu(int cpu) {
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(cpu, &cpu_set);
+        return sched_setaffinity(0, sizeof(cpu_set), &cpu_set) == 0;
+    }
+}
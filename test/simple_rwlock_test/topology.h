@@ -0,0 +1,82 @@
+#ifndef SRWLT_TOPOLOGY_H
+#define SRWLT_TOPOLOGY_H
+
+#include <string>
+#include <vector>
+
+namespace simple_rwlock_test {
+    // CPUs this process may run on, with the core, package and NUMA node
+    // of each as reported by sysfs, and strategies for choosing which CPU
+    // each thread of a benchmark is pinned to.
+    //
+    // Lock throughput depends heavily on whether contending threads share
+    // an SMT core, a package or nothing, so a benchmark pinned with a named
+    // strategy can be compared with another run of the same strategy
+    // without the scheduler's choices getting in the way.
+    class Topology {
+    public:
+        typedef struct cpu_info {
+            int cpu;
+            int core_id;
+            int package_id;
+            int node;
+        } cpu_info_t;
+
+        enum placement_t {
+            // Leave threads wherever the scheduler puts them.
+            placement_unpinned = 0,
+            // Fill every SMT sibling of a core, then the next core of the
+            // same package, then the next package.
+            placement_compact,
+            // Spread threads round-robin across packages, using one CPU
+            // of each core before any SMT siblings.
+            placement_scatter,
+            // Pairs of SMT siblings only; unavailable without SMT.
+            placement_smt_siblings,
+            // One CPU of each physical core, never its siblings.
+            placement_one_per_core,
+            num_placements
+        };
+
+        // Build a topology from a list of CPUs, for tests.
+        explicit Topology(const std::vector<cpu_info_t> &cpus);
+
+        // The topology of the CPUs in the process's affinity mask, read
+        // once. CPUs that sysfs says nothing about get a core and package
+        // of their own.
+        static const Topology &system();
+
+        const std::vector<cpu_info_t> &cpus() const { return cpus_; }
+        unsigned int num_cores() const { return cores_.size(); }
+        unsigned int num_packages() const { return num_packages_; }
+        // CPUs on a NUMA node, in increasing order.
+        std::vector<int> node_cpus(int node) const;
+        // For example "2 packages, 8 cores, 16 CPUs".
+        std::string summary() const;
+
+        // Fill cpus with the CPU for each of num_threads threads, in
+        // thread order. Strategies run out of CPUs wrap around to the
+        // first one. Leave cpus empty for placement_unpinned, and return
+        // false if the strategy cannot be used on this topology.
+        bool place(placement_t placement, unsigned int num_threads,
+                   std::vector<int> *cpus) const;
+
+        static const char *placement_name(placement_t placement);
+        // Return false if name is not the name of a placement.
+        static bool parse_placement(const std::string &name,
+                                    placement_t *placement);
+
+        // Pin the calling thread to one CPU. Return false on failure.
+        static bool pin_to_cpu(int cpu);
+
+    private:
+        std::vector<cpu_info_t> cpus_;
+        // CPUs of each core, ordered by package and then by lowest CPU.
+        std::vector<std::vector<int> > cores_;
+        // Index into cores_ of the first core of each package.
+        std::vector<unsigned int> package_starts_;
+        unsigned int num_packages_;
+    };
+}
+
+#endif // SRWLT_TOPOLOGY_H